@@ -30,6 +30,11 @@
   which it doles out object. Allocated objects when freed go back
   to the free pool.
 
+  Each thread keeps a magazine of free blocks for every allocator in
+  front of the free pool, so that most allocations and frees do not
+  touch the shared pool. Magazines are filled and emptied half at a
+  time and returned to the free pool when the thread exits.
+
   @note Fast allocators could accumulate a lot of objects in the
   free pool as a result of bursty demand. Memory used by the objects
   in the free pool never gets freed even if the freelist grows very
@@ -49,6 +54,28 @@
 
 #define RND16(_x) (((_x) + 15) & ~15)
 
+/** Free blocks of one allocator cached by a thread.
+    The blocks are linked through their first word.
+*/
+struct FreelistMagazine {
+  void *head     = nullptr;
+  uint32_t count = 0;
+};
+
+/// The most blocks in a magazine, 0 disables the magazines.
+extern int thread_magazine_size;
+/// The magazines of the current thread by allocator, nullptr until it uses one.
+extern thread_local FreelistMagazine *thread_magazines;
+/// The number of allocators that get magazines, the ones created after use the free pool directly.
+static constexpr int MAX_THREAD_MAGAZINES = 1024;
+
+/// Register the freelist @a fl for magazines, returns its magazine index.
+int freelist_magazine_register(InkFreeList *fl);
+/// Refill the magazine @a id of the current thread and allocate from it.
+void *freelist_magazine_alloc(InkFreeList *fl, int id);
+/// Free @a ptr to the magazine @a id of the current thread, emptying half of it when full.
+void freelist_magazine_free(InkFreeList *fl, int id, void *ptr);
+
 /** Allocator for fixed size memory blocks. */
 class FreelistAllocator
 {
@@ -60,7 +87,14 @@ public:
   void *
   alloc_void()
   {
-    return ink_freelist_new(this->fl);
+    if (thread_magazines && magazine_id < MAX_THREAD_MAGAZINES && thread_magazines[magazine_id].count) {
+      FreelistMagazine &m = thread_magazines[magazine_id];
+      void *ptr           = m.head;
+      m.head              = *static_cast<void **>(ptr);
+      --m.count;
+      return ptr;
+    }
+    return freelist_magazine_alloc(this->fl, magazine_id);
   }
 
   /**
@@ -71,7 +105,15 @@ public:
   void
   free_void(void *ptr)
   {
-    ink_freelist_free(this->fl, ptr);
+    if (thread_magazines && magazine_id < MAX_THREAD_MAGAZINES &&
+        thread_magazines[magazine_id].count < static_cast<uint32_t>(thread_magazine_size)) {
+      FreelistMagazine &m        = thread_magazines[magazine_id];
+      *static_cast<void **>(ptr) = m.head;
+      m.head                     = ptr;
+      ++m.count;
+      return;
+    }
+    freelist_magazine_free(this->fl, magazine_id, ptr);
   }
 
   /**
@@ -100,6 +142,7 @@ public:
   FreelistAllocator(const char *name, unsigned int element_size, unsigned int chunk_size = 128, unsigned int alignment = 8)
   {
     ink_freelist_init(&fl, name, element_size, chunk_size, alignment);
+    magazine_id = freelist_magazine_register(fl);
   }
 
   /** Re-initialize the parameters of the allocator. */
@@ -107,6 +150,8 @@ public:
   re_init(const char *name, unsigned int element_size, unsigned int chunk_size, unsigned int alignment, int advice)
   {
     ink_freelist_madvise_init(&this->fl, name, element_size, chunk_size, alignment, advice);
+    // The blocks cached for the previous freelist must not come out of this one.
+    magazine_id = freelist_magazine_register(fl);
   }
 
   // Dummies
@@ -122,6 +167,7 @@ public:
 
 protected:
   InkFreeList *fl;
+  int magazine_id = MAX_THREAD_MAGAZINES;
 };
 
 class MallocAllocator
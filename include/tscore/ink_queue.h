@@ -199,6 +199,7 @@ typedef struct _InkFreeList InkFreeList;
 
 const InkFreeListOps *ink_freelist_malloc_ops();
 const InkFreeListOps *ink_freelist_freelist_ops();
+const InkFreeListOps *ink_freelist_global_ops();
 void ink_freelist_init_ops(int nofl_class, int nofl_proxy);
 
 /*
@@ -212,6 +213,8 @@ void ink_freelist_madvise_init(InkFreeList **fl, const char *name, uint32_t type
 void *ink_freelist_new(InkFreeList *f);
 void ink_freelist_free(InkFreeList *f, void *item);
 void ink_freelist_free_bulk(InkFreeList *f, void *head, void *tail, size_t num_item);
+/* Take up to num_item items, linked through their first word from head to tail. Returns how many. */
+size_t ink_freelist_new_bulk(InkFreeList *f, void **head, void **tail, size_t num_item);
 void ink_freelists_dump(FILE *f);
 void ink_freelists_dump_baselinerel(FILE *f);
 void ink_freelists_snap_baseline();
@@ -614,7 +614,17 @@ DiskHandler::submit()
 void
 DiskHandler::handle_cqe(io_uring_cqe *cqe)
 {
-  AIOCallback *op = static_cast<AIOCallback *>(io_uring_cqe_get_data(cqe));
+  uintptr_t data = reinterpret_cast<uintptr_t>(io_uring_cqe_get_data(cqe));
+  // cancellations are submitted without user data
+  if (!data) {
+    return;
+  }
+  if (data & 1) {
+    reinterpret_cast<IOUringCompletionHandler *>(data & ~static_cast<uintptr_t>(1))->handle_complete(cqe);
+    return;
+  }
+
+  AIOCallback *op = reinterpret_cast<AIOCallback *>(data);
 
   op->aio_result = static_cast<int64_t>(cqe->res);
   op->link.prev  = nullptr;
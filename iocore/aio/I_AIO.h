@@ -155,6 +155,25 @@ struct DiskHandler : public Continuation {
 
 #if AIO_MODE == AIO_MODE_IO_URING
 
+/**
+  Receives the completions of operations other than disk I/O submitted on a DiskHandler ring,
+  see the net reads in UnixNetIOUring.cc.
+*/
+class IOUringCompletionHandler
+{
+public:
+  virtual ~IOUringCompletionHandler() = default;
+
+  virtual void handle_complete(io_uring_cqe *cqe) = 0;
+
+  /// The user data for io_uring_sqe_set_data(), the low bit tells it from an AIOCallback.
+  void *
+  user_data()
+  {
+    return reinterpret_cast<void *>(reinterpret_cast<uintptr_t>(this) | 1);
+  }
+};
+
 class DiskHandler
 {
 public:
@@ -167,6 +186,12 @@ public:
     return io_uring_get_sqe(&ring);
   }
 
+  io_uring *
+  get_ring()
+  {
+    return &ring;
+  }
+
   int set_wq_max_workers(unsigned int bounded, unsigned int unbounded);
   std::pair<int, int> get_wq_max_workers();
 
@@ -37,7 +37,11 @@
 
 #include "tscore/hugepages.h"
 
+#include <algorithm>
 #include <atomic>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
 
 constexpr ts::VersionNumber CACHE_DB_VERSION(CACHE_DB_MAJOR_VERSION, CACHE_DB_MINOR_VERSION);
 
@@ -62,10 +66,21 @@ int64_t cache_config_ram_cache_size            = AUTO_SIZE_RAM_CACHE;
 int cache_config_ram_cache_algorithm           = 1;
 int cache_config_ram_cache_compress            = 0;
 int cache_config_ram_cache_compress_percent    = 90;
+int cache_config_ram_cache_zstd_dict_size      = 0;
+int cache_config_ram_cache_shards              = 0;
+int cache_config_ram_cache_front_objects       = 0;
+int64_t cache_config_ram_cache_front_max_size  = 16384;
 int cache_config_ram_cache_use_seen_filter     = 1;
+int cache_config_ram_cache_checkpoint          = 0;
+int cache_config_ram_cache_checkpoint_objects  = 65536;
 int cache_config_http_max_alts                 = 3;
 int cache_config_log_alternate_eviction        = 0;
 int cache_config_dir_sync_frequency            = 60;
+int cache_config_dir_sync_incremental          = 0;
+int cache_config_dir_tag_index                 = 0;
+int cache_config_admission_min_hits            = 0;
+int cache_config_init_disk_concurrency         = 0;
+int cache_config_init_early_open               = 0;
 int cache_config_permit_pinning                = 0;
 int cache_config_select_alternate              = 1;
 int cache_config_max_doc_size                  = 0;
@@ -74,10 +89,17 @@ int64_t cache_config_ram_cache_cutoff          = AGG_SIZE;
 int cache_config_max_disk_errors               = 5;
 int cache_config_hit_evacuate_percent          = 10;
 int cache_config_hit_evacuate_size_limit       = 0;
+int cache_config_hit_evacuate_min_hits         = 0;
+int cache_config_hit_evacuate_ram_objects      = 0;
+int cache_config_tier_promote_min_hits         = 2;
 int cache_config_force_sector_size             = 0;
 int cache_config_target_fragment_size          = DEFAULT_TARGET_FRAGMENT_SIZE;
 int cache_config_agg_write_backlog             = AGG_SIZE * 2;
+int cache_config_agg_write_buffer_size         = AGG_SIZE;
+int cache_config_agg_write_buffers             = 1;
 int cache_config_enable_checksum               = 0;
+int cache_config_sendfile                      = 0;
+int64_t cache_config_sendfile_min_size         = 4194304;
 int cache_config_alt_rewrite_max_size          = 4096;
 int cache_config_read_while_writer             = 0;
 int cache_config_mutex_retry_delay             = 2;
@@ -103,6 +125,7 @@ bool CacheProcessor::check               = false;
 int CacheProcessor::start_internal_flags = 0;
 int CacheProcessor::auto_clear_flag      = 0;
 CacheProcessor cacheProcessor;
+static ink_hrtime cache_start_time = 0;
 Vol **gvol             = nullptr;
 std::atomic<int> gnvol = 0;
 ClassAllocator<CacheVC> cacheVConnectionAllocator("cacheVConnection");
@@ -134,7 +157,6 @@ struct VolInitInfo {
   }
 };
 
-#if AIO_MODE == AIO_MODE_NATIVE
 struct VolInit : public Continuation {
   Vol *vol;
   char *path;
@@ -145,6 +167,10 @@ struct VolInit : public Continuation {
   int
   mainEvent(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
   {
+    // keep the directory checks and the recovery scan of this stripe on the task thread
+    if (this_ethread()->is_event_type(ET_TASK)) {
+      vol->init_thread = this_ethread();
+    }
     vol->init(path, blocks, offset, vol_clear);
     mutex.clear();
     delete this;
@@ -157,6 +183,74 @@ struct VolInit : public Continuation {
   }
 };
 
+/*
+  Stripes are initialized on the task threads, when there are any, with
+  no more than proxy.config.cache.init.disk_concurrency of them reading
+  their directory or recovering at the same time on any one disk.  More
+  than that only makes the heads of a spinning disk seek between them.
+*/
+struct VolInitDiskQueue {
+  int active = 0;
+  std::deque<VolInit *> pending;
+};
+
+static std::mutex vol_init_mutex;
+static std::unordered_map<CacheDisk *, VolInitDiskQueue> vol_init_queues;
+// serializes stripes joining the cache, see Vol::dir_init_done
+static std::mutex vol_ready_mutex;
+
+static void
+vol_init_stat(Vol *vol, int stat, int64_t n)
+{
+  RecIncrGlobalRawStat(cache_rsb, stat, n);
+  RecIncrGlobalRawStat(vol->cache_vol->vol_rsb, stat, n);
+}
+
+static void
+vol_init_start(VolInit *vi)
+{
+  vol_init_stat(vi->vol, cache_init_stripes_active_stat, 1);
+  eventProcessor.schedule_imm(vi, eventProcessor.thread_group[ET_TASK]._count > 0 ? ET_TASK : ET_CALL);
+}
+
+static void
+vol_init_schedule(VolInit *vi)
+{
+  vol_init_stat(vi->vol, cache_init_stripes_total_stat, 1);
+  {
+    std::lock_guard<std::mutex> lock(vol_init_mutex);
+    VolInitDiskQueue &q = vol_init_queues[vi->vol->disk];
+    if (cache_config_init_disk_concurrency > 0 && q.active >= cache_config_init_disk_concurrency) {
+      q.pending.push_back(vi);
+      return;
+    }
+    q.active++;
+  }
+  vol_init_start(vi);
+}
+
+// The stripe is done with its disk, start the next one waiting for it.
+static void
+vol_init_release(Vol *vol)
+{
+  VolInit *next = nullptr;
+  vol_init_stat(vol, cache_init_stripes_active_stat, -1);
+  {
+    std::lock_guard<std::mutex> lock(vol_init_mutex);
+    VolInitDiskQueue &q = vol_init_queues[vol->disk];
+    if (q.pending.empty()) {
+      q.active--;
+    } else {
+      next = q.pending.front();
+      q.pending.pop_front();
+    }
+  }
+  if (next) {
+    vol_init_start(next);
+  }
+}
+
+#if AIO_MODE == AIO_MODE_NATIVE
 struct DiskInit : public Continuation {
   CacheDisk *disk;
   char *s;
@@ -213,7 +307,7 @@ cache_bytes_used(int volume)
       if (!gvol[i]->header->cycle) {
         used += gvol[i]->header->write_pos - gvol[i]->start;
       } else {
-        used += gvol[i]->len - gvol[i]->dirlen() - EVACUATION_SIZE;
+        used += gvol[i]->len - gvol[i]->dirlen() - gvol[i]->evacuation_size();
       }
     }
   }
@@ -583,6 +677,7 @@ CacheProcessor::start_internal(int flags)
     et->schedule_imm(et->diskHandler);
   }
 #endif
+  cache_start_time     = Thread::get_hrtime();
   start_internal_flags = flags;
   clear                = !!(flags & PROCESSOR_RECONFIGURE) || auto_clear_flag;
   fix                  = !!(flags & PROCESSOR_FIX);
@@ -814,6 +909,7 @@ CacheProcessor::diskInitialized()
     cacheInitialized();
     return;
   } else {
+    cplist_link_tiers();
     CacheVol *cp = cp_list.head;
     for (; cp; cp = cp->link.next) {
       cp->vol_rsb = RecAllocateRawStatBlock(static_cast<int>(cache_stat_count));
@@ -857,6 +953,69 @@ CacheProcessor::diskInitialized()
   }
 }
 
+// A new RAM cache for a stripe, with the algorithm from the config.
+static RamCache *
+new_vol_ram_cache()
+{
+  RamCache *(*new_ram_cache)() = nullptr;
+  switch (cache_config_ram_cache_algorithm) {
+  default:
+  case RAM_CACHE_ALGORITHM_CLFUS:
+    new_ram_cache = new_RamCacheCLFUS;
+    break;
+  case RAM_CACHE_ALGORITHM_LRU:
+    new_ram_cache = new_RamCacheLRU;
+    break;
+  }
+  if (cache_config_ram_cache_shards > 1) {
+    return new_RamCacheSharded(new_ram_cache, cache_config_ram_cache_shards);
+  }
+  return new_ram_cache();
+}
+
+// Startup timings of the stripes initialized so far, the volume ones are those of the slowest stripe.
+static void
+set_startup_time_stats()
+{
+  ink_hrtime dir_read_time = 0, recover_time = 0;
+  for (int i = 0; i < gnvol; i++) {
+    dir_read_time = std::max(dir_read_time, gvol[i]->dir_read_time);
+    recover_time  = std::max(recover_time, gvol[i]->recover_time);
+  }
+  GLOBAL_CACHE_SET_DYN_STAT(cache_startup_dir_read_time_stat, dir_read_time);
+  GLOBAL_CACHE_SET_DYN_STAT(cache_startup_recovery_time_stat, recover_time);
+  GLOBAL_CACHE_SET_DYN_STAT(cache_startup_time_stat, Thread::get_hrtime() - cache_start_time);
+}
+
+/*
+  Adds a stripe that finished initializing after the cache opened, with
+  proxy.config.cache.init.early_open, doing for it what cacheInitialized
+  did for the stripes ready at that time.
+*/
+static void
+vol_join_cache(Vol *vol)
+{
+  int64_t ram_cache_bytes = 0;
+  vol->ram_cache          = new_vol_ram_cache();
+  if (vol->cache_vol->ramcache_enabled) {
+    if (cache_config_ram_cache_size == AUTO_SIZE_RAM_CACHE) {
+      vol->ram_cache->init(vol->dirlen() * DEFAULT_RAM_CACHE_MULTIPLIER, vol);
+      ram_cache_bytes = vol->dirlen();
+    } else {
+      double factor   = static_cast<double>(static_cast<int64_t>(vol->len >> STORE_BLOCK_SHIFT)) / theCache->cache_size;
+      ram_cache_bytes = static_cast<int64_t>(cache_config_ram_cache_size * factor);
+      vol->ram_cache->init(ram_cache_bytes, vol);
+    }
+  }
+  vol_init_stat(vol, cache_ram_cache_bytes_total_stat, ram_cache_bytes);
+  vol_init_stat(vol, cache_bytes_total_stat, vol->len - vol->dirlen());
+  vol_init_stat(vol, cache_direntries_total_stat, vol->buckets * vol->segments * DIR_DEPTH);
+  vol_init_stat(vol, cache_direntries_used_stat, dir_entries_used(vol));
+
+  rebuild_host_table(theCache);
+  Note("cache stripe '%s' ready", vol->hash_text.get());
+}
+
 void
 CacheProcessor::cacheInitialized()
 {
@@ -920,15 +1079,7 @@ CacheProcessor::cacheInitialized()
     if (gnvol) {
       // new ram_caches, with algorithm from the config
       for (i = 0; i < gnvol; i++) {
-        switch (cache_config_ram_cache_algorithm) {
-        default:
-        case RAM_CACHE_ALGORITHM_CLFUS:
-          gvol[i]->ram_cache = new_RamCacheCLFUS();
-          break;
-        case RAM_CACHE_ALGORITHM_LRU:
-          gvol[i]->ram_cache = new_RamCacheLRU();
-          break;
-        }
+        gvol[i]->ram_cache = new_vol_ram_cache();
       }
       // let us calculate the Size
       if (cache_config_ram_cache_size == AUTO_SIZE_RAM_CACHE) {
@@ -1024,14 +1175,33 @@ CacheProcessor::cacheInitialized()
         Fatal("lzma not available for RAM cache compression");
 #endif
         break;
+      case CACHE_COMPRESSION_ZSTD:
+#ifndef HAVE_ZSTD_H
+        Fatal("zstd not available for RAM cache compression");
+#endif
+        break;
+      case CACHE_COMPRESSION_LZ4:
+#ifndef HAVE_LZ4_H
+        Fatal("lz4 not available for RAM cache compression");
+#endif
+        break;
+      case CACHE_COMPRESSION_AUTO:
+        break;
       }
 
       GLOBAL_CACHE_SET_DYN_STAT(cache_ram_cache_bytes_total_stat, ram_cache_bytes);
       GLOBAL_CACHE_SET_DYN_STAT(cache_bytes_total_stat, total_cache_bytes);
       GLOBAL_CACHE_SET_DYN_STAT(cache_direntries_total_stat, total_direntries);
       GLOBAL_CACHE_SET_DYN_STAT(cache_direntries_used_stat, used_direntries);
+
+      set_startup_time_stats();
+
       if (!check) {
         dir_sync_init();
+        // when opened early, the checkpoint is loaded once all stripes are ready
+        if (theCache->total_initialized_vol == theCache->total_nvol) {
+          ram_cache_checkpoint_load();
+        }
       }
       cache_init_ok = 1;
     } else {
@@ -1165,6 +1335,7 @@ vol_init_dir(Vol *d)
       }
     }
   }
+  dir_tag_index_build(d);
 }
 
 void
@@ -1212,7 +1383,7 @@ Vol::clear_dir()
   io.aiocb.aio_nbytes = dir_len;
   io.aiocb.aio_offset = skip;
   io.action           = this;
-  io.thread           = AIO_CALLBACK_THREAD_ANY;
+  io.thread           = init_thread;
   io.then             = nullptr;
   ink_assert(ink_aio_write(&io));
   return 0;
@@ -1225,6 +1396,8 @@ Vol::init(char *s, off_t blocks, off_t dir_skip, bool clear)
   const size_t hash_seed_size = strlen(seed_str);
   const size_t hash_text_size = hash_seed_size + 32;
 
+  init_start_time = Thread::get_hrtime();
+
   hash_text = static_cast<char *>(ats_malloc(hash_text_size));
   ink_strlcpy(hash_text, seed_str, hash_text_size);
   snprintf(hash_text + hash_seed_size, (hash_text_size - hash_seed_size), " %" PRIu64 ":%" PRIu64 "",
@@ -1249,6 +1422,14 @@ Vol::init(char *s, off_t blocks, off_t dir_skip, bool clear)
   evacuate      = static_cast<DLL<EvacuationBlock> *>(ats_malloc(evac_len));
   memset(static_cast<void *>(evacuate), 0, evac_len);
 
+  agg_size    = cache_config_agg_write_buffer_size;
+  agg_buffers = cache_config_agg_write_buffers;
+  for (int i = 0; i < agg_buffers; i++) {
+    agg_writes[i].buffer = static_cast<char *>(ats_memalign(ats_pagesize(), agg_size));
+    memset(agg_writes[i].buffer, 0, agg_size);
+  }
+  agg_buffer = agg_writes[0].buffer;
+
   Debug("cache_init", "Vol %s: allocating %zu directory bytes for a %lld byte volume (%lf%%)", hash_text.get(), dirlen(),
         (long long)this->len, (double)dirlen() / (double)this->len * 100.0);
 
@@ -1263,6 +1444,11 @@ Vol::init(char *s, off_t blocks, off_t dir_skip, bool clear)
   dir    = reinterpret_cast<Dir *>(raw_dir + this->headerlen());
   header = reinterpret_cast<VolHeaderFooter *>(raw_dir);
   footer = reinterpret_cast<VolHeaderFooter *>(raw_dir + this->dirlen() - ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter)));
+  // neither on-disk copy is known to match memory until it has been fully written once
+  dir_mark_all_dirty();
+  if (cache_config_dir_tag_index) {
+    tag_index = static_cast<uint16_t *>(ats_calloc(segments * buckets * DIR_DEPTH, sizeof(uint16_t)));
+  }
 
   if (clear) {
     Note("clearing cache directory '%s'", hash_text.get());
@@ -1289,7 +1475,7 @@ Vol::init(char *s, off_t blocks, off_t dir_skip, bool clear)
     aio->aiocb.aio_buf    = &(init_info->vol_h_f[i * STORE_BLOCK_SIZE]);
     aio->aiocb.aio_nbytes = footerlen;
     aio->action           = this;
-    aio->thread           = AIO_CALLBACK_THREAD_ANY;
+    aio->thread           = init_thread;
     aio->then             = (i < 3) ? &(init_info->vol_aio[i + 1]) : nullptr;
   }
 #if AIO_MODE == AIO_MODE_NATIVE
@@ -1357,7 +1543,10 @@ Vol::handle_dir_read(int event, void *data)
   }
   CHECK_DIR(this);
 
-  sector_size = header->sector_size;
+  dir_tag_index_build(this);
+
+  sector_size   = header->sector_size;
+  dir_read_time = Thread::get_hrtime() - init_start_time;
 
   return this->recover_data();
 }
@@ -1426,8 +1615,9 @@ Vol::handle_recover_from_data(int event, void * /* data ATS_UNUSED */)
       recover_wrapped = true;
       recover_pos     = start;
     }
-    io.aiocb.aio_buf    = static_cast<char *>(ats_memalign(ats_pagesize(), RECOVERY_SIZE));
-    io.aiocb.aio_nbytes = RECOVERY_SIZE;
+    // every write that may have been in flight must fit in one read, see the to_check assert below
+    io.aiocb.aio_buf    = static_cast<char *>(ats_memalign(ats_pagesize(), evacuation_size()));
+    io.aiocb.aio_nbytes = evacuation_size();
     if (static_cast<off_t>(recover_pos + io.aiocb.aio_nbytes) > static_cast<off_t>(skip + len)) {
       io.aiocb.aio_nbytes = (skip + len) - recover_pos;
     }
@@ -1478,7 +1668,7 @@ Vol::handle_recover_from_data(int event, void * /* data ATS_UNUSED */)
     if (recover_wrapped && start == io.aiocb.aio_offset) {
       doc = reinterpret_cast<Doc *>(s);
       if (doc->magic != DOC_MAGIC || doc->write_serial < last_write_serial) {
-        recover_pos = skip + len - EVACUATION_SIZE;
+        recover_pos = skip + len - evacuation_size();
         goto Ldone;
       }
     }
@@ -1509,7 +1699,7 @@ Vol::handle_recover_from_data(int event, void * /* data ATS_UNUSED */)
              sync serial and less than (header->sync_serial + 2) then
              continue;
 
-             3. If the position we are recovering from is within AGG_SIZE
+             3. If the position we are recovering from is within agg_size
              from the disk end, then we can't trust this document. The
              aggregation buffer might have been larger than the remaining space
              at the end and we decided to wrap around instead of writing
@@ -1531,10 +1721,10 @@ Vol::handle_recover_from_data(int event, void * /* data ATS_UNUSED */)
           // (doc->sync_serial < last_sync_serial) ||
           // (doc->sync_serial > header->sync_serial + 1).
           // if we are too close to the end, wrap around
-          else if (recover_pos - (e - s) > (skip + len) - AGG_SIZE) {
+          else if (recover_pos - (e - s) > (skip + len) - agg_size) {
             recover_wrapped     = true;
             recover_pos         = start;
-            io.aiocb.aio_nbytes = RECOVERY_SIZE;
+            io.aiocb.aio_nbytes = evacuation_size();
 
             break;
           }
@@ -1543,13 +1733,13 @@ Vol::handle_recover_from_data(int event, void * /* data ATS_UNUSED */)
           goto Ldone;
         } else {
           // doc->magic != DOC_MAGIC
-          // If we are in the danger zone - recover_pos is within AGG_SIZE
+          // If we are in the danger zone - recover_pos is within agg_size
           // from the end, then wrap around
           recover_pos -= e - s;
-          if (recover_pos > (skip + len) - AGG_SIZE) {
+          if (recover_pos > (skip + len) - agg_size) {
             recover_wrapped     = true;
             recover_pos         = start;
-            io.aiocb.aio_nbytes = RECOVERY_SIZE;
+            io.aiocb.aio_nbytes = evacuation_size();
 
             break;
           }
@@ -1562,7 +1752,7 @@ Vol::handle_recover_from_data(int event, void * /* data ATS_UNUSED */)
       s += round_to_approx_size(doc->len);
     }
 
-    /* if (s > e) then we gone through RECOVERY_SIZE; we need to
+    /* if (s > e) then we gone through evacuation_size(); we need to
        read more data off disk and continue recovering */
     if (s >= e) {
       /* In the last iteration, we increment s by doc->len...need to undo
@@ -1575,7 +1765,7 @@ Vol::handle_recover_from_data(int event, void * /* data ATS_UNUSED */)
         recover_wrapped = true;
         recover_pos     = start;
       }
-      io.aiocb.aio_nbytes = RECOVERY_SIZE;
+      io.aiocb.aio_nbytes = evacuation_size();
       if (static_cast<off_t>(recover_pos + io.aiocb.aio_nbytes) > static_cast<off_t>(skip + len)) {
         io.aiocb.aio_nbytes = (skip + len) - recover_pos;
       }
@@ -1599,8 +1789,8 @@ Ldone : {
     return handle_recover_write_dir(EVENT_IMMEDIATE, nullptr);
   }
 
-  recover_pos += EVACUATION_SIZE; // safely cover the max write size
-  if (recover_pos < header->write_pos && (recover_pos + EVACUATION_SIZE >= header->write_pos)) {
+  recover_pos += evacuation_size(); // safely cover the max write size
+  if (recover_pos < header->write_pos && (recover_pos + evacuation_size() >= header->write_pos)) {
     Debug("cache_init", "Head Pos: %" PRIu64 ", Rec Pos: %" PRIu64 ", Wrapped:%d", header->write_pos, recover_pos, recover_wrapped);
     Warning("no valid directory found while recovering '%s', clearing", hash_text.get());
     goto Lclear;
@@ -1634,7 +1824,7 @@ Ldone : {
     AIOCallback *aio      = &(init_info->vol_aio[i]);
     aio->aiocb.aio_fildes = fd;
     aio->action           = this;
-    aio->thread           = AIO_CALLBACK_THREAD_ANY;
+    aio->thread           = init_thread;
     aio->then             = (i < 2) ? &(init_info->vol_aio[i + 1]) : nullptr;
   }
   int footerlen = ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter));
@@ -1678,7 +1868,8 @@ Vol::handle_recover_write_dir(int /* event ATS_UNUSED */, void * /* data ATS_UNU
   delete init_info;
   init_info = nullptr;
   set_io_not_in_progress();
-  scan_pos = header->write_pos;
+  scan_pos     = header->write_pos;
+  recover_time = Thread::get_hrtime() - init_start_time - dir_read_time;
   periodic_scan();
   SET_HANDLER(&Vol::dir_init_done);
   return dir_init_done(EVENT_IMMEDIATE, nullptr);
@@ -1707,7 +1898,7 @@ Vol::handle_header_read(int event, void *data)
     io.aiocb.aio_nbytes = this->dirlen();
     io.aiocb.aio_buf    = raw_dir;
     io.action           = this;
-    io.thread           = AIO_CALLBACK_THREAD_ANY;
+    io.thread           = init_thread;
     io.then             = nullptr;
 
     if (hf[0]->sync_serial == hf[1]->sync_serial &&
@@ -1749,11 +1940,17 @@ Vol::dir_init_done(int /* event ATS_UNUSED */, void * /* data ATS_UNUSED */)
     eventProcessor.schedule_in(this, HRTIME_MSECONDS(5), ET_CALL);
     return EVENT_CONT;
   } else {
-    int vol_no = gnvol++;
+    vol_init_release(this);
+    init_thread = AIO_CALLBACK_THREAD_ANY;
+    // with proxy.config.cache.init.early_open the cache may already be using the stripes before this one
+    std::lock_guard<std::mutex> lock(vol_ready_mutex);
+    int vol_no = gnvol;
     ink_assert(!gvol[vol_no]);
     gvol[vol_no] = this;
+    gnvol        = vol_no + 1;
+    initialized  = true;
     SET_HANDLER(&Vol::aggWrite);
-    cache->vol_initialized(fd != -1);
+    cache->vol_initialized(this, fd != -1);
     return EVENT_DONE;
   }
 }
@@ -1795,7 +1992,8 @@ build_vol_hash_table(CacheHostRecord *cp)
   uint64_t used  = 0;
   // initialize number of elements per vol
   for (int i = 0; i < num_vols; i++) {
-    if (DISK_BAD(cp->vols[i]->disk)) {
+    // stripes still initializing join later, see proxy.config.cache.init.early_open
+    if (DISK_BAD(cp->vols[i]->disk) || !cp->vols[i]->initialized) {
       bad_vols++;
       continue;
     }
@@ -1888,13 +2086,25 @@ build_vol_hash_table(CacheHostRecord *cp)
   ats_free(rtable);
 }
 
+// Called with vol_ready_mutex held, once for every stripe.
 void
-Cache::vol_initialized(bool result)
+Cache::vol_initialized(Vol *vol, bool result)
 {
   if (result) {
     ink_atomic_increment(&total_good_nvol, 1);
-  }
-  if (total_nvol == ink_atomic_increment(&total_initialized_vol, 1) + 1) {
+    vol_init_stat(vol, cache_init_stripes_ready_stat, 1);
+  }
+  bool last = total_nvol == ink_atomic_increment(&total_initialized_vol, 1) + 1;
+  if (ready == CACHE_INITIALIZED) {
+    vol_join_cache(vol);
+    if (last) {
+      set_startup_time_stats();
+      if (!CacheProcessor::check) {
+        ram_cache_checkpoint_load();
+      }
+      Note("all cache stripes ready");
+    }
+  } else if (ready == CACHE_INITIALIZING && (last || (result && cache_config_init_early_open))) {
     open_done();
   }
 }
@@ -2080,11 +2290,7 @@ Cache::open(bool clear, bool /* fix ATS_UNUSED */)
             blocks                      = q->b->len;
 
             bool vol_clear = clear || d->cleared || q->new_block;
-#if AIO_MODE == AIO_MODE_NATIVE
-            eventProcessor.schedule_imm(new VolInit(cp->vols[vol_no], d->path, blocks, q->b->offset, vol_clear));
-#else
-            cp->vols[vol_no]->init(d->path, blocks, q->b->offset, vol_clear);
-#endif
+            vol_init_schedule(new VolInit(cp->vols[vol_no], d->path, blocks, q->b->offset, vol_clear));
             vol_no++;
             cache_size += blocks;
           }
@@ -2121,7 +2327,7 @@ CacheVC::is_pread_capable()
 
 #define STORE_COLLISION 1
 
-static void
+void
 unmarshal_helper(Doc *doc, Ptr<IOBufferData> &buf, int &okay)
 {
   using UnmarshalFunc           = int(char *buf, int len, RefCountObj *block_ref);
@@ -2207,7 +2413,8 @@ CacheVC::handleReadDone(int event, Event *e)
     }
 
     // put into ram cache?
-    if (io.ok() && ((doc->first_key == *read_key) || (doc->key == *read_key) || STORE_COLLISION) && doc->magic == DOC_MAGIC) {
+    if (!f.doc_header_only && io.ok() && ((doc->first_key == *read_key) || (doc->key == *read_key) || STORE_COLLISION) &&
+        doc->magic == DOC_MAGIC) {
       int okay = 1;
       if (!f.doc_from_ram_cache) {
         f.not_from_ram_cache = 1;
@@ -2278,11 +2485,16 @@ CacheVC::handleRead(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
   cancel_trigger();
 
   f.doc_from_ram_cache = false;
+  f.doc_header_only    = false;
 
-  // check ram cache
+  // check ram cache, unless that was just done before the volume lock was taken
   ink_assert(vol->mutex->thread_holding == this_ethread());
-  int64_t o           = dir_offset(&dir);
-  int ram_hit_state   = vol->ram_cache->get(read_key, &buf, static_cast<uint64_t>(o));
+  int64_t o         = dir_offset(&dir);
+  int ram_hit_state = 0;
+  if (!f.ram_cache_missed) {
+    ram_hit_state = vol->ram_cache->get(read_key, &buf, static_cast<uint64_t>(o));
+  }
+  f.ram_cache_missed  = false;
   f.compressed_in_ram = (ram_hit_state > RAM_HIT_COMPRESS_NONE) ? 1 : 0;
   if (ram_hit_state >= RAM_HIT_COMPRESS_NONE) {
     goto LramHit;
@@ -2295,17 +2507,24 @@ CacheVC::handleRead(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
   }
   // see if its in the aggregation buffer
   if (dir_agg_buf_valid(vol, &dir)) {
-    int agg_offset = vol->vol_offset(&dir) - vol->header->write_pos;
-    buf            = new_IOBufferData(iobuffer_size_to_index(io.aiocb.aio_nbytes, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
-    ink_assert((agg_offset + io.aiocb.aio_nbytes) <= (unsigned)vol->agg_buf_pos);
+    off_t agg_offset = vol->vol_offset(&dir);
+    buf              = new_IOBufferData(iobuffer_size_to_index(io.aiocb.aio_nbytes, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
+    ink_assert(agg_offset + static_cast<off_t>(io.aiocb.aio_nbytes) <= vol->header->write_pos + vol->agg_buf_pos);
     char *doc = buf->data();
-    char *agg = vol->agg_buffer + agg_offset;
+    char *agg = vol->agg_buf_data(agg_offset);
     memcpy(doc, agg, io.aiocb.aio_nbytes);
     io.aio_result = io.aiocb.aio_nbytes;
     SET_HANDLER(&CacheVC::handleReadDone);
     return EVENT_RETURN;
   }
 
+  // the data of a fragment sent from the disk is not needed, only its header
+  if (sendfile_vc && io.aiocb.aio_nbytes > ROUND_TO_STORE_BLOCK(sizeof(Doc)) && vol->vol_sendfile_valid(&dir)) {
+    io.aiocb.aio_nbytes  = ROUND_TO_STORE_BLOCK(sizeof(Doc));
+    f.doc_header_only    = true;
+    sendfile_write_limit = vol->vol_sendfile_limit(&dir);
+  }
+
   io.aiocb.aio_fildes = vol->fd;
   io.aiocb.aio_offset = vol->vol_offset(&dir);
   if (static_cast<off_t>(io.aiocb.aio_offset + io.aiocb.aio_nbytes) > static_cast<off_t>(vol->skip + vol->len)) {
@@ -2344,7 +2563,7 @@ Cache::lookup(Continuation *cont, const CacheKey *key, CacheFragType type, const
     return ACTION_RESULT_DONE;
   }
 
-  Vol *vol          = key_to_vol(key, hostname, host_len);
+  Vol *vol          = cache_tier_select(key_to_vol(key, hostname, host_len), key);
   ProxyMutex *mutex = cont->mutex.get();
   CacheVC *c        = new_CacheVC(cont);
   SET_CONTINUATION_HANDLER(c, &CacheVC::openReadStartHead);
@@ -2464,6 +2683,7 @@ Cache::remove(Continuation *cont, const CacheKey *key, CacheFragType type, const
   CACHE_TRY_LOCK(lock, cont->mutex, this_ethread());
   ink_assert(lock.is_locked());
   Vol *vol = key_to_vol(key, hostname, host_len);
+  cache_tier_invalidate(vol, key);
   // coverity[var_decl]
   Dir result;
   dir_clear(&result); // initialized here, set result empty so we can recognize missed lock
@@ -2542,8 +2762,9 @@ cplist_update()
     for (config_vol = config_volumes.cp_queue.head; config_vol; config_vol = config_vol->link.next) {
       if (config_vol->number == cp->vol_number) {
         if (cp->scheme == config_vol->scheme) {
-          cp->ramcache_enabled = config_vol->ramcache_enabled;
-          config_vol->cachep   = cp;
+          cp->ramcache_enabled   = config_vol->ramcache_enabled;
+          cp->admission_min_hits = config_vol->admission_min_hits;
+          config_vol->cachep     = cp;
         } else {
           /* delete this volume from all the disks */
           int d_no;
@@ -2825,6 +3046,7 @@ cplist_reconfigure()
           delete new_cp;
           return -1;
         }
+        new_cp->admission_min_hits = config_vol->admission_min_hits;
         cp_list.enqueue(new_cp);
         cp_list_len++;
         config_vol->cachep = new_cp;
@@ -3058,6 +3280,38 @@ register_cache_stats(RecRawStatBlock *rsb, const char *prefix)
   REG_INT("ram_cache.bytes_used", cache_ram_cache_bytes_stat);
   REG_INT("ram_cache.hits", cache_ram_cache_hits_stat);
   REG_INT("ram_cache.misses", cache_ram_cache_misses_stat);
+  REG_INT("ram_cache.front.hits", cache_ram_cache_front_hits_stat);
+  REG_INT("admission.admitted", cache_admission_admitted_stat);
+  REG_INT("admission.rejected", cache_admission_rejected_stat);
+  REG_INT("tier.hot.hits", cache_tier_hot_hits_stat);
+  REG_INT("tier.cold.hits", cache_tier_cold_hits_stat);
+  REG_INT("tier.promote.active", cache_tier_promote_active_stat);
+  REG_INT("tier.promote.success", cache_tier_promote_success_stat);
+  REG_INT("tier.promote.failure", cache_tier_promote_failure_stat);
+  REG_INT("init.stripes.total", cache_init_stripes_total_stat);
+  REG_INT("init.stripes.active", cache_init_stripes_active_stat);
+  REG_INT("init.stripes.ready", cache_init_stripes_ready_stat);
+  REG_INT("ram_cache.compress.fastlz.bytes_in", cache_ram_cache_compress_fastlz_bytes_in_stat);
+  REG_INT("ram_cache.compress.fastlz.bytes_out", cache_ram_cache_compress_fastlz_bytes_out_stat);
+  REG_INT("ram_cache.compress.fastlz.time", cache_ram_cache_compress_fastlz_time_stat);
+  REG_INT("ram_cache.compress.fastlz.decompress.time", cache_ram_cache_compress_fastlz_decompress_time_stat);
+  REG_INT("ram_cache.compress.libz.bytes_in", cache_ram_cache_compress_libz_bytes_in_stat);
+  REG_INT("ram_cache.compress.libz.bytes_out", cache_ram_cache_compress_libz_bytes_out_stat);
+  REG_INT("ram_cache.compress.libz.time", cache_ram_cache_compress_libz_time_stat);
+  REG_INT("ram_cache.compress.libz.decompress.time", cache_ram_cache_compress_libz_decompress_time_stat);
+  REG_INT("ram_cache.compress.liblzma.bytes_in", cache_ram_cache_compress_liblzma_bytes_in_stat);
+  REG_INT("ram_cache.compress.liblzma.bytes_out", cache_ram_cache_compress_liblzma_bytes_out_stat);
+  REG_INT("ram_cache.compress.liblzma.time", cache_ram_cache_compress_liblzma_time_stat);
+  REG_INT("ram_cache.compress.liblzma.decompress.time", cache_ram_cache_compress_liblzma_decompress_time_stat);
+  REG_INT("ram_cache.compress.zstd.bytes_in", cache_ram_cache_compress_zstd_bytes_in_stat);
+  REG_INT("ram_cache.compress.zstd.bytes_out", cache_ram_cache_compress_zstd_bytes_out_stat);
+  REG_INT("ram_cache.compress.zstd.time", cache_ram_cache_compress_zstd_time_stat);
+  REG_INT("ram_cache.compress.zstd.decompress.time", cache_ram_cache_compress_zstd_decompress_time_stat);
+  REG_INT("ram_cache.compress.lz4.bytes_in", cache_ram_cache_compress_lz4_bytes_in_stat);
+  REG_INT("ram_cache.compress.lz4.bytes_out", cache_ram_cache_compress_lz4_bytes_out_stat);
+  REG_INT("ram_cache.compress.lz4.time", cache_ram_cache_compress_lz4_time_stat);
+  REG_INT("ram_cache.compress.lz4.decompress.time", cache_ram_cache_compress_lz4_decompress_time_stat);
+  REG_INT("ram_cache.warm.objects", cache_ram_cache_warm_objects_stat);
   REG_INT("pread_count", cache_pread_count_stat);
   REG_INT("percent_full", cache_percent_full_stat);
   REG_INT("lookup.active", cache_lookup_active_stat);
@@ -3098,10 +3352,12 @@ register_cache_stats(RecRawStatBlock *rsb, const char *prefix)
   REG_INT("hdr_marshal_bytes", cache_hdr_marshal_bytes_stat);
   REG_INT("gc_bytes_evacuated", cache_gc_bytes_evacuated_stat);
   REG_INT("gc_frags_evacuated", cache_gc_frags_evacuated_stat);
+  REG_INT("gc_evacuate_reads", cache_gc_evacuate_reads_stat);
   REG_INT("wrap_count", cache_directory_wrap_stat);
   REG_INT("sync.count", cache_directory_sync_count_stat);
   REG_INT("sync.bytes", cache_directory_sync_bytes_stat);
   REG_INT("sync.time", cache_directory_sync_time_stat);
+  REG_INT("sync.segments", cache_directory_sync_segments_stat);
   REG_INT("span.errors.read", cache_span_errors_read_stat);
   REG_INT("span.errors.write", cache_span_errors_write_stat);
   REG_INT("span.failing", cache_span_failing_stat);
@@ -3135,7 +3391,19 @@ ink_cache_init(ts::ModuleVersion v)
   REC_EstablishStaticConfigInt32(cache_config_ram_cache_algorithm, "proxy.config.cache.ram_cache.algorithm");
   REC_EstablishStaticConfigInt32(cache_config_ram_cache_compress, "proxy.config.cache.ram_cache.compress");
   REC_EstablishStaticConfigInt32(cache_config_ram_cache_compress_percent, "proxy.config.cache.ram_cache.compress_percent");
+  REC_ReadConfigInt32(cache_config_ram_cache_zstd_dict_size, "proxy.config.cache.ram_cache.compress_zstd_dict_size");
+  Debug("cache_init", "proxy.config.cache.ram_cache.compress_zstd_dict_size = %d", cache_config_ram_cache_zstd_dict_size);
   REC_ReadConfigInt32(cache_config_ram_cache_use_seen_filter, "proxy.config.cache.ram_cache.use_seen_filter");
+  REC_EstablishStaticConfigInt32(cache_config_ram_cache_shards, "proxy.config.cache.ram_cache.shards");
+  REC_EstablishStaticConfigInt32(cache_config_ram_cache_front_objects, "proxy.config.cache.ram_cache.front_cache.objects");
+  REC_EstablishStaticConfigInteger(cache_config_ram_cache_front_max_size,
+                                   "proxy.config.cache.ram_cache.front_cache.max_object_size");
+  Debug("cache_init", "proxy.config.cache.ram_cache.shards = %d, front_cache.objects = %d, front_cache.max_object_size = %" PRId64,
+        cache_config_ram_cache_shards, cache_config_ram_cache_front_objects, cache_config_ram_cache_front_max_size);
+  REC_ReadConfigInt32(cache_config_ram_cache_checkpoint, "proxy.config.cache.ram_cache.checkpoint.enabled");
+  REC_ReadConfigInt32(cache_config_ram_cache_checkpoint_objects, "proxy.config.cache.ram_cache.checkpoint.max_objects");
+  Debug("cache_init", "proxy.config.cache.ram_cache.checkpoint.enabled = %d, max_objects = %d", cache_config_ram_cache_checkpoint,
+        cache_config_ram_cache_checkpoint_objects);
 
   REC_EstablishStaticConfigInt32(cache_config_http_max_alts, "proxy.config.cache.limits.http.max_alts");
   Debug("cache_init", "proxy.config.cache.limits.http.max_alts = %d", cache_config_http_max_alts);
@@ -3153,6 +3421,20 @@ ink_cache_init(ts::ModuleVersion v)
   REC_EstablishStaticConfigInt32(cache_config_dir_sync_frequency, "proxy.config.cache.dir.sync_frequency");
   Debug("cache_init", "proxy.config.cache.dir.sync_frequency = %d", cache_config_dir_sync_frequency);
 
+  REC_EstablishStaticConfigInt32(cache_config_dir_sync_incremental, "proxy.config.cache.dir.sync_incremental");
+  Debug("cache_init", "proxy.config.cache.dir.sync_incremental = %d", cache_config_dir_sync_incremental);
+
+  REC_ReadConfigInt32(cache_config_dir_tag_index, "proxy.config.cache.dir.tag_index");
+  Debug("cache_init", "proxy.config.cache.dir.tag_index = %d", cache_config_dir_tag_index);
+
+  REC_ReadConfigInt32(cache_config_admission_min_hits, "proxy.config.cache.admission.min_hits");
+  Debug("cache_init", "proxy.config.cache.admission.min_hits = %d", cache_config_admission_min_hits);
+
+  REC_ReadConfigInt32(cache_config_init_disk_concurrency, "proxy.config.cache.init.disk_concurrency");
+  REC_ReadConfigInt32(cache_config_init_early_open, "proxy.config.cache.init.early_open");
+  Debug("cache_init", "proxy.config.cache.init.disk_concurrency = %d, early_open = %d", cache_config_init_disk_concurrency,
+        cache_config_init_early_open);
+
   REC_EstablishStaticConfigInt32(cache_config_select_alternate, "proxy.config.cache.select_alternate");
   Debug("cache_init", "proxy.config.cache.select_alternate = %d", cache_config_select_alternate);
 
@@ -3175,6 +3457,15 @@ ink_cache_init(ts::ModuleVersion v)
   REC_EstablishStaticConfigInt32(cache_config_hit_evacuate_size_limit, "proxy.config.cache.hit_evacuate_size_limit");
   Debug("cache_init", "proxy.config.cache.hit_evacuate_size_limit = %d", cache_config_hit_evacuate_size_limit);
 
+  REC_EstablishStaticConfigInt32(cache_config_hit_evacuate_min_hits, "proxy.config.cache.hit_evacuate_min_hits");
+  Debug("cache_init", "proxy.config.cache.hit_evacuate_min_hits = %d", cache_config_hit_evacuate_min_hits);
+
+  REC_EstablishStaticConfigInt32(cache_config_hit_evacuate_ram_objects, "proxy.config.cache.hit_evacuate_ram_cache_objects");
+  Debug("cache_init", "proxy.config.cache.hit_evacuate_ram_cache_objects = %d", cache_config_hit_evacuate_ram_objects);
+
+  REC_EstablishStaticConfigInt32(cache_config_tier_promote_min_hits, "proxy.config.cache.tier.promote_min_hits");
+  Debug("cache_init", "proxy.config.cache.tier.promote_min_hits = %d", cache_config_tier_promote_min_hits);
+
   REC_EstablishStaticConfigInt32(cache_config_force_sector_size, "proxy.config.cache.force_sector_size");
 
   ink_assert(REC_RegisterConfigUpdateFunc("proxy.config.cache.target_fragment_size", FragmentSizeUpdateCb, nullptr) !=
@@ -3191,9 +3482,22 @@ ink_cache_init(ts::ModuleVersion v)
   REC_EstablishStaticConfigInt32(cache_config_agg_write_backlog, "proxy.config.cache.agg_write_backlog");
   Debug("cache_init", "proxy.config.cache.agg_write_backlog = %d", cache_config_agg_write_backlog);
 
+  REC_ReadConfigInt32(cache_config_agg_write_buffer_size, "proxy.config.cache.agg_write.buffer_size");
+  cache_config_agg_write_buffer_size =
+    ROUND_TO_STORE_BLOCK(std::clamp(cache_config_agg_write_buffer_size, static_cast<int>(AGG_SIZE), static_cast<int>(MAX_AGG_SIZE)));
+  REC_ReadConfigInt32(cache_config_agg_write_buffers, "proxy.config.cache.agg_write.buffers");
+  cache_config_agg_write_buffers = std::clamp(cache_config_agg_write_buffers, 1, MAX_AGG_BUFFERS);
+  Debug("cache_init", "proxy.config.cache.agg_write.buffer_size = %d, buffers = %d", cache_config_agg_write_buffer_size,
+        cache_config_agg_write_buffers);
+
   REC_EstablishStaticConfigInt32(cache_config_enable_checksum, "proxy.config.cache.enable_checksum");
   Debug("cache_init", "proxy.config.cache.enable_checksum = %d", cache_config_enable_checksum);
 
+  REC_EstablishStaticConfigInt32(cache_config_sendfile, "proxy.config.cache.sendfile.enabled");
+  REC_EstablishStaticConfigInteger(cache_config_sendfile_min_size, "proxy.config.cache.sendfile.min_size");
+  Debug("cache_init", "proxy.config.cache.sendfile.enabled = %d, min_size = %" PRId64, cache_config_sendfile,
+        cache_config_sendfile_min_size);
+
   REC_EstablishStaticConfigInt32(cache_config_alt_rewrite_max_size, "proxy.config.cache.alt_rewrite_max_size");
   Debug("cache_init", "proxy.config.cache.alt_rewrite_max_size = %d", cache_config_alt_rewrite_max_size);
 
@@ -3203,6 +3507,14 @@ ink_cache_init(ts::ModuleVersion v)
   Debug("cache_init", "proxy.config.cache.enable_read_while_writer = %d", cache_config_read_while_writer);
 
   register_cache_stats(cache_rsb, "proxy.process.cache");
+  // totals for the last directory sync pass over all volumes, not tracked per volume
+  reg_int("sync.cycle.bytes", cache_directory_sync_cycle_bytes_stat, cache_rsb, "proxy.process.cache");
+  reg_int("sync.cycle.time", cache_directory_sync_cycle_time_stat, cache_rsb, "proxy.process.cache");
+  // startup timings, the volume ones are those of the slowest volume
+  reg_int("startup.time", cache_startup_time_stat, cache_rsb, "proxy.process.cache");
+  reg_int("startup.dir_read.time", cache_startup_dir_read_time_stat, cache_rsb, "proxy.process.cache");
+  reg_int("startup.recovery.time", cache_startup_recovery_time_stat, cache_rsb, "proxy.process.cache");
+  reg_int("ram_cache.warm.time", cache_ram_cache_warm_time_stat, cache_rsb, "proxy.process.cache");
 
   REC_ReadConfigInteger(cacheProcessor.wait_for_cache, "proxy.config.http.wait_for_cache");
 
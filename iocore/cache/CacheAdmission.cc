@@ -0,0 +1,174 @@
+/** @file
+
+  TinyLFU style admission filter for cache writes
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_Cache.h"
+
+/*
+  Every HTTP cache lookup is counted in the sketch of its volume, and a
+  new object is only written once its key has been looked up at least
+  admission_min_hits times within the sketch's sampling period.  TinyLFU
+  compares the candidate with the eviction victim instead, but the victim
+  of a cyclic volume is whatever lies under the write cursor when the
+  aggregation buffer is flushed, long after the admission decision, so a
+  fixed threshold is used.
+
+  The sketch has about as many counters per row as the volume has
+  directory entries, which costs two bytes per directory entry.
+
+  The same counts decide which hits ahead of the write cursor are worth
+  evacuating, so the sketch is also kept for hit_evacuate_min_hits, and
+  which objects of a cold volume are promoted to its hot tier.
+*/
+
+#define CACHE_ADMISSION_MIN_WIDTH 1024
+
+CacheAdmissionSketch::CacheAdmissionSketch(int64_t width)
+{
+  uint64_t w = CACHE_ADMISSION_MIN_WIDTH;
+  while (w * 2 <= static_cast<uint64_t>(width)) {
+    w *= 2;
+  }
+  _mask  = w - 1;
+  _table = static_cast<uint8_t *>(ats_calloc(CACHE_ADMISSION_DEPTH * w / 2, 1));
+}
+
+CacheAdmissionSketch::~CacheAdmissionSketch()
+{
+  ats_free(_table);
+}
+
+// Double hashing over the two halves of the key, which is already a cryptographic hash.
+void
+CacheAdmissionSketch::_index(const CryptoHash *key, uint64_t idx[CACHE_ADMISSION_DEPTH]) const
+{
+  uint64_t h1 = key->u64[0];
+  uint64_t h2 = key->u64[1] | 1;
+  for (int row = 0; row < CACHE_ADMISSION_DEPTH; row++) {
+    idx[row] = row * (_mask + 1) + ((h1 + row * h2) & _mask);
+  }
+}
+
+int
+CacheAdmissionSketch::_get(uint64_t i) const
+{
+  return (_table[i >> 1] >> ((i & 1) << 2)) & 0xf;
+}
+
+void
+CacheAdmissionSketch::increment(const CryptoHash *key)
+{
+  uint64_t idx[CACHE_ADMISSION_DEPTH];
+  int count[CACHE_ADMISSION_DEPTH];
+  int min = CACHE_ADMISSION_MAX_COUNT;
+
+  _index(key, idx);
+  for (int row = 0; row < CACHE_ADMISSION_DEPTH; row++) {
+    count[row] = _get(idx[row]);
+    if (count[row] < min) {
+      min = count[row];
+    }
+  }
+  if (min == CACHE_ADMISSION_MAX_COUNT) {
+    return;
+  }
+  // conservative update, the other counters already overestimate this key
+  for (int row = 0; row < CACHE_ADMISSION_DEPTH; row++) {
+    if (count[row] == min) {
+      _table[idx[row] >> 1] += 1 << ((idx[row] & 1) << 2);
+    }
+  }
+  if (++_samples >= CACHE_ADMISSION_SAMPLE_FACTOR * width()) {
+    _age();
+  }
+}
+
+int
+CacheAdmissionSketch::estimate(const CryptoHash *key) const
+{
+  uint64_t idx[CACHE_ADMISSION_DEPTH];
+  int min = CACHE_ADMISSION_MAX_COUNT;
+
+  _index(key, idx);
+  for (int row = 0; row < CACHE_ADMISSION_DEPTH; row++) {
+    int c = _get(idx[row]);
+    if (c < min) {
+      min = c;
+    }
+  }
+  return min;
+}
+
+void
+CacheAdmissionSketch::_age()
+{
+  int64_t len = CACHE_ADMISSION_DEPTH * width() / 2;
+  for (int64_t i = 0; i < len; i++) {
+    _table[i] = (_table[i] >> 1) & 0x77;
+  }
+  _samples /= 2;
+}
+
+static int
+admission_min_hits(Vol *vol)
+{
+  int min_hits = vol->cache_vol->admission_min_hits;
+  return min_hits >= 0 ? min_hits : cache_config_admission_min_hits;
+}
+
+void
+cache_admission_record(Vol *vol, const CryptoHash *key)
+{
+  if (admission_min_hits(vol) <= 0 && cache_config_hit_evacuate_min_hits <= 0 && !vol->cache_vol->hot_tier) {
+    return;
+  }
+  if (!vol->admission) {
+    vol->admission = new CacheAdmissionSketch(vol->direntries());
+    Debug("cache_init", "Vol %s: admission sketch of %" PRId64 " counters per row", vol->hash_text.get(),
+          vol->admission->width());
+  }
+  vol->admission->increment(key);
+}
+
+bool
+cache_admission_admit(Vol *vol, const CryptoHash *key)
+{
+  int min_hits = admission_min_hits(vol);
+  if (min_hits <= 0) {
+    return true;
+  }
+  if (vol->admission && vol->admission->estimate(key) >= min_hits) {
+    CACHE_SUM_DYN_STAT_THREAD(cache_admission_admitted_stat, 1);
+    return true;
+  }
+  CACHE_SUM_DYN_STAT_THREAD(cache_admission_rejected_stat, 1);
+  return false;
+}
+
+bool
+cache_admission_hot(Vol *vol, const CryptoHash *key)
+{
+  if (cache_config_hit_evacuate_min_hits <= 0) {
+    return true;
+  }
+  return vol->admission && vol->admission->estimate(key) >= cache_config_hit_evacuate_min_hits;
+}
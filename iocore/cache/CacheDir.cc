@@ -27,6 +27,10 @@
 #include "tscore/Regression.h"
 #include "tscore/Random.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 // #define LOOP_CHECK_MODE 1
 #ifdef LOOP_CHECK_MODE
 #define DIR_LOOP_THRESHOLD 1000
@@ -210,6 +214,100 @@ dir_bucket_loop_check(Dir *start_dir, Dir *seg)
   return 1;
 }
 
+// Directory tag index
+//
+// An optional copy of the tag of every directory entry, laid out like the
+// directory itself so that the DIR_DEPTH entries of a bucket row are
+// adjacent.  A lookup compares the whole row at once and only walks the
+// bucket chain if one of the tags matches or if the chain may have left
+// the row through the segment freelist.
+
+static inline uint16_t *
+dir_tag_index_row(const Vol *d, int s, int64_t b)
+{
+  return d->tag_index + (s * d->buckets + b) * DIR_DEPTH;
+}
+
+// refresh the index slot of e after its offset or tag changed
+static inline void
+dir_tag_index_update(Vol *d, int s, Dir *e)
+{
+  if (d->tag_index) {
+    uint16_t *t = d->tag_index + s * d->buckets * DIR_DEPTH + (e - d->dir_segment(s));
+    uint16_t v  = *t & DIR_TAG_INDEX_OVERFLOW;
+    if (!dir_offset(e) && !dir_next(e)) {
+      v = 0; // empty bucket head, the chain is gone
+    } else if (dir_offset(e)) {
+      v |= DIR_TAG_INDEX_USED | dir_tag(e);
+    }
+    *t = v;
+  }
+}
+
+static inline void
+dir_tag_index_set_overflow(Vol *d, int s, Dir *b)
+{
+  if (d->tag_index) {
+    d->tag_index[s * d->buckets * DIR_DEPTH + (b - d->dir_segment(s))] |= DIR_TAG_INDEX_OVERFLOW;
+  }
+}
+
+// false if the chain of bucket b certainly holds no entry with tag t
+static inline bool
+dir_tag_index_match(const Vol *d, int s, int64_t b, uint32_t t)
+{
+  const uint16_t *row = dir_tag_index_row(d, s, b);
+  if (row[0] & DIR_TAG_INDEX_OVERFLOW) {
+    return true;
+  }
+  uint16_t want = DIR_TAG_INDEX_USED | t;
+#if defined(__SSE2__) && DIR_DEPTH == 4
+  __m128i tags = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(row));
+  __m128i eq   = _mm_cmpeq_epi16(tags, _mm_set1_epi16(want));
+  return (_mm_movemask_epi8(eq) & 0xFF) != 0;
+#else
+  for (int i = 0; i < DIR_DEPTH; i++) {
+    if (row[i] == want) {
+      return true;
+    }
+  }
+  return false;
+#endif
+}
+
+static void
+dir_tag_index_build_segment(Vol *d, int s)
+{
+  Dir *seg       = d->dir_segment(s);
+  uint16_t *tags = dir_tag_index_row(d, s, 0);
+  int64_t n      = d->buckets * DIR_DEPTH;
+  for (int64_t i = 0; i < n; i++) {
+    Dir *e  = dir_in_seg(seg, i);
+    tags[i] = dir_offset(e) ? (DIR_TAG_INDEX_USED | dir_tag(e)) : 0;
+  }
+  for (int64_t b = 0; b < d->buckets; b++) {
+    Dir *h = dir_bucket(b, seg);
+    // bounded so that a looping chain cannot hang us, it just disables the shortcut
+    int64_t steps = 0;
+    for (Dir *e = next_dir(h, seg); e; e = next_dir(e, seg)) {
+      if (e < h || e >= h + DIR_DEPTH || ++steps > n) {
+        tags[b * DIR_DEPTH] |= DIR_TAG_INDEX_OVERFLOW;
+        break;
+      }
+    }
+  }
+}
+
+void
+dir_tag_index_build(Vol *d)
+{
+  if (d->tag_index) {
+    for (int s = 0; s < d->segments; s++) {
+      dir_tag_index_build_segment(d, s);
+    }
+  }
+}
+
 // adds all the directory entries
 // in a segment to the segment freelist
 void
@@ -218,6 +316,7 @@ dir_init_segment(int s, Vol *d)
   d->header->freelist[s] = 0;
   Dir *seg               = d->dir_segment(s);
   int l, b;
+  d->dir_segment_mark_dirty(s);
   memset(static_cast<void *>(seg), 0, SIZEOF_DIR * DIR_DEPTH * d->buckets);
   for (l = 1; l < DIR_DEPTH; l++) {
     for (b = 0; b < d->buckets; b++) {
@@ -225,6 +324,9 @@ dir_init_segment(int s, Vol *d)
       dir_free_entry(dir_bucket_row(bucket, l), s, d);
     }
   }
+  if (d->tag_index) {
+    dir_tag_index_build_segment(d, s);
+  }
 }
 
 // break the infinite loop in directory entries
@@ -304,6 +406,7 @@ unlink_from_freelist(Dir *e, int s, Vol *d)
 {
   Dir *seg = d->dir_segment(s);
   Dir *p   = dir_from_offset(dir_prev(e), seg);
+  d->dir_segment_mark_dirty(s);
   if (p) {
     dir_set_next(p, dir_next(e));
   } else {
@@ -321,6 +424,7 @@ dir_delete_entry(Dir *e, Dir *p, int s, Vol *d)
   Dir *seg         = d->dir_segment(s);
   int no           = dir_next(e);
   d->header->dirty = 1;
+  d->dir_segment_mark_dirty(s);
   if (p) {
     unsigned int fo = d->header->freelist[s];
     unsigned int eo = dir_to_offset(e, seg);
@@ -331,14 +435,17 @@ dir_delete_entry(Dir *e, Dir *p, int s, Vol *d)
       dir_set_prev(dir_from_offset(fo, seg), eo);
     }
     d->header->freelist[s] = eo;
+    dir_tag_index_update(d, s, e);
   } else {
     Dir *n = next_dir(e, seg);
     if (n) {
       dir_assign(e, n);
+      dir_tag_index_update(d, s, e);
       dir_delete_entry(n, e, s, d);
       return e;
     } else {
       dir_clear(e);
+      dir_tag_index_update(d, s, e);
       return nullptr;
     }
   }
@@ -404,6 +511,8 @@ dir_clear_range(off_t start, off_t end, Vol *vol)
     if (dir_offset(e) >= static_cast<int64_t>(start) && dir_offset(e) < static_cast<int64_t>(end)) {
       CACHE_DEC_DIR_USED(vol->mutex);
       dir_set_offset(e, 0); // delete
+      vol->dir_segment_mark_dirty(i / (vol->buckets * DIR_DEPTH));
+      dir_tag_index_update(vol, i / (vol->buckets * DIR_DEPTH), e);
     }
   }
   dir_clean_vol(vol);
@@ -439,6 +548,8 @@ freelist_clean(int s, Vol *vol)
       if (dir_head(e) && !(n++ % 10)) {
         CACHE_DEC_DIR_USED(vol->mutex);
         dir_set_offset(e, 0); // delete
+        vol->dir_segment_mark_dirty(s);
+        dir_tag_index_update(vol, s, e);
       }
     }
   }
@@ -455,6 +566,7 @@ freelist_pop(int s, Vol *d)
     return nullptr;
   }
   d->header->freelist[s] = dir_next(e);
+  d->dir_segment_mark_dirty(s);
   // if the freelist if bad, punt.
   if (dir_offset(e)) {
     dir_init_segment(s, d);
@@ -531,6 +643,7 @@ dir_free_entry(Dir *e, int s, Vol *d)
     dir_set_prev(dir_from_offset(fo, seg), eo);
   }
   d->header->freelist[s] = eo;
+  d->dir_segment_mark_dirty(s);
 }
 
 int
@@ -547,6 +660,11 @@ dir_probe(const CacheKey *key, Vol *d, Dir *result, Dir **last_collision)
   if (dir_bucket_loop_fix(dir_bucket(b, seg), s, d))
     return 0;
 #endif
+  // nothing in the bucket can match, skip the chain walk
+  if (d->tag_index && !collision && !dir_tag_index_match(d, s, b, DIR_MASK_TAG(key->slice32(2)))) {
+    DDebug("dir_probe_miss", "missed %X %X on vol %d bucket %d at %p (tag index)", key->slice32(0), key->slice32(1), d->fd, b, seg);
+    return 0;
+  }
 Lagain:
   e = dir_bucket(b, seg);
   if (dir_offset(e)) {
@@ -639,17 +757,20 @@ Lagain:
   if (!e) {
     goto Lagain;
   }
+  dir_tag_index_set_overflow(d, s, b);
 Llink:
   dir_set_next(e, dir_next(b));
   dir_set_next(b, dir_to_offset(e, seg));
 Lfill:
   dir_assign_data(e, to_part);
   dir_set_tag(e, key->slice32(2));
+  dir_tag_index_update(d, s, e);
   ink_assert(d->vol_offset(e) < (d->skip + d->len));
   DDebug("dir_insert", "insert %p %X into vol %d bucket %d at %p tag %X %X boffset %" PRId64 "", e, key->slice32(0), d->fd, bi, e,
          key->slice32(1), dir_tag(e), dir_offset(e));
   CHECK_DIR(d);
   d->header->dirty = 1;
+  d->dir_segment_mark_dirty(s);
   CACHE_INC_DIR_USED(d->mutex);
   return 1;
 }
@@ -715,6 +836,7 @@ Lagain:
   if (!e) {
     goto Lagain;
   }
+  dir_tag_index_set_overflow(d, s, b);
 Llink:
   CACHE_INC_DIR_USED(d->mutex);
   dir_set_next(e, dir_next(b));
@@ -722,11 +844,13 @@ Llink:
 Lfill:
   dir_assign_data(e, dir);
   dir_set_tag(e, t);
+  dir_tag_index_update(d, s, e);
   ink_assert(d->vol_offset(e) < d->skip + d->len);
   DDebug("dir_overwrite", "overwrite %p %X into vol %d bucket %d at %p tag %X %X boffset %" PRId64 "", e, key->slice32(0), d->fd,
          bi, e, t, dir_tag(e), dir_offset(e));
   CHECK_DIR(d);
   d->header->dirty = 1;
+  d->dir_segment_mark_dirty(s);
   return res;
 }
 
@@ -963,6 +1087,16 @@ sync_cache_dir_on_shutdown()
     // recompute hit_evacuate_window
     d->hit_evacuate_window = (d->data_blocks * cache_config_hit_evacuate_percent) / 100;
 
+    // the writes in flight may not complete before we exit, repeat them
+    for (int j = 0; j < d->agg_writes_in_flight; j++) {
+      AIOCallback *op = &d->agg_writes[(d->agg_write_first + j) % d->agg_buffers].io;
+      ssize_t r       = pwrite(d->fd, op->aiocb.aio_buf, op->aiocb.aio_nbytes, op->aiocb.aio_offset);
+      if (r != static_cast<ssize_t>(op->aiocb.aio_nbytes)) {
+        ink_assert(!"flushing agg buffer failed");
+      }
+      d->header->last_write_pos = op->aiocb.aio_offset;
+    }
+
     // check if we have data in the agg buffer
     // dont worry about the cachevc s in the agg queue
     // directories have not been inserted for these writes
@@ -971,6 +1105,7 @@ sync_cache_dir_on_shutdown()
 
       // set write limit
       d->header->agg_pos = d->header->write_pos + d->agg_buf_pos;
+      d->write_clock += d->agg_buf_pos;
 
       int r = pwrite(d->fd, d->agg_buffer, d->agg_buf_pos, d->header->write_pos);
       if (r != d->agg_buf_pos) {
@@ -1020,6 +1155,8 @@ sync_cache_dir_on_shutdown()
     Debug("cache_dir_sync", "done syncing dir for vol %s", d->hash_text.get());
   }
   Debug("cache_dir_sync", "sync done");
+  // the directories on disk now match memory, remember what was hot in the RAM caches
+  ram_cache_checkpoint_save();
   if (buf) {
     if (buf_huge) {
       ats_free_hugepage(buf, buflen);
@@ -1030,6 +1167,72 @@ sync_cache_dir_on_shutdown()
   }
 }
 
+/*
+ * Copy the dirty segments of the directory into the sync buffer and take
+ * ownership of the dirty bits of the copy about to be written.  Only the
+ * header, the footer and the copied segments of the buffer are valid
+ * afterwards.
+ */
+void
+CacheSync::snapshot_dirty_segments(Vol *vol)
+{
+  size_t dirlen = vol->dirlen();
+  int footerlen = ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter));
+  int B         = vol->header->sync_serial & 1;
+
+  segments.swap(vol->dir_segment_dirty[B]);
+  vol->dir_segment_dirty[B].assign(vol->segments, false);
+  segment_idx = 0;
+
+  memcpy(buf, vol->raw_dir, vol->headerlen());
+  memcpy(buf + dirlen - footerlen, vol->raw_dir + dirlen - footerlen, footerlen);
+  if (!incremental) {
+    memcpy(buf + vol->headerlen(), vol->raw_dir + vol->headerlen(), dirlen - vol->headerlen() - footerlen);
+    return;
+  }
+  off_t pos;
+  int len;
+  while (next_segment_range(vol, pos, len)) {
+    memcpy(buf + pos, vol->raw_dir + pos, len);
+  }
+  segment_idx = 0;
+}
+
+/*
+ * Find the next run of dirty segments starting at segment_idx, widened to
+ * store block boundaries so the write stays aligned, and limited to
+ * SYNC_MAX_WRITE.  Returns the number of segments in the run, 0 when no
+ * dirty segments remain.
+ */
+int
+CacheSync::next_segment_range(Vol *vol, off_t &pos, int &len)
+{
+  off_t seglen  = vol->buckets * DIR_DEPTH * SIZEOF_DIR;
+  off_t dir_end = vol->dirlen() - ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter));
+
+  while (segment_idx < vol->segments && !segments[segment_idx]) {
+    ++segment_idx;
+  }
+  if (segment_idx >= vol->segments) {
+    return 0;
+  }
+  int first       = segment_idx;
+  off_t seg_start = vol->headerlen() + segment_idx * seglen;
+  off_t end       = seg_start;
+  pos             = seg_start - seg_start % STORE_BLOCK_SIZE;
+  while (segment_idx < vol->segments && segments[segment_idx]) {
+    off_t seg_end = std::min(static_cast<off_t>(ROUND_TO_STORE_BLOCK(seg_start + seglen)), dir_end);
+    if (segment_idx > first && seg_end - pos > SYNC_MAX_WRITE) {
+      break;
+    }
+    end = seg_end;
+    ++segment_idx;
+    seg_start += seglen;
+  }
+  len = end - pos;
+  return segment_idx - first;
+}
+
 int
 CacheSync::mainEvent(int event, Event *e)
 {
@@ -1051,6 +1254,12 @@ Lrestart:
       buf      = nullptr;
       buf_huge = false;
     }
+    if (cycle_start) {
+      GLOBAL_CACHE_SET_DYN_STAT(cache_directory_sync_cycle_bytes_stat, cycle_bytes);
+      GLOBAL_CACHE_SET_DYN_STAT(cache_directory_sync_cycle_time_stat, Thread::get_hrtime() - cycle_start);
+      cycle_bytes = 0;
+      cycle_start = 0;
+    }
     Debug("cache_dir_sync", "sync done");
     if (event == EVENT_INTERVAL) {
       trigger = e->ethread->schedule_in(this, HRTIME_SECONDS(cache_config_dir_sync_frequency));
@@ -1062,14 +1271,21 @@ Lrestart:
 
   Vol *vol = gvol[vol_idx]; // must be named "vol" to make STAT macros work.
 
+  if (!cycle_start) {
+    cycle_start = Thread::get_hrtime();
+  }
+
   if (event == AIO_EVENT_DONE) {
     // AIO Thread
     if (io.aio_result != static_cast<int64_t>(io.aiocb.aio_nbytes)) {
       Warning("vol write error during directory sync '%s'", gvol[vol_idx]->hash_text.get());
-      event = EVENT_NONE;
-      goto Ldone;
+      // the partially written copy is invalid, clean up under the volume lock
+      io_error = true;
+      trigger  = eventProcessor.schedule_imm(this);
+      return EVENT_CONT;
     }
     CACHE_SUM_DYN_STAT(cache_directory_sync_bytes_stat, io.aio_result);
+    cycle_bytes += io.aio_result;
 
     trigger = eventProcessor.schedule_in(this, SYNC_DELAY);
     return EVENT_CONT;
@@ -1081,6 +1297,15 @@ Lrestart:
       return EVENT_CONT;
     }
 
+    if (io_error) {
+      io_error = false;
+      // every segment must be rewritten before this copy is valid again
+      vol->dir_segment_dirty[vol->header->sync_serial & 1].assign(vol->segments, true);
+      vol->header->dirty        = 1;
+      vol->dir_sync_in_progress = false;
+      goto Ldone;
+    }
+
     if (!vol->dir_sync_in_progress) {
       start_time = Thread::get_hrtime();
     }
@@ -1106,7 +1331,7 @@ Lrestart:
         Debug("cache_dir_sync", "Dir %s not dirty", vol->hash_text.get());
         goto Ldone;
       }
-      if (vol->is_io_in_progress() || vol->agg_buf_pos) {
+      if (vol->is_io_in_progress() || vol->agg_writes_in_flight || vol->agg_buf_pos) {
         Debug("cache_dir_sync", "Dir %s: waiting for agg buffer", vol->hash_text.get());
         vol->dir_sync_waiting = true;
         if (!vol->is_io_in_progress()) {
@@ -1138,12 +1363,37 @@ Lrestart:
       vol->header->sync_serial++;
       vol->footer->sync_serial = vol->header->sync_serial;
       CHECK_DIR(d);
-      memcpy(buf, vol->raw_dir, dirlen);
+      incremental = cache_config_dir_sync_incremental;
+      snapshot_dirty_segments(vol);
       vol->dir_sync_in_progress = true;
     }
     size_t B    = vol->header->sync_serial & 1;
     off_t start = vol->skip + (B ? dirlen : 0);
 
+    if (incremental) {
+      off_t pos;
+      int l;
+      int n;
+      if (!writepos) {
+        // write header, including the segment freelists
+        aio_write(vol->fd, buf, vol->headerlen(), start);
+        writepos = vol->headerlen();
+      } else if ((n = next_segment_range(vol, pos, l)) > 0) {
+        // write the next run of dirty segments
+        aio_write(vol->fd, buf + pos, l, start + pos);
+        writepos = pos + l;
+        CACHE_SUM_DYN_STAT(cache_directory_sync_segments_stat, n);
+      } else if (writepos < static_cast<off_t>(dirlen)) {
+        // write footer
+        writepos = dirlen - headerlen;
+        aio_write(vol->fd, buf + writepos, headerlen, start + writepos);
+        writepos += headerlen;
+      } else {
+        goto Lsynced;
+      }
+      return EVENT_CONT;
+    }
+
     if (!writepos) {
       // write header
       aio_write(vol->fd, buf + writepos, headerlen, start + writepos);
@@ -1162,13 +1412,16 @@ Lrestart:
       aio_write(vol->fd, buf + writepos, headerlen, start + writepos);
       writepos += headerlen;
     } else {
-      vol->dir_sync_in_progress = false;
-      CACHE_INCREMENT_DYN_STAT(cache_directory_sync_count_stat);
-      CACHE_SUM_DYN_STAT(cache_directory_sync_time_stat, Thread::get_hrtime() - start_time);
-      start_time = 0;
-      goto Ldone;
+      goto Lsynced;
     }
     return EVENT_CONT;
+
+  Lsynced:
+    vol->dir_sync_in_progress = false;
+    CACHE_INCREMENT_DYN_STAT(cache_directory_sync_count_stat);
+    CACHE_SUM_DYN_STAT(cache_directory_sync_time_stat, Thread::get_hrtime() - start_time);
+    start_time = 0;
+    goto Ldone;
   }
 Ldone:
   // done
@@ -1449,6 +1702,8 @@ EXCLUSIVE_REGRESSION_TEST(Cache_dir)(RegressionTest *t, int /* atype ATS_UNUSED
   int free     = dir_freelist_length(d, s);
   int n        = free;
   rprintf(t, "free: %d\n", free);
+  d->dir_segment_dirty[0].assign(d->segments, false);
+  d->dir_segment_dirty[1].assign(d->segments, false);
   while (n--) {
     if (!dir_insert(&key, d, &dir)) {
       break;
@@ -1459,6 +1714,13 @@ EXCLUSIVE_REGRESSION_TEST(Cache_dir)(RegressionTest *t, int /* atype ATS_UNUSED
   if (static_cast<unsigned int>(inserted - free) > 1) {
     ret = REGRESSION_TEST_FAILED;
   }
+  // only the segment inserted into needs to be synced
+  for (i = 0; i < d->segments; i++) {
+    if (d->dir_segment_dirty[0][i] != (i == s) || d->dir_segment_dirty[1][i] != (i == s)) {
+      rprintf(t, "segment %d dirty state is wrong\n", i);
+      ret = REGRESSION_TEST_FAILED;
+    }
+  }
 
   // test delete
   rprintf(t, "delete test\n");
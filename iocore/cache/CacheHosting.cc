@@ -428,7 +428,8 @@ CacheHostRecord::Init(CacheType typ)
   num_cachevols    = 0;
   CacheVol *cachep = cp_list.head;
   for (; cachep; cachep = cachep->link.next) {
-    if (cachep->scheme == type) {
+    // a hot tier only holds copies of objects of its cold volumes
+    if (cachep->scheme == type && !cachep->is_hot_tier) {
       Debug("cache_hosting", "Host Record: %p, Volume: %d, size: %" PRId64, this, cachep->vol_number, (int64_t)cachep->size);
       cp[num_cachevols] = cachep;
       num_cachevols++;
@@ -517,6 +518,11 @@ CacheHostRecord::Init(matcher_line *line_info, CacheType typ)
           for (; cachep; cachep = cachep->link.next) {
             if (cachep->vol_number == volume_number) {
               is_vol_present = 1;
+              if (cachep->is_hot_tier) {
+                RecSignalWarning(REC_SIGNAL_CONFIG_ERROR, "%s ignoring volume %d at line %d of %s : it is a hot_volume",
+                                 "[CacheHosting]", volume_number, line_info->line_num, config_file);
+                break;
+              }
               if (cachep->scheme == type) {
                 Debug("cache_hosting", "Host Record: %p, Volume: %d, size: %ld", this, volume_number,
                       (long)(cachep->size * STORE_BLOCK_SIZE));
@@ -643,13 +649,15 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
     line_num++;
 
     char *end;
-    char *line_end        = nullptr;
-    const char *err       = nullptr;
-    int volume_number     = 0;
-    CacheType scheme      = CACHE_NONE_TYPE;
-    int size              = 0;
-    int in_percent        = 0;
-    bool ramcache_enabled = true;
+    char *line_end         = nullptr;
+    const char *err        = nullptr;
+    int volume_number      = 0;
+    CacheType scheme       = CACHE_NONE_TYPE;
+    int size               = 0;
+    int in_percent         = 0;
+    bool ramcache_enabled  = true;
+    int admission_min_hits = -1;
+    int hot_volume         = 0;
 
     while (true) {
       // skip all blank spaces at beginning of line
@@ -749,6 +757,34 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
           err = "Unexpected end of line";
           break;
         }
+      } else if (strcasecmp(tmp, "admission_min_hits") == 0) { // match admission_min_hits
+        tmp += 19;
+        if (!ParseRules::is_digit(*tmp)) {
+          err = "Unexpected end of line";
+          break;
+        }
+        admission_min_hits = atoi(tmp);
+        while (ParseRules::is_digit(*tmp)) {
+          tmp++;
+        }
+        if (admission_min_hits > CACHE_ADMISSION_MAX_COUNT) {
+          err = "Bad admission_min_hits";
+          break;
+        }
+      } else if (strcasecmp(tmp, "hot_volume") == 0) { // match hot_volume
+        tmp += 11;
+        if (!ParseRules::is_digit(*tmp)) {
+          err = "Unexpected end of line";
+          break;
+        }
+        hot_volume = atoi(tmp);
+        while (ParseRules::is_digit(*tmp)) {
+          tmp++;
+        }
+        if (hot_volume < 1 || hot_volume > 255 || hot_volume == volume_number) {
+          err = "Bad hot_volume";
+          break;
+        }
       }
 
       // ends here
@@ -771,10 +807,12 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
       } else {
         configp->in_percent = false;
       }
-      configp->scheme           = scheme;
-      configp->size             = size;
-      configp->cachep           = nullptr;
-      configp->ramcache_enabled = ramcache_enabled;
+      configp->scheme             = scheme;
+      configp->size               = size;
+      configp->cachep             = nullptr;
+      configp->ramcache_enabled   = ramcache_enabled;
+      configp->admission_min_hits = admission_min_hits;
+      configp->hot_volume         = hot_volume;
       cp_queue.enqueue(configp);
       num_volumes++;
       if (scheme == CACHE_HTTP_TYPE) {
@@ -782,8 +820,9 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
       } else {
         ink_release_assert(!"Unexpected non-HTTP cache volume");
       }
-      Debug("cache_hosting", "added volume=%d, scheme=%d, size=%d percent=%d, ramcache enabled=%d", volume_number, scheme, size,
-            in_percent, ramcache_enabled);
+      Debug("cache_hosting",
+            "added volume=%d, scheme=%d, size=%d percent=%d, ramcache enabled=%d, admission min hits=%d, hot volume=%d",
+            volume_number, scheme, size, in_percent, ramcache_enabled, admission_min_hits, hot_volume);
     }
 
     tmp = bufTok.iterNext(&i_state);
@@ -24,6 +24,7 @@
 #include "P_Cache.h"
 
 #include "HttpCacheSM.h" //Added to get the scope of HttpCacheSM object.
+#include "I_NetVConnection.h"
 
 Action *
 Cache::open_read(Continuation *cont, const CacheKey *key, CacheFragType type, const char *hostname, int host_len)
@@ -34,7 +35,7 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheFragType type, co
   }
   ink_assert(caches[type] == this);
 
-  Vol *vol = key_to_vol(key, hostname, host_len);
+  Vol *vol = cache_tier_select(key_to_vol(key, hostname, host_len), key);
   Dir result, *last_collision = nullptr;
   ProxyMutex *mutex = cont->mutex.get();
   OpenDirEntry *od  = nullptr;
@@ -100,7 +101,8 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheHTTPHdr *request,
   }
   ink_assert(caches[type] == this);
 
-  Vol *vol = key_to_vol(key, hostname, host_len);
+  Vol *cold = key_to_vol(key, hostname, host_len);
+  Vol *vol  = cache_tier_select(cold, key);
   Dir result, *last_collision = nullptr;
   ProxyMutex *mutex = cont->mutex.get();
   OpenDirEntry *od  = nullptr;
@@ -121,10 +123,17 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheHTTPHdr *request,
       c->od        = od;
     }
     if (!lock.is_locked()) {
+      // counted by openReadStartHead once it has the lock, contended keys are the hot ones
+      c->f.admission_pending = true;
+      c->tier_vol            = vol != cold ? cold : nullptr;
       SET_CONTINUATION_HANDLER(c, &CacheVC::openReadStartHead);
       CONT_SCHED_LOCK_RETRY(c);
       return &c->_action;
     }
+    cache_admission_record(vol, key);
+    if (vol != cold && !cache_tier_record(cold, key) && c) {
+      c->tier_vol = cold;
+    }
     if (!c) {
       goto Lmiss;
     }
@@ -639,6 +648,51 @@ LreadMain:
   return openReadMain(event, e);
 }
 
+bool
+CacheVC::sendfile_to(NetVConnection *vc)
+{
+  // the whole body goes to vc in order, checksums could not be verified on data never read
+  if (!cache_config_sendfile || cache_config_enable_checksum || vio.op != VIO::READ || vio.ndone || seek_to ||
+      f.read_from_writer_called || static_cast<int64_t>(doc_len) < cache_config_sendfile_min_size || !vc->is_sendfile_capable()) {
+    return false;
+  }
+  sendfile_vc = vc;
+  Debug("cache_sendfile", "%p: sending %" PRId64 " bytes to vc %p from the disk", this, doc_len, vc);
+  return true;
+}
+
+/*
+  Look for the body fragment akey in a RAM cache that does not need the
+  volume lock.  The key of a body fragment is never reused, so the key
+  alone identifies its data and the directory is not needed.  A miss is
+  remembered so that the read under the volume lock does not count it twice.
+*/
+bool
+CacheVC::ram_cache_read_unlocked(CacheKey *akey)
+{
+  if (f.ram_cache_missed || !vol->ram_cache->has_own_locks()) {
+    return false;
+  }
+  Ptr<IOBufferData> data;
+  int ram_hit_state = vol->ram_cache->get(akey, &data, RAM_CACHE_ANY_AUXKEY);
+  if (ram_hit_state < RAM_HIT_COMPRESS_NONE) {
+    f.ram_cache_missed = true;
+    return false;
+  }
+  // fragments with headers must go through CacheVC::handleReadDone
+  Doc *doc = reinterpret_cast<Doc *>(data->data());
+  if (doc->magic != DOC_MAGIC || !(doc->key == *akey) || doc->hlen) {
+    return false;
+  }
+  buf                  = data;
+  read_key             = akey;
+  io.aio_result        = doc->len;
+  f.doc_from_ram_cache = true;
+  f.doc_header_only    = false;
+  f.compressed_in_ram  = (ram_hit_state > RAM_HIT_COMPRESS_NONE) ? 1 : 0;
+  return true;
+}
+
 int
 CacheVC::openReadMain(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
 {
@@ -767,15 +821,25 @@ CacheVC::openReadMain(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
   if (vio.buffer.writer()->max_read_avail() > vio.buffer.writer()->water_mark && vio.ndone) { // initiate read of first block
     return EVENT_CONT;
   }
+  // the client is still sending the previous fragment from the disk, it signals when it is done
+  if (sendfile_vc && sendfile_vc->sendfile_pending() > 0) {
+    return EVENT_CONT;
+  }
   if ((bytes <= 0) && vio.ntodo() >= 0) {
     goto Lread;
   }
   if (bytes > vio.ntodo()) {
     bytes = vio.ntodo();
   }
-  b           = new_IOBufferBlock(buf, bytes, doc_pos);
-  b->_buf_end = b->_end;
-  vio.buffer.writer()->append_block(b);
+  if (f.doc_header_only) {
+    if (!sendfile_vc->sendfile_from(vol->fd, vol->vol_offset(&dir) + doc_pos, bytes, &vol->write_clock, sendfile_write_limit)) {
+      goto Lerror;
+    }
+  } else {
+    b           = new_IOBufferBlock(buf, bytes, doc_pos);
+    b->_buf_end = b->_end;
+    vio.buffer.writer()->append_block(b);
+  }
   vio.ndone += bytes;
   doc_pos += bytes;
   if (vio.ntodo() <= 0) {
@@ -803,6 +867,13 @@ Lread : {
   // EVENT_IMMEDIATE events. So, we have to cancel that trigger and set
   // a new EVENT_INTERVAL event.
   cancel_trigger();
+  if (ram_cache_read_unlocked(&key)) {
+    doc = reinterpret_cast<Doc *>(buf->data());
+    fragment++;
+    doc_pos = doc->prefix_len();
+    next_CacheKey(&key, &key);
+    return openReadMain(EVENT_IMMEDIATE, nullptr);
+  }
   CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
   if (!lock.is_locked()) {
     SET_HANDLER(&CacheVC::openReadMain);
@@ -911,7 +982,8 @@ CacheVC::openReadStartEarliest(int /* event ATS_UNUSED */, Event * /* e ATS_UNUS
     next_CacheKey(&key, &doc->key);
     vol->begin_read(this);
     if (vol->within_hit_evacuate_window(&earliest_dir) &&
-        (!cache_config_hit_evacuate_size_limit || doc_len <= static_cast<uint64_t>(cache_config_hit_evacuate_size_limit))) {
+        (!cache_config_hit_evacuate_size_limit || doc_len <= static_cast<uint64_t>(cache_config_hit_evacuate_size_limit)) &&
+        cache_admission_hot(vol, &first_key)) {
       DDebug("cache_hit_evac", "dir: %" PRId64 ", write: %" PRId64 ", phase: %d", dir_offset(&earliest_dir),
              vol->offset_to_vol_offset(vol->header->write_pos), vol->header->phase);
       f.hit_evacuate = 1;
@@ -1070,6 +1142,13 @@ CacheVC::openReadStartHead(int event, Event *e)
     if (!lock.is_locked()) {
       VC_SCHED_LOCK_RETRY();
     }
+    if (f.admission_pending) {
+      f.admission_pending = false;
+      cache_admission_record(vol, &first_key);
+    }
+    if (tier_vol && cache_tier_record(tier_vol, &first_key)) {
+      tier_vol = nullptr;
+    }
     if (!buf) {
       goto Lread;
     }
@@ -1145,6 +1224,7 @@ CacheVC::openReadStartHead(int event, Event *e)
         err = ECACHE_BAD_META_DATA;
         goto Ldone;
       }
+      cache_tier_read_head(this, doc);
       if (cache_config_select_alternate) {
         alternate_index = HttpTransactCache::SelectFromAlternates(&vector, &request, params);
         if (alternate_index < 0) {
@@ -1209,7 +1289,8 @@ CacheVC::openReadStartHead(int event, Event *e)
     }
 
     if (vol->within_hit_evacuate_window(&dir) &&
-        (!cache_config_hit_evacuate_size_limit || doc_len <= static_cast<uint64_t>(cache_config_hit_evacuate_size_limit))) {
+        (!cache_config_hit_evacuate_size_limit || doc_len <= static_cast<uint64_t>(cache_config_hit_evacuate_size_limit)) &&
+        cache_admission_hot(vol, &first_key)) {
       DDebug("cache_hit_evac", "dir: %" PRId64 ", write: %" PRId64 ", phase: %d", dir_offset(&dir),
              vol->offset_to_vol_offset(vol->header->write_pos), vol->header->phase);
       f.hit_evacuate = 1;
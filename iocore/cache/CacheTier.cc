@@ -0,0 +1,285 @@
+/** @file
+
+  Two tier volumes, popular objects of a cold volume are copied to a hot volume
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_Cache.h"
+
+#include <algorithm>
+
+/*
+  A volume with hot_volume=N in volume.config is the cold tier of volume
+  N.  The hot tier is not assigned to any host, it only holds copies of
+  objects of its cold volumes, so it is typically a small volume forced
+  onto an NVMe span in front of large HDD volumes.
+
+  Every object is written to the cold tier.  When the head of an object
+  is read from the cold tier and the admission sketch of the cold stripe
+  counted at least tier.promote_min_hits recent lookups of it, the
+  document is copied to the aggregation queue of the hot stripe, like an
+  evacuated document.  Only objects with a single alternate held entirely
+  in their first document are promoted, larger objects would need every
+  fragment copied.  The
+  copy is entered in the hot directory once it is in the aggregation
+  buffer, and only if the cold directory still points at the document
+  that was copied and no writer has the object open.
+
+  Reads look in the hot directory first.  A write drops the hot copy
+  once it commits the new head to the cold directory, and a remove when
+  it is called, so the hot tier never serves a stale version while a
+  failed or refused write leaves the copy alone.  When the hot stripe is
+  locked the drop is retried by a continuation, the request itself never
+  waits for the hot stripe.  The hot tier is cyclic like any other
+  volume: objects that stop being read are overwritten by newer
+  promotions, which is their demotion, and they are served from the cold
+  tier again.  Hit evacuation on the hot volume keeps its most popular
+  objects.
+*/
+
+static void
+tier_drop(Vol *vol, const CryptoHash *key)
+{
+  Dir result, *last_collision = nullptr;
+  while (dir_probe(key, vol, &result, &last_collision)) {
+    dir_delete(key, vol, &result);
+    last_collision = nullptr;
+  }
+}
+
+void
+cplist_link_tiers()
+{
+  extern Queue<CacheVol> cp_list;
+  extern ConfigVolumes config_volumes;
+
+  for (CacheVol *cp = cp_list.head; cp; cp = cp->link.next) {
+    cp->hot_tier    = nullptr;
+    cp->is_hot_tier = false;
+  }
+  for (ConfigVol *config_vol = config_volumes.cp_queue.head; config_vol; config_vol = config_vol->link.next) {
+    CacheVol *cold = config_vol->cachep;
+    if (!cold || !config_vol->hot_volume) {
+      continue;
+    }
+    CacheVol *hot = cp_list.head;
+    for (; hot && hot->vol_number != config_vol->hot_volume; hot = hot->link.next) {
+      ;
+    }
+    if (!hot || hot == cold || hot->scheme != cold->scheme) {
+      Warning("volume %d: hot_volume=%d is not a volume of the same scheme, not tiering it", cold->vol_number,
+              config_vol->hot_volume);
+      continue;
+    }
+    cold->hot_tier   = hot;
+    hot->is_hot_tier = true;
+    Note("volume %d: objects read %d times are promoted to volume %d", cold->vol_number, cache_config_tier_promote_min_hits,
+         hot->vol_number);
+  }
+  // a hot tier has no hot tier of its own
+  for (CacheVol *cp = cp_list.head; cp; cp = cp->link.next) {
+    if (cp->hot_tier && cp->is_hot_tier) {
+      Warning("volume %d is the hot tier of another volume, ignoring its hot_volume", cp->vol_number);
+      cp->hot_tier = nullptr;
+    }
+  }
+}
+
+Vol *
+cache_tier_hot_vol(Vol *vol, const CryptoHash *key)
+{
+  CacheVol *hot = vol->cache_vol ? vol->cache_vol->hot_tier : nullptr;
+  if (!hot || !hot->num_vols || !hot->vols) {
+    return nullptr;
+  }
+  Vol *v = hot->vols[(key->slice32(2) >> DIR_TAG_WIDTH) % hot->num_vols];
+  return v && v->initialized && !DISK_BAD(v->disk) ? v : nullptr;
+}
+
+Vol *
+cache_tier_select(Vol *vol, const CryptoHash *key)
+{
+  Vol *hot = cache_tier_hot_vol(vol, key);
+  if (!hot) {
+    return vol;
+  }
+  Dir result, *last_collision = nullptr;
+  CACHE_TRY_LOCK(lock, hot->mutex, this_ethread());
+  if (lock.is_locked() && dir_probe(key, hot, &result, &last_collision)) {
+    return hot;
+  }
+  return vol;
+}
+
+// The write path admits objects on the cold stripe, so that is where the reads of a promoted object have to count.
+bool
+cache_tier_record(Vol *cold, const CryptoHash *key)
+{
+  CACHE_TRY_LOCK(lock, cold->mutex, this_ethread());
+  if (!lock.is_locked()) {
+    return false;
+  }
+  cache_admission_record(cold, key);
+  return true;
+}
+
+void
+cache_tier_read_head(CacheVC *vc, Doc *doc)
+{
+  Vol *vol = vc->vol;
+  if (vol->cache_vol->is_hot_tier) {
+    CACHE_SUM_DYN_STAT_THREAD(cache_tier_hot_hits_stat, 1);
+    return;
+  }
+  if (!vol->cache_vol->hot_tier) {
+    return;
+  }
+  CACHE_SUM_DYN_STAT_THREAD(cache_tier_cold_hits_stat, 1);
+
+  // a document from the RAM cache may have its headers unmarshalled in place, and only the
+  // fragments of one alternate are copied so a read selecting another one would miss on the hot tier
+  if (vc->f.doc_from_ram_cache || doc->doc_type != CACHE_FRAG_TYPE_HTTP || !doc->hlen || !doc->data_len() ||
+      !doc->single_fragment() || vc->vector.count() != 1) {
+    return;
+  }
+  if (!vol->admission || vol->admission->estimate(&vc->first_key) < cache_config_tier_promote_min_hits) {
+    return;
+  }
+  Vol *hot = cache_tier_hot_vol(vol, &vc->first_key);
+  if (!hot) {
+    return;
+  }
+  // promotions are best effort, the next read tries again
+  CACHE_TRY_LOCK(lock, hot->mutex, vc->mutex->thread_holding);
+  if (!lock.is_locked() || hot->agg_todo_size > cache_config_agg_write_backlog ||
+      hot->tier_promotions.size() >= CACHE_TIER_MAX_PENDING ||
+      std::find(hot->tier_promotions.begin(), hot->tier_promotions.end(), vc->first_key) != hot->tier_promotions.end()) {
+    return;
+  }
+
+  CacheVC *c = new_CacheVC(hot);
+  {
+    ProxyMutex *mutex = hot->mutex.get();
+    Vol *vol          = hot;
+    c->base_stat      = cache_tier_promote_active_stat;
+    CACHE_INCREMENT_DYN_STAT(c->base_stat + CACHE_STAT_ACTIVE);
+  }
+  c->buf = new_IOBufferData(iobuffer_size_to_index(doc->len, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
+  memcpy(c->buf->data(), doc, doc->len);
+  c->vol           = hot;
+  c->tier_vol      = vol;
+  c->first_key     = vc->first_key;
+  c->earliest_key  = zero_key;
+  c->overwrite_dir = vc->dir;
+  c->f.evacuator   = 1;
+  c->agg_len       = hot->round_to_approx_size(doc->len);
+  SET_CONTINUATION_HANDLER(c, &CacheVC::tierPromoteDone);
+
+  hot->tier_promotions.push_back(vc->first_key);
+  hot->agg_todo_size += c->agg_len;
+  hot->agg.enqueue(c);
+  if (!hot->is_io_in_progress()) {
+    hot->aggWrite(EVENT_NONE, nullptr);
+  }
+}
+
+// Called by aggWrite with the hot stripe locked once the copy is in the aggregation buffer, dir is where it was placed.
+int
+CacheVC::tierPromoteDone(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  // cache_tier_invalidate() takes the key out of tier_promotions when the object is written or removed
+  auto p       = std::find(vol->tier_promotions.begin(), vol->tier_promotions.end(), first_key);
+  bool pending = p != vol->tier_promotions.end();
+  if (pending) {
+    vol->tier_promotions.erase(p);
+  }
+
+  // the object may have been rewritten or removed since it was read
+  bool current = false;
+  if (pending) {
+    CACHE_TRY_LOCK(lock, tier_vol->mutex, mutex->thread_holding);
+    if (lock.is_locked() && !tier_vol->open_read(&first_key)) {
+      Dir cold, *last_collision = nullptr;
+      while (dir_probe(&first_key, tier_vol, &cold, &last_collision)) {
+        if (dir_offset(&cold) == dir_offset(&overwrite_dir) && dir_phase(&cold) == dir_phase(&overwrite_dir)) {
+          current = true;
+          break;
+        }
+      }
+    }
+  }
+  if (current) {
+    tier_drop(vol, &first_key);
+    dir_insert(&first_key, vol, &dir);
+    closed = 1;
+  } else {
+    CACHE_INCREMENT_DYN_STAT(base_stat + CACHE_STAT_FAILURE);
+  }
+  DDebug("cache_tier", "promote %X to %s: %s", first_key.slice32(0), vol->hash_text.get(), current ? "done" : "stale");
+  return free_CacheVC(this);
+}
+
+static void
+tier_forget(Vol *hot, const CryptoHash *key)
+{
+  tier_drop(hot, key);
+  auto p = std::find(hot->tier_promotions.begin(), hot->tier_promotions.end(), *key);
+  if (p != hot->tier_promotions.end()) {
+    hot->tier_promotions.erase(p);
+  }
+}
+
+// Drops a hot copy whose stripe was locked when the object was written or removed.
+struct CacheTierInvalidate : public Continuation {
+  Vol *hot;
+  CryptoHash key;
+
+  int
+  event_handler(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+  {
+    CACHE_TRY_LOCK(lock, hot->mutex, mutex->thread_holding);
+    if (!lock.is_locked()) {
+      CONT_SCHED_LOCK_RETRY_RET(this);
+    }
+    tier_forget(hot, &key);
+    delete this;
+    return EVENT_DONE;
+  }
+
+  CacheTierInvalidate(Vol *v, const CryptoHash *k) : Continuation(new_ProxyMutex()), hot(v), key(*k)
+  {
+    SET_HANDLER(&CacheTierInvalidate::event_handler);
+  }
+};
+
+void
+cache_tier_invalidate(Vol *vol, const CryptoHash *key)
+{
+  Vol *hot = cache_tier_hot_vol(vol, key);
+  if (!hot) {
+    return;
+  }
+  CACHE_TRY_LOCK(lock, hot->mutex, this_ethread());
+  if (lock.is_locked()) {
+    tier_forget(hot, key);
+  } else {
+    this_ethread()->schedule_in_local(new CacheTierInvalidate(hot, key), HRTIME_MSECONDS(cache_config_mutex_retry_delay));
+  }
+}
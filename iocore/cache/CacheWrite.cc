@@ -23,6 +23,8 @@
 
 #include "P_Cache.h"
 
+#include <algorithm>
+
 #define UINT_WRAP_LTE(_x, _y) (((_y) - (_x)) < INT_MAX) // exploit overflow
 #define UINT_WRAP_GTE(_x, _y) (((_x) - (_y)) < INT_MAX) // exploit overflow
 #define UINT_WRAP_LT(_x, _y) (((_x) - (_y)) >= INT_MAX) // exploit overflow
@@ -81,6 +83,7 @@ CacheVC::updateVector(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
           alternate_index = CACHE_ALT_REMOVED;
           if (!write_vector->count()) {
             dir_delete(&first_key, vol, &od->first_dir);
+            cache_tier_invalidate(vol, &first_key);
           }
         }
         // the alternate is not there any more. somebody might have
@@ -229,7 +232,7 @@ CacheVC::handleWrite(int event, Event * /* e ATS_UNUSED */)
   agg_len = vol->round_to_approx_size(write_len + header_len + frag_len + sizeof(Doc));
   vol->agg_todo_size += agg_len;
   bool agg_error = (agg_len > AGG_SIZE || header_len + sizeof(Doc) > MAX_FRAG_SIZE ||
-                    (!f.readers && (vol->agg_todo_size > cache_config_agg_write_backlog + AGG_SIZE) && write_len));
+                    (!f.readers && (vol->agg_todo_size > cache_config_agg_write_backlog + vol->agg_size) && write_len));
 #ifdef CACHE_AGG_FAIL_RATE
   agg_error = agg_error || ((uint32_t)mutex->thread_holding->generator.random() < (uint32_t)(UINT_MAX * CACHE_AGG_FAIL_RATE));
 #endif
@@ -317,30 +320,39 @@ Vol::force_evacuate_head(Dir *evac_dir, int pinned)
   return b;
 }
 
+// The region periodic_scan() looks at, vol offsets [ps, pe) ahead of the write cursor, pe is past the end of the volume on a wrap.
+static void
+scan_region(Vol *vol, int &ps, int &pe)
+{
+  // we can't evacuate anything between header->write_pos and
+  // header->write_pos + agg_size.
+  ps = vol->offset_to_vol_offset(vol->header->write_pos + vol->agg_size);
+  pe = vol->offset_to_vol_offset(vol->header->write_pos + 2 * vol->evacuation_size() + (vol->len / PIN_SCAN_EVERY));
+}
+
+static bool
+scan_region_contains(Vol *vol, int o, int phase, int ps, int pe)
+{
+  int vol_end_offset = vol->offset_to_vol_offset(vol->len + vol->skip);
+  if (phase == static_cast<int>(vol->header->phase)) {
+    return pe >= vol_end_offset && o < (pe - vol_end_offset);
+  }
+  return o >= ps && o < pe;
+}
+
 void
 Vol::scan_for_pinned_documents()
 {
   if (cache_config_permit_pinning) {
-    // we can't evacuate anything between header->write_pos and
-    // header->write_pos + AGG_SIZE.
-    int ps                = this->offset_to_vol_offset(header->write_pos + AGG_SIZE);
-    int pe                = this->offset_to_vol_offset(header->write_pos + 2 * EVACUATION_SIZE + (len / PIN_SCAN_EVERY));
-    int vol_end_offset    = this->offset_to_vol_offset(len + skip);
-    int before_end_of_vol = pe < vol_end_offset;
+    int ps, pe;
+    scan_region(this, ps, pe);
     DDebug("cache_evac", "scan %d %d", ps, pe);
     for (int i = 0; i < this->direntries(); i++) {
       // is it a valid pinned object?
       if (!dir_is_empty(&dir[i]) && dir_pinned(&dir[i]) && dir_head(&dir[i])) {
         // select objects only within this PIN_SCAN region
-        int o = dir_offset(&dir[i]);
-        if (dir_phase(&dir[i]) == header->phase) {
-          if (before_end_of_vol || o >= (pe - vol_end_offset)) {
-            continue;
-          }
-        } else {
-          if (o < ps || o >= pe) {
-            continue;
-          }
+        if (!scan_region_contains(this, dir_offset(&dir[i]), dir_phase(&dir[i]), ps, pe)) {
+          continue;
         }
         force_evacuate_head(&dir[i], 1);
         //      DDebug("cache_evac", "scan pinned at offset %d %d %d %d %d %d",
@@ -350,6 +362,44 @@ Vol::scan_for_pinned_documents()
   }
 }
 
+/*
+  Objects that are hot in the RAM cache are read from memory, so they are
+  not hit evacuated when they come close to the write cursor, and their
+  RAM cache entries become useless once the disk copy is overwritten.
+  Rescue the most recently used ones that lie in the scanned region.  The
+  RAM cache auxkey of a document is its directory offset.
+*/
+void
+Vol::scan_for_hot_documents()
+{
+  if (!cache_config_hit_evacuate_ram_objects || !ram_cache) {
+    return;
+  }
+  std::vector<RamCacheKey> keys;
+  ram_cache->hot_keys(keys, cache_config_hit_evacuate_ram_objects);
+
+  int ps, pe, found = 0;
+  scan_region(this, ps, pe);
+  for (auto &k : keys) {
+    int o = static_cast<int>(k.auxkey);
+    if (!scan_region_contains(this, o, header->phase, ps, pe) && !scan_region_contains(this, o, !header->phase, ps, pe)) {
+      continue;
+    }
+    Dir result;
+    Dir *last_collision = nullptr;
+    while (dir_probe(&k.key, this, &result, &last_collision)) {
+      if (dir_offset(&result) == o) {
+        if (dir_head(&result) && scan_region_contains(this, o, dir_phase(&result), ps, pe)) {
+          force_evacuate_head(&result, dir_pinned(&result));
+          ++found;
+        }
+        break;
+      }
+    }
+  }
+  DDebug("cache_evac", "scan %d %d, %d of %zu hot RAM cache objects to evacuate", ps, pe, found, keys.size());
+}
+
 /* NOTE:: This state can be called by an AIO thread, so DON'T DON'T
    DON'T schedule any events on this thread using VC_SCHED_XXX or
    mutex->thread_holding->schedule_xxx_local(). ALWAYS use
@@ -360,6 +410,16 @@ Vol::aggWriteDone(int event, Event *e)
 {
   cancel_trigger();
 
+  // writes may complete out of order, they are retired in volume order below
+  if (event == AIO_EVENT_DONE) {
+    for (int i = 0; i < agg_writes_in_flight; i++) {
+      AggWriteBuffer *w = &agg_writes[(agg_write_first + i) % agg_buffers];
+      if (static_cast<void *>(&w->io) == static_cast<void *>(e)) {
+        w->done = true;
+      }
+    }
+  }
+
   // ensure we have the cacheDirSync lock if we intend to call it later
   // retaking the current mutex recursively is a NOOP
   CACHE_TRY_LOCK(lock, dir_sync_waiting ? cacheDirSync->mutex : mutex, mutex->thread_holding);
@@ -367,52 +427,60 @@ Vol::aggWriteDone(int event, Event *e)
     eventProcessor.schedule_in(this, HRTIME_MSECONDS(cache_config_mutex_retry_delay));
     return EVENT_CONT;
   }
-  if (io.ok()) {
-    header->last_write_pos = header->write_pos;
-    header->write_pos += io.aiocb.aio_nbytes;
-    ink_assert(header->write_pos >= start);
-    DDebug("cache_agg", "Dir %s, Write: %" PRIu64 ", last Write: %" PRIu64 "", hash_text.get(), header->write_pos,
-           header->last_write_pos);
-    ink_assert(header->write_pos == header->agg_pos);
-    if (header->write_pos + EVACUATION_SIZE > scan_pos) {
-      periodic_scan();
-    }
-    agg_buf_pos = 0;
-    header->write_serial++;
-  } else {
-    // delete all the directory entries that we inserted
-    // for fragments is this aggregation buffer
-    Debug("cache_disk_error", "Write error on disk %s\n \
+  while (agg_writes_in_flight && agg_writes[agg_write_first].done) {
+    AggWriteBuffer *w = &agg_writes[agg_write_first];
+    AIOCallback *op   = &w->io;
+    off_t write_end   = op->aiocb.aio_offset + op->aiocb.aio_nbytes;
+    if (op->ok()) {
+      header->last_write_pos = op->aiocb.aio_offset;
+      ink_assert(header->last_write_pos >= start);
+      DDebug("cache_agg", "Dir %s, Write: %" PRIu64 ", last Write: %" PRIu64 "", hash_text.get(), write_end,
+             header->last_write_pos);
+      if (write_end + evacuation_size() > scan_pos) {
+        periodic_scan();
+      }
+    } else {
+      // delete all the directory entries that we inserted
+      // for fragments is this aggregation buffer
+      Debug("cache_disk_error", "Write error on disk %s\n \
               write range : [%" PRIu64 " - %" PRIu64 " bytes]  [%" PRIu64 " - %" PRIu64 " blocks] \n",
-          hash_text.get(), (uint64_t)io.aiocb.aio_offset, (uint64_t)io.aiocb.aio_offset + io.aiocb.aio_nbytes,
-          (uint64_t)io.aiocb.aio_offset / CACHE_BLOCK_SIZE,
-          (uint64_t)(io.aiocb.aio_offset + io.aiocb.aio_nbytes) / CACHE_BLOCK_SIZE);
-    Dir del_dir;
-    dir_clear(&del_dir);
-    for (int done = 0; done < agg_buf_pos;) {
-      Doc *doc = reinterpret_cast<Doc *>(agg_buffer + done);
-      dir_set_offset(&del_dir, header->write_pos + done);
-      dir_delete(&doc->key, this, &del_dir);
-      done += round_to_approx_size(doc->len);
+            hash_text.get(), (uint64_t)op->aiocb.aio_offset, (uint64_t)write_end, (uint64_t)op->aiocb.aio_offset / CACHE_BLOCK_SIZE,
+            (uint64_t)write_end / CACHE_BLOCK_SIZE);
+      Dir del_dir;
+      dir_clear(&del_dir);
+      for (size_t done = 0; done < op->aiocb.aio_nbytes;) {
+        Doc *doc = reinterpret_cast<Doc *>(w->buffer + done);
+        dir_set_offset(&del_dir, op->aiocb.aio_offset + done);
+        dir_delete(&doc->key, this, &del_dir);
+        done += round_to_approx_size(doc->len);
+      }
+      // write over the failed range again unless later data is already placed behind it
+      if (agg_writes_in_flight == 1 && !agg_buf_pos) {
+        header->write_pos = op->aiocb.aio_offset;
+        header->write_serial--;
+      }
     }
-    agg_buf_pos = 0;
+    w->done         = false;
+    agg_write_first = (agg_write_first + 1) % agg_buffers;
+    agg_writes_in_flight--;
   }
-  set_io_not_in_progress();
-  // callback ready sync CacheVCs
-  CacheVC *c = nullptr;
+  agg_buffer = agg_writes[(agg_write_first + agg_writes_in_flight) % agg_buffers].buffer;
+  // callback ready sync CacheVCs, header->write_serial already counts the writes in flight
+  uint32_t written_serial = header->write_serial - agg_writes_in_flight;
+  CacheVC *c              = nullptr;
   while ((c = sync.dequeue())) {
-    if (UINT_WRAP_LTE(c->write_serial + 2, header->write_serial)) {
+    if (UINT_WRAP_LTE(c->write_serial + 2, written_serial)) {
       eventProcessor.schedule_imm(c, ET_CALL, AIO_EVENT_DONE);
     } else {
       sync.push(c); // put it back on the front
       break;
     }
   }
-  if (dir_sync_waiting) {
+  if (dir_sync_waiting && !agg_writes_in_flight) {
     dir_sync_waiting = false;
     cacheDirSync->handleEvent(EVENT_IMMEDIATE, nullptr);
   }
-  if (agg.head || sync.head) {
+  if ((agg.head || sync.head) && !is_io_in_progress()) {
     return aggWrite(event, e);
   }
   return EVENT_CONT;
@@ -627,8 +695,8 @@ evacuate_fragments(CacheKey *key, CacheKey *earliest_key, int force, Vol *vol)
   return i;
 }
 
-int
-Vol::evacuateWrite(CacheVC *evacuator, int event, Event *e)
+void
+Vol::evacuateWrite(CacheVC *evacuator)
 {
   // push to front of aggregation write list, so it is written first
 
@@ -642,7 +710,6 @@ Vol::evacuateWrite(CacheVC *evacuator, int event, Event *e)
   }
   ink_assert(evacuator->agg_len <= AGG_SIZE);
   agg.insert(evacuator, after);
-  return aggWrite(event, e);
 }
 
 int
@@ -655,6 +722,24 @@ Vol::evacuateDocReadDone(int event, Event *e)
   ink_assert(is_io_in_progress());
   set_io_not_in_progress();
   ink_assert(mutex->thread_holding == this_ethread());
+  // hand every document of the read to its own evacuator, they are written in volume order
+  for (auto &d : evac_read_dirs) {
+    off_t o    = this->vol_offset(&d) - io.aiocb.aio_offset;
+    size_t n   = std::min(static_cast<size_t>(dir_approx_size(&d)), static_cast<size_t>(io.aiocb.aio_nbytes - o));
+    CacheVC *c = new_DocEvacuator(n, this);
+
+    c->overwrite_dir = d;
+    memcpy(c->buf->data(), evac_read_buf->data() + o, n);
+    evacuate_read_doc(c);
+  }
+  evac_read_dirs.clear();
+  evac_read_buf = nullptr;
+  return aggWrite(event, e);
+}
+
+void
+Vol::evacuate_read_doc(CacheVC *doc_evacuator)
+{
   Doc *doc = reinterpret_cast<Doc *>(doc_evacuator->buf->data());
   CacheKey next_key;
   EvacuationBlock *b = nullptr;
@@ -731,11 +816,10 @@ Vol::evacuateDocReadDone(int event, Event *e)
     next_CacheKey(&next_key, &doc->key);
     evacuate_fragments(&next_key, &doc_evacuator->earliest_key, !b->readers, this);
   }
-  return evacuateWrite(doc_evacuator, event, e);
+  evacuateWrite(doc_evacuator);
+  return;
 Ldone:
   free_CacheVC(doc_evacuator);
-  doc_evacuator = nullptr;
-  return aggWrite(event, e);
 }
 
 int
@@ -761,20 +845,47 @@ Vol::evac_range(off_t low, off_t high, int evac_phase)
       }
     }
     if (first) {
-      first->f.done       = 1;
+      // the read completes on the volume's handler, which the writes in flight still need
+      if (agg_writes_in_flight) {
+        return -1;
+      }
+      // pick up the documents that closely follow in the same read, as long as it is no larger than a write
+      std::vector<EvacuationBlock *> batch;
+      for (int j = i; j <= ei; j++) {
+        for (b = evacuate[j].head; b; b = b->link.next) {
+          int64_t offset = dir_offset(&b->dir);
+          if (offset >= first_offset && offset < e && !b->f.done && static_cast<int>(dir_phase(&b->dir)) == evac_phase) {
+            batch.push_back(b);
+          }
+        }
+      }
+      std::sort(batch.begin(), batch.end(),
+                [](EvacuationBlock *x, EvacuationBlock *y) { return dir_offset(&x->dir) < dir_offset(&y->dir); });
+      off_t read_start = this->vol_offset(&first->dir);
+      off_t read_end   = read_start;
+      for (auto eb : batch) {
+        off_t o   = this->vol_offset(&eb->dir);
+        off_t end = std::min(static_cast<off_t>(o + dir_approx_size(&eb->dir)), static_cast<off_t>(skip + len));
+        if (!evac_read_dirs.empty() && (o > read_end + EVACUATION_READ_GAP || std::max(end, read_end) - read_start > AGG_SIZE)) {
+          break;
+        }
+        eb->f.done = 1;
+        read_end   = std::max(end, read_end);
+        evac_read_dirs.push_back(eb->dir);
+      }
+      evac_read_buf       = new_IOBufferData(iobuffer_size_to_index(read_end - read_start, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
       io.aiocb.aio_fildes = fd;
-      io.aiocb.aio_nbytes = dir_approx_size(&first->dir);
-      io.aiocb.aio_offset = this->vol_offset(&first->dir);
-      if (static_cast<off_t>(io.aiocb.aio_offset + io.aiocb.aio_nbytes) > static_cast<off_t>(skip + len)) {
-        io.aiocb.aio_nbytes = skip + len - io.aiocb.aio_offset;
+      io.aiocb.aio_nbytes = read_end - read_start;
+      io.aiocb.aio_offset = read_start;
+      io.aiocb.aio_buf    = evac_read_buf->data();
+      io.action           = this;
+      io.thread           = AIO_CALLBACK_THREAD_ANY;
+      DDebug("cache_evac", "evac_range evacuating %X %d, %zu documents in %zu bytes", (int)dir_tag(&first->dir),
+             (int)dir_offset(&first->dir), evac_read_dirs.size(), static_cast<size_t>(io.aiocb.aio_nbytes));
+      {
+        Vol *vol = this;
+        CACHE_INCREMENT_DYN_STAT(cache_gc_evacuate_reads_stat);
       }
-      doc_evacuator                = new_DocEvacuator(io.aiocb.aio_nbytes, this);
-      doc_evacuator->overwrite_dir = first->dir;
-
-      io.aiocb.aio_buf = doc_evacuator->buf->data();
-      io.action        = this;
-      io.thread        = AIO_CALLBACK_THREAD_ANY;
-      DDebug("cache_evac", "evac_range evacuating %X %d", (int)dir_tag(&first->dir), (int)dir_offset(&first->dir));
       SET_HANDLER(&Vol::evacuateDocReadDone);
       ink_assert(ink_aio_read(&io) >= 0);
       return -1;
@@ -989,6 +1100,7 @@ Vol::periodic_scan()
 {
   evacuate_cleanup();
   scan_for_pinned_documents();
+  scan_for_hot_documents();
   if (header->write_pos == start) {
     scan_pos = start;
   }
@@ -998,6 +1110,7 @@ Vol::periodic_scan()
 void
 Vol::agg_wrap()
 {
+  write_clock += skip + len - header->write_pos;
   header->write_pos = start;
   header->phase     = !header->phase;
 
@@ -1036,7 +1149,7 @@ Lagain:
     int writelen = c->agg_len;
     // [amc] this is checked multiple places, on here was it strictly less.
     ink_assert(writelen <= AGG_SIZE);
-    if (agg_buf_pos + writelen > AGG_SIZE || header->write_pos + agg_buf_pos + writelen > (skip + len)) {
+    if (agg_buf_pos + writelen > agg_size || header->write_pos + agg_buf_pos + writelen > (skip + len)) {
       break;
     }
     DDebug("agg_read", "copying: %d, %" PRIu64 ", key: %d", agg_buf_pos, header->write_pos + agg_buf_pos, c->first_key.slice32(0));
@@ -1065,6 +1178,10 @@ Lagain:
     if (!agg.head && !sync.head) { // nothing to get
       return EVENT_CONT;
     }
+    // the writes in flight advance write_serial for the sync CacheVCs, and must land before we wrap
+    if (agg_writes_in_flight) {
+      goto Lwait;
+    }
     if (header->write_pos == start) {
       // write aggregation too long, bad bad, punt on everything.
       Note("write aggregation exceeds vol size");
@@ -1084,19 +1201,25 @@ Lagain:
   }
 
   // evacuate space
-  off_t end = header->write_pos + agg_buf_pos + EVACUATION_SIZE;
-  if (evac_range(header->write_pos, end, !header->phase) < 0) {
-    goto Lwait;
-  }
-  if (end > skip + len) {
-    if (evac_range(start, start + (end - (skip + len)), header->phase) < 0) {
+  {
+    off_t end = header->write_pos + agg_buf_pos + evacuation_size();
+    if (evac_range(header->write_pos, end, !header->phase) < 0) {
       goto Lwait;
     }
+    if (end > skip + len) {
+      if (evac_range(start, start + (end - (skip + len)), header->phase) < 0) {
+        goto Lwait;
+      }
+    }
   }
 
   // if agg.head, then we are near the end of the disk, so
   // write down the aggregation in whatever size it is.
-  if (agg_buf_pos < AGG_HIGH_WATER && !agg.head && !sync.head && !dir_sync_waiting) {
+  if (agg_buf_pos < agg_size / 2 && !agg.head && !sync.head && !dir_sync_waiting) {
+    goto Lwait;
+  }
+  // a directory sync waits for the writes in flight to drain, don't start more
+  if (dir_sync_waiting && agg_writes_in_flight) {
     goto Lwait;
   }
 
@@ -1116,19 +1239,36 @@ Lagain:
   // set write limit
   header->agg_pos = header->write_pos + agg_buf_pos;
 
-  io.aiocb.aio_fildes = fd;
-  io.aiocb.aio_offset = header->write_pos;
-  io.aiocb.aio_buf    = agg_buffer;
-  io.aiocb.aio_nbytes = agg_buf_pos;
-  io.action           = this;
-  /*
-    Callback on AIO thread so that we can issue a new write ASAP
-    as all writes are serialized in the volume.  This is not necessary
-    for reads proceed independently.
-   */
-  io.thread = AIO_CALLBACK_THREAD_AIO;
-  SET_HANDLER(&Vol::aggWriteDone);
-  ink_aio_write(&io);
+  {
+    AggWriteBuffer *w = &agg_writes[(agg_write_first + agg_writes_in_flight) % agg_buffers];
+    ink_assert(w->buffer == agg_buffer && !w->done);
+    w->io.aiocb.aio_fildes = fd;
+    w->io.aiocb.aio_offset = header->write_pos;
+    w->io.aiocb.aio_buf    = agg_buffer;
+    w->io.aiocb.aio_nbytes = agg_buf_pos;
+    w->io.action           = this;
+    /*
+      Callback on AIO thread so that we can issue a new write ASAP
+      as all writes are serialized in the volume.  This is not necessary
+      for reads proceed independently.
+     */
+    w->io.thread = AIO_CALLBACK_THREAD_AIO;
+
+    // the next buffer is filled behind this one while it is being written,
+    // which is why write_pos and write_serial advance before the write completes
+    write_clock += agg_buf_pos;
+    header->write_pos = header->agg_pos;
+    header->write_serial++;
+    agg_buf_pos = 0;
+    agg_writes_in_flight++;
+    agg_buffer = agg_writes[(agg_write_first + agg_writes_in_flight) % agg_buffers].buffer;
+    SET_HANDLER(&Vol::aggWriteDone);
+    ink_aio_write(&w->io);
+  }
+  // with a backlog, fill the next buffer right away instead of waiting for the next CacheVC
+  if (agg.head && !is_io_in_progress()) {
+    goto Lagain;
+  }
 
 Lwait:
   int ret = EVENT_CONT;
@@ -1220,6 +1360,8 @@ CacheVC::openWriteCloseHeadDone(int event, Event *e)
     }
     ink_assert(f.use_first_key);
     if (!od->dont_update_directory) {
+      // The new head is committed, the hot copy of the old one goes now.
+      cache_tier_invalidate(vol, &first_key);
       if (dir_is_empty(&od->first_dir)) {
         dir_insert(&first_key, vol, &dir);
       } else {
@@ -1609,6 +1751,11 @@ CacheVC::openWriteStartDone(int event, Event *e)
   Lcollision:
     int if_writers = ((uintptr_t)info == CACHE_ALLOW_MULTIPLE_WRITES);
     if (!od) {
+      // Cache::open_write missed the lock, so admission has not been checked yet
+      if (!f.update && !cache_admission_admit(vol, &first_key)) {
+        err = ECACHE_NOT_ADMITTED;
+        goto Lfailure;
+      }
       if ((err = vol->open_write(this, if_writers, cache_config_http_max_alts > 1 ? cache_config_http_max_alts : 0)) > 0) {
         goto Lfailure;
       }
@@ -1825,6 +1972,10 @@ Cache::open_write(Continuation *cont, const CacheKey *key, CacheHTTPInfo *info,
   {
     CACHE_TRY_LOCK(lock, c->vol->mutex, cont->mutex->thread_holding);
     if (lock.is_locked()) {
+      if (!c->f.update && !cache_admission_admit(c->vol, key)) {
+        err = ECACHE_NOT_ADMITTED;
+        goto Lfailure;
+      }
       if ((err = c->vol->open_write(c, if_writers, cache_config_http_max_alts > 1 ? cache_config_http_max_alts : 0)) > 0) {
         goto Lfailure;
       }
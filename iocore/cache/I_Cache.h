@@ -31,6 +31,8 @@
 
 static constexpr ts::ModuleVersion CACHE_MODULE_VERSION(1, 0);
 
+class NetVConnection;
+
 #define CACHE_WRITE_OPT_OVERWRITE 0x0001
 #define CACHE_WRITE_OPT_CLOSE_COMPLETE 0x0002
 #define CACHE_WRITE_OPT_SYNC (CACHE_WRITE_OPT_CLOSE_COMPLETE | 0x0004)
@@ -45,8 +47,20 @@ static constexpr ts::ModuleVersion CACHE_MODULE_VERSION(1, 0);
 #define CACHE_COMPRESSION_FASTLZ 1
 #define CACHE_COMPRESSION_LIBZ 2
 #define CACHE_COMPRESSION_LIBLZMA 3
-
-enum { RAM_HIT_COMPRESS_NONE = 1, RAM_HIT_COMPRESS_FASTLZ, RAM_HIT_COMPRESS_LIBZ, RAM_HIT_COMPRESS_LIBLZMA, RAM_HIT_LAST_ENTRY };
+#define CACHE_COMPRESSION_ZSTD 4
+#define CACHE_COMPRESSION_LZ4 5
+#define CACHE_COMPRESSION_AUTO 6 // choose one of the above per entry, never stored in an entry
+#define CACHE_COMPRESSION_CODECS CACHE_COMPRESSION_AUTO
+
+enum {
+  RAM_HIT_COMPRESS_NONE = 1,
+  RAM_HIT_COMPRESS_FASTLZ,
+  RAM_HIT_COMPRESS_LIBZ,
+  RAM_HIT_COMPRESS_LIBLZMA,
+  RAM_HIT_COMPRESS_ZSTD,
+  RAM_HIT_COMPRESS_LZ4,
+  RAM_HIT_LAST_ENTRY
+};
 
 struct CacheVC;
 struct CacheDisk;
@@ -214,6 +228,22 @@ struct CacheVConnection : public VConnection {
   */
   virtual bool is_pread_capable() = 0;
 
+  /** Send the body of a read to @a vc straight from the cache disk where possible.
+
+      Call it right after @c do_io_read, with @a vc being the VC that writes
+      the read buffer. Fragments are then given to NetVConnection::sendfile_from()
+      of @a vc instead of being read into the buffer, the read VIO still
+      counts their bytes.
+
+      @return @c false if the object or @a vc is not eligible, the body is read as usual.
+  */
+  virtual bool
+  sendfile_to(NetVConnection *vc)
+  {
+    (void)vc;
+    return false;
+  }
+
   CacheVConnection();
 };
 
@@ -0,0 +1,74 @@
+/** @file
+
+  TinyLFU style admission filter for cache writes
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include "I_Cache.h"
+
+#define CACHE_ADMISSION_DEPTH 4          // rows of the count-min sketch
+#define CACHE_ADMISSION_MAX_COUNT 15     // counters are 4 bits wide
+#define CACHE_ADMISSION_SAMPLE_FACTOR 10 // counters are halved after this many times width increments
+
+/**
+  Count-min sketch estimating how often each key was looked up recently.
+
+  Increments are conservative (only the smallest counters of a key are
+  raised) and every CACHE_ADMISSION_SAMPLE_FACTOR * width increments all
+  counters are halved, so the estimates follow the current popularity of
+  the keys rather than their all time totals.
+
+  Not thread safe, callers hold the volume lock.
+*/
+class CacheAdmissionSketch
+{
+public:
+  explicit CacheAdmissionSketch(int64_t width);
+  ~CacheAdmissionSketch();
+
+  void increment(const CryptoHash *key);
+  int estimate(const CryptoHash *key) const;
+
+  int64_t
+  width() const
+  {
+    return static_cast<int64_t>(_mask) + 1;
+  }
+
+private:
+  uint8_t *_table; // CACHE_ADMISSION_DEPTH rows of width 4 bit counters, two per byte
+  uint64_t _mask;
+  int64_t _samples = 0;
+
+  void _index(const CryptoHash *key, uint64_t idx[CACHE_ADMISSION_DEPTH]) const;
+  int _get(uint64_t i) const;
+  void _age();
+};
+
+struct Vol;
+
+// Counts a lookup of key against the admission filter of vol, if it has one.
+void cache_admission_record(Vol *vol, const CryptoHash *key);
+// Whether a new object for key may be written to vol.
+bool cache_admission_admit(Vol *vol, const CryptoHash *key);
+// Whether key was looked up often enough to be hit evacuated, see proxy.config.cache.hit_evacuate_min_hits.
+bool cache_admission_hot(Vol *vol, const CryptoHash *key);
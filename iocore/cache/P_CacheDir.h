@@ -23,10 +23,11 @@
 
 #pragma once
 
+#include <vector>
+
 #include "P_CacheHttp.h"
 
 struct Vol;
-struct InterimCacheVol;
 struct CacheVC;
 
 /*
@@ -52,6 +53,10 @@ struct CacheVC;
 #define DIR_OFFSET_BITS 40
 #define DIR_OFFSET_MAX ((((off_t)1) << DIR_OFFSET_BITS) - 1)
 
+// Vol::tag_index slot flags, the low DIR_TAG_WIDTH bits hold the tag
+#define DIR_TAG_INDEX_USED (1 << 15)     // entry holds a document
+#define DIR_TAG_INDEX_OVERFLOW (1 << 14) // bucket head only: chain may have entries outside the row
+
 #define SYNC_MAX_WRITE (2 * 1024 * 1024)
 #define SYNC_DELAY HRTIME_MSECONDS(500)
 #define DO_NOT_REMOVE_THIS 0
@@ -265,8 +270,18 @@ struct CacheSync : public Continuation {
   AIOCallbackInternal io;
   Event *trigger        = nullptr;
   ink_hrtime start_time = 0;
+  // incremental sync: segments snapshotted into buf for the copy being written
+  bool incremental = false;
+  bool io_error    = false;
+  std::vector<bool> segments;
+  int segment_idx = 0;
+  // totals for the current pass over all volumes
+  int64_t cycle_bytes    = 0;
+  ink_hrtime cycle_start = 0;
   int mainEvent(int event, Event *e);
   void aio_write(int fd, char *b, int n, off_t o);
+  void snapshot_dirty_segments(Vol *vol);
+  int next_segment_range(Vol *vol, off_t &pos, int &len);
 
   CacheSync() : Continuation(new_ProxyMutex()) { SET_HANDLER(&CacheSync::mainEvent); }
 };
@@ -274,6 +289,7 @@ struct CacheSync : public Continuation {
 // Global Functions
 
 void vol_init_dir(Vol *d);
+void dir_tag_index_build(Vol *d);
 int dir_probe(const CacheKey *, Vol *, Dir *, Dir **);
 int dir_insert(const CacheKey *key, Vol *d, Dir *to_part);
 int dir_overwrite(const CacheKey *key, Vol *d, Dir *to_part, Dir *overwrite, bool must_overwrite = true);
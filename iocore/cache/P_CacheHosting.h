@@ -297,6 +297,8 @@ struct ConfigVol {
   off_t size;
   bool in_percent;
   bool ramcache_enabled;
+  int admission_min_hits;
+  int hot_volume;
   int percent;
   CacheVol *cachep;
   LINK(ConfigVol, link);
@@ -106,6 +106,42 @@ enum {
   cache_direntries_used_stat,
   cache_ram_cache_hits_stat,
   cache_ram_cache_misses_stat,
+  cache_ram_cache_front_hits_stat,
+  cache_admission_admitted_stat,
+  cache_admission_rejected_stat,
+  cache_tier_hot_hits_stat,
+  cache_tier_cold_hits_stat,
+  cache_tier_promote_active_stat,
+  cache_tier_promote_success_stat,
+  cache_tier_promote_failure_stat,
+  cache_init_stripes_total_stat,
+  cache_init_stripes_active_stat,
+  cache_init_stripes_ready_stat,
+  cache_ram_cache_compress_fastlz_bytes_in_stat,
+  cache_ram_cache_compress_fastlz_bytes_out_stat,
+  cache_ram_cache_compress_fastlz_time_stat,
+  cache_ram_cache_compress_fastlz_decompress_time_stat,
+  cache_ram_cache_compress_libz_bytes_in_stat,
+  cache_ram_cache_compress_libz_bytes_out_stat,
+  cache_ram_cache_compress_libz_time_stat,
+  cache_ram_cache_compress_libz_decompress_time_stat,
+  cache_ram_cache_compress_liblzma_bytes_in_stat,
+  cache_ram_cache_compress_liblzma_bytes_out_stat,
+  cache_ram_cache_compress_liblzma_time_stat,
+  cache_ram_cache_compress_liblzma_decompress_time_stat,
+  cache_ram_cache_compress_zstd_bytes_in_stat,
+  cache_ram_cache_compress_zstd_bytes_out_stat,
+  cache_ram_cache_compress_zstd_time_stat,
+  cache_ram_cache_compress_zstd_decompress_time_stat,
+  cache_ram_cache_compress_lz4_bytes_in_stat,
+  cache_ram_cache_compress_lz4_bytes_out_stat,
+  cache_ram_cache_compress_lz4_time_stat,
+  cache_ram_cache_compress_lz4_decompress_time_stat,
+  cache_ram_cache_warm_objects_stat,
+  cache_ram_cache_warm_time_stat,
+  cache_startup_time_stat,
+  cache_startup_dir_read_time_stat,
+  cache_startup_recovery_time_stat,
   cache_pread_count_stat,
   cache_percent_full_stat,
   cache_lookup_active_stat,
@@ -140,6 +176,7 @@ enum {
   cache_read_busy_failure_stat,
   cache_gc_bytes_evacuated_stat,
   cache_gc_frags_evacuated_stat,
+  cache_gc_evacuate_reads_stat,
   cache_write_bytes_stat,
   cache_hdr_vector_marshal_stat,
   cache_hdr_marshal_stat,
@@ -148,6 +185,9 @@ enum {
   cache_directory_sync_count_stat,
   cache_directory_sync_time_stat,
   cache_directory_sync_bytes_stat,
+  cache_directory_sync_segments_stat,
+  cache_directory_sync_cycle_bytes_stat,
+  cache_directory_sync_cycle_time_stat,
   /* AIO read/write error counters */
   cache_span_errors_read_stat,
   cache_span_errors_write_stat,
@@ -209,6 +249,11 @@ extern RecRawStatBlock *cache_rsb;
 
 // Configuration
 extern int cache_config_dir_sync_frequency;
+extern int cache_config_dir_sync_incremental;
+extern int cache_config_dir_tag_index;
+extern int cache_config_admission_min_hits;
+extern int cache_config_init_disk_concurrency;
+extern int cache_config_init_early_open;
 extern int cache_config_http_max_alts;
 extern int cache_config_log_alternate_eviction;
 extern int cache_config_permit_pinning;
@@ -216,15 +261,28 @@ extern int cache_config_select_alternate;
 extern int cache_config_max_doc_size;
 extern int cache_config_min_average_object_size;
 extern int cache_config_agg_write_backlog;
+extern int cache_config_agg_write_buffer_size;
+extern int cache_config_agg_write_buffers;
 extern int cache_config_enable_checksum;
+extern int cache_config_sendfile;
+extern int64_t cache_config_sendfile_min_size;
 extern int cache_config_alt_rewrite_max_size;
 extern int cache_config_read_while_writer;
 extern int cache_config_agg_write_backlog;
 extern int cache_config_ram_cache_compress;
 extern int cache_config_ram_cache_compress_percent;
+extern int cache_config_ram_cache_zstd_dict_size;
+extern int cache_config_ram_cache_shards;
+extern int cache_config_ram_cache_front_objects;
+extern int64_t cache_config_ram_cache_front_max_size;
 extern int cache_config_ram_cache_use_seen_filter;
+extern int cache_config_ram_cache_checkpoint;
+extern int cache_config_ram_cache_checkpoint_objects;
 extern int cache_config_hit_evacuate_percent;
 extern int cache_config_hit_evacuate_size_limit;
+extern int cache_config_hit_evacuate_min_hits;
+extern int cache_config_hit_evacuate_ram_objects;
+extern int cache_config_tier_promote_min_hits;
 extern int cache_config_force_sector_size;
 extern int cache_config_target_fragment_size;
 extern int cache_config_mutex_retry_delay;
@@ -323,6 +381,7 @@ struct CacheVC : public CacheVConnection {
   int handleReadDone(int event, Event *e);
   int handleRead(int event, Event *e);
   int do_read_call(CacheKey *akey);
+  bool ram_cache_read_unlocked(CacheKey *akey);
   int handleWrite(int event, Event *e);
   int handleWriteLock(int event, Event *e);
   int do_write_call();
@@ -383,6 +442,7 @@ struct CacheVC : public CacheVConnection {
   }
   int evacuateDocDone(int event, Event *e);
   int evacuateReadHead(int event, Event *e);
+  int tierPromoteDone(int event, Event *e);
 
   void cancel_trigger();
   int64_t get_object_size() override;
@@ -398,6 +458,7 @@ struct CacheVC : public CacheVConnection {
    */
   virtual uint32_t load_http_info(CacheHTTPInfoVector *info, struct Doc *doc, RefCountObj *block_ptr = nullptr);
   bool is_pread_capable() override;
+  bool sendfile_to(NetVConnection *vc) override;
   bool set_pin_in_cache(time_t time_pin) override;
   time_t get_pin_in_cache() override;
 
@@ -460,6 +521,7 @@ struct CacheVC : public CacheVConnection {
   uint32_t agg_len;      // for communicating with aggWrite
   uint32_t write_serial; // serial of the final write for SYNC
   Vol *vol;
+  Vol *tier_vol; // cold stripe of a hot tier promotion, or of a hot tier read still to be counted
   Dir *last_collision;
   Event *trigger;
   CacheKey *read_key;
@@ -481,6 +543,8 @@ struct CacheVC : public CacheVConnection {
   int fragment;
   int scan_msec_delay;
   CacheVC *write_vc;
+  NetVConnection *sendfile_vc;  // client VC the fragments are sent to from the disk, see sendfile_to()
+  int64_t sendfile_write_limit; // Vol::write_clock at which sending the current fragment stops
   char *hostname;
   int host_len;
   int header_to_write_len;
@@ -510,6 +574,9 @@ struct CacheVC : public CacheVConnection {
       unsigned int hit_evacuate : 1;
       unsigned int compressed_in_ram : 1; // compressed state in ram cache
       unsigned int allow_empty_doc : 1;   // used for cache empty http document
+      unsigned int doc_header_only : 1;   // only the Doc header of the fragment was read, see sendfile_to()
+      unsigned int ram_cache_missed : 1;  // read_key was not in the RAM cache before the volume lock was taken
+      unsigned int admission_pending : 1; // the open_read is still to be counted by the admission filter
     } f;
   };
   // BTF optimization used to skip reading stuff in cache partition that doesn't contain any
@@ -548,6 +615,9 @@ extern CacheSync *cacheDirSync;
 int cache_write(CacheVC *, CacheHTTPInfoVector *);
 int get_alternate_index(CacheHTTPInfoVector *cache_vector, CacheKey key);
 CacheVC *new_DocEvacuator(int nbytes, Vol *d);
+void unmarshal_helper(Doc *doc, Ptr<IOBufferData> &buf, int &okay);
+void ram_cache_checkpoint_save();
+void ram_cache_checkpoint_load();
 
 // inline Functions
 
@@ -1009,7 +1079,7 @@ struct Cache {
   static void generate_key(CryptoHash *hash, CacheURL *url);
   static void generate_key(HttpCacheKey *hash, CacheURL *url, cache_generation_t generation = -1);
 
-  void vol_initialized(bool result);
+  void vol_initialized(Vol *vol, bool result);
 
   int open_done();
 
@@ -0,0 +1,45 @@
+/** @file
+
+  Two tier volumes, popular objects of a cold volume are copied to a hot volume
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include "I_Cache.h"
+
+#define CACHE_TIER_MAX_PENDING 64 // promotions queued on a hot stripe at once
+
+struct Vol;
+struct Doc;
+
+// Resolves the hot_volume of every volume in volume.config, called once the volumes are created.
+void cplist_link_tiers();
+
+// The stripe of the hot tier of vol that key maps to, nullptr if vol has no usable hot tier.
+Vol *cache_tier_hot_vol(Vol *vol, const CryptoHash *key);
+// The stripe a read of key should go to, the hot tier stripe if it holds the object and vol otherwise.
+Vol *cache_tier_select(Vol *vol, const CryptoHash *key);
+// Counts a read served by the hot tier in the admission sketch of cold, false if cold is locked.
+bool cache_tier_record(Vol *cold, const CryptoHash *key);
+// Counts a head document read by vc and copies it to the hot tier if it is popular on the cold tier.
+void cache_tier_read_head(CacheVC *vc, Doc *doc);
+// Drops the hot tier copy of key, later from a continuation if the hot stripe is locked.
+void cache_tier_invalidate(Vol *vol, const CryptoHash *key);
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <atomic>
+#include <vector>
 
 #define CACHE_BLOCK_SHIFT 9
 #define CACHE_BLOCK_SIZE (1 << CACHE_BLOCK_SHIFT) // 512, smallest sector size
@@ -36,8 +37,9 @@
 #define VOL_MAGIC 0xF1D0F00D
 #define START_BLOCKS 16 // 8k, STORE_BLOCK_SIZE
 #define START_POS ((off_t)START_BLOCKS * CACHE_BLOCK_SIZE)
-#define AGG_SIZE (4 * 1024 * 1024)     // 4MB
-#define AGG_HIGH_WATER (AGG_SIZE / 2)  // 2MB
+#define AGG_SIZE (4 * 1024 * 1024)      // 4MB, largest single write and smallest aggregation buffer
+#define MAX_AGG_SIZE (64 * 1024 * 1024) // 64MB
+#define MAX_AGG_BUFFERS 4
 #define EVACUATION_SIZE (2 * AGG_SIZE) // 8MB
 #define MAX_VOL_SIZE ((off_t)512 * 1024 * 1024 * 1024 * 1024)
 #define STORE_BLOCKS_PER_CACHE_BLOCK (STORE_BLOCK_SIZE / CACHE_BLOCK_SIZE)
@@ -51,6 +53,7 @@
 #define LOOKASIDE_SIZE 256
 #define EVACUATION_BUCKET_SIZE (2 * EVACUATION_SIZE) // 16MB
 #define RECOVERY_SIZE EVACUATION_SIZE                // 8MB
+#define EVACUATION_READ_GAP (256 * 1024)             // largest hole read over to batch evacuation reads
 #define AIO_NOT_IN_PROGRESS -1
 #define AIO_AGG_WRITE_IN_PROGRESS -2
 #define AUTO_SIZE_RAM_CACHE -1                               // 1-1 with directory size
@@ -119,6 +122,13 @@ struct EvacuationBlock {
   LINK(EvacuationBlock, link);
 };
 
+// An aggregation buffer and the write flushing it to disk, see proxy.config.cache.agg_write.buffers.
+struct AggWriteBuffer {
+  char *buffer = nullptr;
+  AIOCallbackInternal io;
+  bool done = false;
+};
+
 struct Vol : public Continuation {
   char *path = nullptr;
   ats_scoped_str hash_text;
@@ -144,10 +154,22 @@ struct Vol : public Continuation {
   Queue<CacheVC, Continuation::Link_link> agg;
   Queue<CacheVC, Continuation::Link_link> stat_cache_vcs;
   Queue<CacheVC, Continuation::Link_link> sync;
-  char *agg_buffer  = nullptr;
+  char *agg_buffer  = nullptr; // the buffer being filled, agg_buf_pos bytes to be written at header->write_pos
   int agg_todo_size = 0;
   int agg_buf_pos   = 0;
 
+  // Aggregation buffers, the agg_writes_in_flight starting at agg_write_first are being written in volume order.
+  AggWriteBuffer agg_writes[MAX_AGG_BUFFERS];
+  int agg_buffers          = 1;
+  int agg_size             = AGG_SIZE;
+  int agg_write_first      = 0;
+  int agg_writes_in_flight = 0;
+
+  // Bytes the write cursor has moved over since startup, including the end skipped at a wrap. It
+  // only grows, before the write of those bytes is started, and is read without the lock by
+  // sendfile() to stop sending a fragment the writer is about to overwrite.
+  std::atomic<int64_t> write_clock{0};
+
   Event *trigger = nullptr;
 
   OpenDir open_dir;
@@ -155,7 +177,9 @@ struct Vol : public Continuation {
   int evacuate_size              = 0;
   DLL<EvacuationBlock> *evacuate = nullptr;
   DLL<EvacuationBlock> lookaside[LOOKASIDE_SIZE];
-  CacheVC *doc_evacuator = nullptr;
+  // Evacuation read in progress, the documents of evac_read_dirs read in one piece into evac_read_buf.
+  Ptr<IOBufferData> evac_read_buf;
+  std::vector<Dir> evac_read_dirs;
 
   VolInitInfo *init_info = nullptr;
 
@@ -170,6 +194,28 @@ struct Vol : public Continuation {
   bool dir_sync_in_progress  = false;
   bool writing_end_marker    = false;
 
+  // Segments changed since the last sync of each on-disk directory copy (A and B).
+  std::vector<bool> dir_segment_dirty[2];
+
+  // Tags of all directory entries in directory order, see proxy.config.cache.dir.tag_index.
+  uint16_t *tag_index = nullptr;
+
+  // Lookup frequencies for the admission filter, see proxy.config.cache.admission.min_hits.
+  CacheAdmissionSketch *admission = nullptr;
+
+  // Keys being copied into this stripe from a cold tier, see cache_tier_read_head().
+  std::vector<CryptoHash> tier_promotions;
+
+  // Thread the initialization callbacks of this stripe run on, see VolInit.
+  EThread *init_thread = AIO_CALLBACK_THREAD_ANY;
+  // Set once the stripe is in gvol and may be used by the cache.
+  bool initialized = false;
+
+  // Startup timings: when init began, time to read the directory and time to recover it.
+  ink_hrtime init_start_time = 0;
+  ink_hrtime dir_read_time   = 0;
+  ink_hrtime recover_time    = 0;
+
   CacheKey first_fragment_key;
   int64_t first_fragment_offset = 0;
   Ptr<IOBufferData> first_fragment_data;
@@ -214,18 +260,24 @@ struct Vol : public Continuation {
   int aggWrite(int event, void *e);
   void agg_wrap();
 
-  int evacuateWrite(CacheVC *evacuator, int event, Event *e);
+  void evacuateWrite(CacheVC *evacuator);
+  void evacuate_read_doc(CacheVC *evacuator);
   int evacuateDocReadDone(int event, Event *e);
   int evacuateDoc(int event, Event *e);
 
   int evac_range(off_t start, off_t end, int evac_phase);
   void periodic_scan();
   void scan_for_pinned_documents();
+  void scan_for_hot_documents();
   void evacuate_cleanup_blocks(int i);
   void evacuate_cleanup();
   EvacuationBlock *force_evacuate_head(Dir *dir, int pinned);
   int within_hit_evacuate_window(Dir *dir) const;
   uint32_t round_to_approx_size(uint32_t l) const;
+  off_t evacuation_size() const; // bytes cleared ahead of the aggregation buffer, covers every write that may be in flight
+
+  void dir_segment_mark_dirty(int s); // records a change to segment s for both directory copies
+  void dir_mark_all_dirty();          // forces the next sync of both copies to write every segment
 
   // inline functions
   int headerlen() const;         // calculates the total length of the vol header and the freelist
@@ -238,6 +290,10 @@ struct Vol : public Continuation {
   int vol_out_of_phase_write_valid(Dir *e) const;
   int vol_in_phase_valid(Dir *e) const;
   int vol_in_phase_agg_buf_valid(Dir *e) const;
+  int vol_sendfile_valid(Dir *e) const;     // on disk and far enough from the write cursor to be read from the disk later
+  int64_t vol_sendfile_limit(Dir *e) const; // write_clock at which the data of e may no longer be sent, see write_clock
+  off_t agg_buf_start() const;         // volume offset of the oldest data still in an aggregation buffer
+  char *agg_buf_data(off_t pos) const; // memory holding volume offset pos, which must be in the aggregation buffers
 
   off_t vol_offset(Dir *e) const;
   off_t offset_to_vol_offset(off_t pos) const;
@@ -247,12 +303,17 @@ struct Vol : public Continuation {
   Vol() : Continuation(new_ProxyMutex())
   {
     open_dir.mutex = mutex;
-    agg_buffer     = (char *)ats_memalign(ats_pagesize(), AGG_SIZE);
-    memset(agg_buffer, 0, AGG_SIZE);
     SET_HANDLER(&Vol::aggWrite);
   }
 
-  ~Vol() override { ats_free(agg_buffer); }
+  ~Vol() override
+  {
+    for (auto &w : agg_writes) {
+      ats_free(w.buffer);
+    }
+    ats_free(tag_index);
+    delete admission;
+  }
 };
 
 struct AIO_Callback_handler : public Continuation {
@@ -262,13 +323,16 @@ struct AIO_Callback_handler : public Continuation {
 };
 
 struct CacheVol {
-  int vol_number        = -1;
-  int scheme            = 0;
-  off_t size            = 0;
-  int num_vols          = 0;
-  bool ramcache_enabled = true;
-  Vol **vols            = nullptr;
-  DiskVol **disk_vols   = nullptr;
+  int vol_number         = -1;
+  int scheme             = 0;
+  off_t size             = 0;
+  int num_vols           = 0;
+  bool ramcache_enabled  = true;
+  int admission_min_hits = -1; // -1 for proxy.config.cache.admission.min_hits
+  CacheVol *hot_tier     = nullptr; // hot_volume of volume.config, see cplist_link_tiers()
+  bool is_hot_tier       = false;   // only holds promoted copies, never assigned to a host
+  Vol **vols             = nullptr;
+  DiskVol **disk_vols    = nullptr;
   LINK(CacheVol, link);
   // per volume stats
   RecRawStatBlock *vol_rsb = nullptr;
@@ -340,6 +404,20 @@ Vol::dirlen() const
          ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter));
 }
 
+TS_INLINE void
+Vol::dir_segment_mark_dirty(int s)
+{
+  this->dir_segment_dirty[0][s] = true;
+  this->dir_segment_dirty[1][s] = true;
+}
+
+TS_INLINE void
+Vol::dir_mark_all_dirty()
+{
+  this->dir_segment_dirty[0].assign(this->segments, true);
+  this->dir_segment_dirty[1].assign(this->segments, true);
+}
+
 TS_INLINE int
 Vol::direntries() const
 {
@@ -355,7 +433,7 @@ Vol::vol_out_of_phase_valid(Dir *e) const
 TS_INLINE int
 Vol::vol_out_of_phase_agg_valid(Dir *e) const
 {
-  return (dir_offset(e) - 1 >= ((this->header->agg_pos - this->start + AGG_SIZE) / CACHE_BLOCK_SIZE));
+  return (dir_offset(e) - 1 >= ((this->header->agg_pos - this->start + this->agg_size) / CACHE_BLOCK_SIZE));
 }
 
 TS_INLINE int
@@ -391,7 +469,56 @@ Vol::vol_offset_to_offset(off_t pos) const
 TS_INLINE int
 Vol::vol_in_phase_agg_buf_valid(Dir *e) const
 {
-  return (this->vol_offset(e) >= this->header->write_pos && this->vol_offset(e) < (this->header->write_pos + this->agg_buf_pos));
+  return (this->vol_offset(e) >= this->agg_buf_start() && this->vol_offset(e) < (this->header->write_pos + this->agg_buf_pos));
+}
+
+// A fragment sent with sendfile() is read when the socket takes it, which may be long after its
+// header was checked. Keep at least an eighth of the stripe between it and the write cursor.
+TS_INLINE int
+Vol::vol_sendfile_valid(Dir *e) const
+{
+  if (this->header->phase == dir_phase(e) && this->vol_in_phase_agg_buf_valid(e)) {
+    return 0;
+  }
+  off_t ahead = this->vol_offset(e) - this->header->write_pos;
+  if (ahead < 0) {
+    ahead += this->vol_relative_length(this->start);
+  }
+  return ahead >= this->vol_relative_length(this->start) / 8;
+}
+
+// The socket stops sending a fragment once the write cursor is within a sixteenth of the stripe
+// of it, the kernel may still read pages sent before that.
+TS_INLINE int64_t
+Vol::vol_sendfile_limit(Dir *e) const
+{
+  off_t ahead = this->vol_offset(e) - this->header->write_pos;
+  if (ahead < 0) {
+    ahead += this->vol_relative_length(this->start);
+  }
+  return this->write_clock + ahead - this->vol_relative_length(this->start) / 16;
+}
+
+TS_INLINE off_t
+Vol::agg_buf_start() const
+{
+  if (this->agg_writes_in_flight) {
+    return this->agg_writes[this->agg_write_first].io.aiocb.aio_offset;
+  }
+  return this->header->write_pos;
+}
+
+// The buffers in flight are contiguous and end at header->write_pos, where the buffer being filled starts.
+TS_INLINE char *
+Vol::agg_buf_data(off_t pos) const
+{
+  for (int i = 0; i < this->agg_writes_in_flight; i++) {
+    const AIOCallback *op = &this->agg_writes[(this->agg_write_first + i) % this->agg_buffers].io;
+    if (pos < static_cast<off_t>(op->aiocb.aio_offset + op->aiocb.aio_nbytes)) {
+      return static_cast<char *>(op->aiocb.aio_buf) + (pos - op->aiocb.aio_offset);
+    }
+  }
+  return this->agg_buffer + (pos - this->header->write_pos);
 }
 
 // length of the partition not including the offset of location 0.
@@ -491,7 +618,7 @@ TS_INLINE int
 Vol::within_hit_evacuate_window(Dir *xdir) const
 {
   off_t oft       = dir_offset(xdir) - 1;
-  off_t write_off = (header->write_pos + AGG_SIZE - start) / CACHE_BLOCK_SIZE;
+  off_t write_off = (header->write_pos + agg_size - start) / CACHE_BLOCK_SIZE;
   off_t delta     = oft - write_off;
   if (delta >= 0)
     return delta < hit_evacuate_window;
@@ -506,16 +633,24 @@ Vol::round_to_approx_size(uint32_t l) const
   return ROUND_TO_SECTOR(this, ll);
 }
 
+// The default single buffer of AGG_SIZE gives EVACUATION_SIZE.
+TS_INLINE off_t
+Vol::evacuation_size() const
+{
+  return static_cast<off_t>(agg_buffers + 1) * agg_size;
+}
+
 inline bool
 Vol::evac_bucket_valid(off_t bucket) const
 {
   return (bucket >= 0 && bucket < evacuate_size);
 }
 
+// An evacuation read is pending or every aggregation buffer is being written, nothing can be aggregated until it completes.
 inline int
 Vol::is_io_in_progress() const
 {
-  return io.aiocb.aio_fildes != AIO_NOT_IN_PROGRESS;
+  return io.aiocb.aio_fildes != AIO_NOT_IN_PROGRESS || agg_writes_in_flight >= agg_buffers;
 }
 
 inline void
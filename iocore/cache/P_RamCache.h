@@ -25,6 +25,17 @@
 
 #include "I_Cache.h"
 
+#include <vector>
+
+// Identity of a RAM cache entry, enough to find the object again in the directory
+struct RamCacheKey {
+  CryptoHash key;
+  uint64_t auxkey;
+};
+
+// Matches the entry of a key whatever its auxkey, for keys never reused (content fragments)
+static constexpr uint64_t RAM_CACHE_ANY_AUXKEY = UINT64_MAX;
+
 // Generic Ram Cache interface
 
 class RamCache
@@ -36,9 +47,23 @@ public:
   virtual int fixup(const CryptoHash *key, uint64_t old_auxkey, uint64_t new_auxkey)                         = 0;
   virtual int64_t size() const                                                                               = 0;
 
+  // append up to max keys of resident entries to keys, most recently used first
+  virtual void hot_keys(std::vector<RamCacheKey> &keys, size_t max) const = 0;
+
+  // true if get, put and fixup may be called without holding the volume lock
+  virtual bool
+  has_own_locks() const
+  {
+    return false;
+  }
+
   virtual void init(int64_t max_bytes, Vol *vol) = 0;
   virtual ~RamCache(){};
+
+  // held by work done on the cache in the background, the volume lock if left unset before init
+  Ptr<ProxyMutex> mutex;
 };
 
 RamCache *new_RamCacheLRU();
 RamCache *new_RamCacheCLFUS();
+RamCache *new_RamCacheSharded(RamCache *(*new_shard)(), int nshards);
@@ -33,12 +33,29 @@
 #ifdef HAVE_LZMA_H
 #include <lzma.h>
 #endif
+#ifdef HAVE_ZSTD_H
+#include <zstd.h>
+#include <zdict.h>
+#endif
+#ifdef HAVE_LZ4_H
+#include <lz4.h>
+#endif
 
 #define REQUIRED_COMPRESSION 0.9 // must get to this size or declared incompressible
 #define REQUIRED_SHRINK 0.8      // must get to this size or keep original buffer (with padding)
 #define HISTORY_HYSTERIA 10      // extra temporary history
 #define ENTRY_OVERHEAD 256       // per-entry overhead to consider when computing cache value/size
 #define LZMA_BASE_MEMLIMIT (64 * 1024 * 1024)
+#define ZSTD_LEVEL 3                          // zstd compression level
+#define ZSTD_DICTS 4                          // dictionaries kept while entries still use them
+#define ZSTD_DICT_RETRAIN HRTIME_SECONDS(300) // how often the dictionary is retrained
+#define ZSTD_DICT_SAMPLE_SIZE 16384           // bytes taken from each entry to train the dictionary
+#define ZSTD_DICT_SAMPLE_RATIO 100            // bytes of samples per byte of dictionary
+#define ZSTD_DICT_MIN_SAMPLES 64              // not enough to train a useful dictionary below this
+#define AUTO_MIN_SAMPLES 8                    // measure every codec this many times before choosing
+#define AUTO_EXPLORE 64                       // re-measure a codec every this many entries
+#define AUTO_AVERAGE_OVER 16                  // decay of the per codec ratio and speed estimates
+#define AUTO_CPU_FACTOR 4                     // never pick a codec this much slower than the fastest
 //#define CHECK_ACOUNTING 1 // very expensive double checking of all sizes
 
 #define REQUEUE_HITS(_h) ((_h) ? ((_h)-1) : 0)
@@ -48,6 +65,24 @@
 #define AVERAGE_VALUE_OVER 100
 #define REQUEUE_LIMIT 100
 
+enum { CONTENT_TEXT, CONTENT_BINARY, CONTENT_COMPRESSED, CONTENT_KINDS };
+
+#ifdef HAVE_ZSTD_H
+// A zstd dictionary trained on the RAM cache contents, kept until no entry compressed with it is left.
+struct RamCacheZstdDict {
+  unsigned id       = 0;
+  int64_t entries   = 0; // entries compressed with this dictionary
+  ZSTD_CDict *cdict = nullptr;
+  ZSTD_DDict *ddict = nullptr;
+
+  ~RamCacheZstdDict()
+  {
+    ZSTD_freeCDict(cdict);
+    ZSTD_freeDDict(ddict);
+  }
+};
+#endif
+
 struct RamCacheCLFUSEntry {
   CryptoHash key;
   uint64_t auxkey;
@@ -79,6 +114,7 @@ public:
   int put(CryptoHash *key, IOBufferData *data, uint32_t len, bool copy = false, uint64_t auxkey = 0) override;
   int fixup(const CryptoHash *key, uint64_t old_auxkey, uint64_t new_auxkey) override;
   int64_t size() const override;
+  void hot_keys(std::vector<RamCacheKey> &keys, size_t max) const override;
 
   void init(int64_t max_bytes, Vol *vol) override;
 
@@ -101,6 +137,26 @@ private:
   int _ncompressed                = 0;
   RamCacheCLFUSEntry *_compressed = nullptr; // first uncompressed lru[0] entry
 
+  // compression ratio and speed of each codec by content kind, for CACHE_COMPRESSION_AUTO
+  struct CodecEstimate {
+    double ratio       = 1.0;
+    double ns_per_byte = 0;
+    int64_t samples    = 0;
+  };
+  CodecEstimate _estimate[CONTENT_KINDS][CACHE_COMPRESSION_AUTO];
+  int64_t _auto_picks[CONTENT_KINDS] = {0};
+#ifdef HAVE_ZSTD_H
+  RamCacheZstdDict *_zstd_dicts[ZSTD_DICTS] = {nullptr};
+  int _zstd_dict_current                    = -1;
+  ink_hrtime _zstd_dict_trained             = 0;
+
+  RamCacheZstdDict *_zstd_dict(const char *frame, uint32_t len) const;
+  void _train_zstd_dict(EThread *thread);
+#endif
+
+  int _pick_codec(int kind);
+  void _update_estimate(int kind, int codec, uint32_t in, uint32_t out, ink_hrtime elapsed);
+  void _release_compressed(RamCacheCLFUSEntry *e);
   void _resize_hashtable();
   void _victimize(RamCacheCLFUSEntry *e);
   void _move_compressed(RamCacheCLFUSEntry *e);
@@ -126,6 +182,279 @@ RamCacheCLFUS::size() const
   return s;
 }
 
+void
+RamCacheCLFUS::hot_keys(std::vector<RamCacheKey> &keys, size_t max) const
+{
+  // _lru[0] holds the resident entries, most recently used at the tail; _lru[1] is history only
+  for (RamCacheCLFUSEntry *e = this->_lru[0].tail; e && keys.size() < max; e = e->lru_link.prev) {
+    keys.push_back({e->key, e->auxkey});
+  }
+}
+
+struct RamCacheCodecStats {
+  int bytes_in;
+  int bytes_out;
+  int time;
+  int decompress_time;
+};
+
+// indexed by CACHE_COMPRESSION_*
+static const RamCacheCodecStats codec_stats[CACHE_COMPRESSION_AUTO] = {
+  {0, 0, 0, 0},
+  {cache_ram_cache_compress_fastlz_bytes_in_stat, cache_ram_cache_compress_fastlz_bytes_out_stat,
+   cache_ram_cache_compress_fastlz_time_stat, cache_ram_cache_compress_fastlz_decompress_time_stat},
+  {cache_ram_cache_compress_libz_bytes_in_stat, cache_ram_cache_compress_libz_bytes_out_stat, cache_ram_cache_compress_libz_time_stat,
+   cache_ram_cache_compress_libz_decompress_time_stat},
+  {cache_ram_cache_compress_liblzma_bytes_in_stat, cache_ram_cache_compress_liblzma_bytes_out_stat,
+   cache_ram_cache_compress_liblzma_time_stat, cache_ram_cache_compress_liblzma_decompress_time_stat},
+  {cache_ram_cache_compress_zstd_bytes_in_stat, cache_ram_cache_compress_zstd_bytes_out_stat, cache_ram_cache_compress_zstd_time_stat,
+   cache_ram_cache_compress_zstd_decompress_time_stat},
+  {cache_ram_cache_compress_lz4_bytes_in_stat, cache_ram_cache_compress_lz4_bytes_out_stat, cache_ram_cache_compress_lz4_time_stat,
+   cache_ram_cache_compress_lz4_decompress_time_stat},
+};
+
+// codecs CACHE_COMPRESSION_AUTO chooses from, lzma is too slow to be worth it
+static const int auto_codecs[] = {
+#ifdef HAVE_LZ4_H
+  CACHE_COMPRESSION_LZ4,
+#else
+  CACHE_COMPRESSION_FASTLZ,
+#endif
+#ifdef HAVE_ZSTD_H
+  CACHE_COMPRESSION_ZSTD,
+#endif
+#ifdef HAVE_ZLIB_H
+  CACHE_COMPRESSION_LIBZ,
+#endif
+};
+
+static const struct {
+  const char *magic;
+  size_t len;
+  size_t offset;
+} compressed_magic[] = {
+  {"\x1f\x8b", 2, 0},         // gzip
+  {"\x28\xb5\x2f\xfd", 4, 0}, // zstd
+  {"\xfd\x37zXZ\x00", 6, 0},  // xz
+  {"BZh", 3, 0},              // bzip2
+  {"PK\x03\x04", 4, 0},       // zip, jar, office documents
+  {"\x89PNG", 4, 0},          // png
+  {"\xff\xd8\xff", 3, 0},     // jpeg
+  {"GIF8", 4, 0},             // gif
+  {"WEBP", 4, 8},             // webp in a RIFF container
+  {"ftyp", 4, 4},             // mp4, heif, avif
+  {"wOF2", 4, 0},             // woff2
+  {"OggS", 4, 0},             // ogg
+  {"ID3", 3, 0},              // mp3
+};
+
+// Classifies the body of a cached document by sniffing it, the response headers may still be marshalled.
+static int
+content_kind(const char *buf, uint32_t len)
+{
+  const Doc *doc = reinterpret_cast<const Doc *>(buf);
+  if (len > sizeof(Doc) && doc->magic == DOC_MAGIC && doc->prefix_len() < len) {
+    buf += doc->prefix_len();
+    len -= doc->prefix_len();
+  }
+  for (auto const &m : compressed_magic) {
+    if (len >= m.offset + m.len && !memcmp(buf + m.offset, m.magic, m.len)) {
+      return CONTENT_COMPRESSED;
+    }
+  }
+  for (uint32_t i = 0; i < len && i < 512; i++) {
+    unsigned char c = buf[i];
+    if (c < 0x09 || (c > 0x0d && c < 0x20)) {
+      return CONTENT_BINARY;
+    }
+  }
+  return CONTENT_TEXT;
+}
+
+#ifdef HAVE_ZSTD_H
+// zstd contexts are reused, one per thread
+static thread_local ZSTD_CCtx *zstd_cctx = nullptr;
+static thread_local ZSTD_DCtx *zstd_dctx = nullptr;
+
+static ZSTD_CCtx *
+zstd_compress_context()
+{
+  if (!zstd_cctx) {
+    zstd_cctx = ZSTD_createCCtx();
+  }
+  return zstd_cctx;
+}
+
+static ZSTD_DCtx *
+zstd_decompress_context()
+{
+  if (!zstd_dctx) {
+    zstd_dctx = ZSTD_createDCtx();
+  }
+  return zstd_dctx;
+}
+
+RamCacheZstdDict *
+RamCacheCLFUS::_zstd_dict(const char *frame, uint32_t len) const
+{
+  unsigned id = ZSTD_getDictID_fromFrame(frame, len);
+  if (!id) {
+    return nullptr;
+  }
+  for (auto d : this->_zstd_dicts) {
+    if (d && d->id == id) {
+      return d;
+    }
+  }
+  return nullptr;
+}
+
+// Called and returns with the volume lock held, drops it while training.
+void
+RamCacheCLFUS::_train_zstd_dict(EThread *thread)
+{
+  ink_hrtime now = Thread::get_hrtime();
+  if (now < this->_zstd_dict_trained + ZSTD_DICT_RETRAIN) {
+    return;
+  }
+  this->_zstd_dict_trained = now;
+
+  // retire the dictionaries no entry uses anymore and find a slot for the new one
+  int slot = -1;
+  for (int i = 0; i < ZSTD_DICTS; i++) {
+    if (this->_zstd_dicts[i] && i != this->_zstd_dict_current && !this->_zstd_dicts[i]->entries) {
+      delete this->_zstd_dicts[i];
+      this->_zstd_dicts[i] = nullptr;
+    }
+    if (!this->_zstd_dicts[i] && slot < 0) {
+      slot = i;
+    }
+  }
+  if (slot < 0) {
+    return;
+  }
+
+  // sample the hottest uncompressed entries, their buffers are replaced but never modified
+  size_t dict_size = cache_config_ram_cache_zstd_dict_size;
+  size_t budget    = dict_size * ZSTD_DICT_SAMPLE_RATIO;
+  size_t total     = 0;
+  std::vector<Ptr<IOBufferData>> samples;
+  std::vector<size_t> sizes;
+  for (RamCacheCLFUSEntry *e = this->_lru[0].tail; e && total < budget; e = e->lru_link.prev) {
+    if (e->flag_bits.compressed || !e->data) {
+      continue;
+    }
+    size_t n = std::min(static_cast<size_t>(e->len), static_cast<size_t>(ZSTD_DICT_SAMPLE_SIZE));
+    samples.push_back(e->data);
+    sizes.push_back(n);
+    total += n;
+  }
+  if (samples.size() < ZSTD_DICT_MIN_SAMPLES) {
+    return;
+  }
+
+  MUTEX_UNTAKE_LOCK(this->mutex, thread);
+  char *buf = static_cast<char *>(ats_malloc(total));
+  char *p   = buf;
+  for (size_t i = 0; i < samples.size(); i++) {
+    memcpy(p, samples[i]->data(), sizes[i]);
+    p += sizes[i];
+  }
+  samples.clear();
+  char *dict           = static_cast<char *>(ats_malloc(dict_size));
+  size_t dlen          = ZDICT_trainFromBuffer(dict, dict_size, buf, sizes.data(), sizes.size());
+  RamCacheZstdDict *zd = nullptr;
+  if (ZDICT_isError(dlen)) {
+    Debug("ram_cache", "zstd dictionary training failed: %s", ZDICT_getErrorName(dlen));
+  } else {
+    zd        = new RamCacheZstdDict;
+    zd->id    = ZDICT_getDictID(dict, dlen);
+    zd->cdict = ZSTD_createCDict(dict, dlen, ZSTD_LEVEL);
+    zd->ddict = ZSTD_createDDict(dict, dlen);
+  }
+  ats_free(dict);
+  ats_free(buf);
+  MUTEX_TAKE_LOCK(this->mutex, thread);
+
+  // frames only carry the dictionary id, it must be unique among the live dictionaries
+  for (auto d : this->_zstd_dicts) {
+    if (zd && d && d->id == zd->id) {
+      delete zd;
+      zd = nullptr;
+    }
+  }
+  if (zd && (!zd->id || !zd->cdict || !zd->ddict)) {
+    delete zd;
+    zd = nullptr;
+  }
+  if (zd) {
+    Debug("ram_cache", "trained zstd dictionary %u of %zu bytes from %zu entries", zd->id, dlen, sizes.size());
+    this->_zstd_dicts[slot]  = zd;
+    this->_zstd_dict_current = slot;
+  }
+}
+#endif
+
+int
+RamCacheCLFUS::_pick_codec(int kind)
+{
+  CodecEstimate *est = this->_estimate[kind];
+  int64_t pick       = this->_auto_picks[kind]++;
+  int n              = countof(auto_codecs);
+
+  for (int c : auto_codecs) {
+    if (est[c].samples < AUTO_MIN_SAMPLES) {
+      return c;
+    }
+  }
+  // content changes, keep measuring the codecs that are not picked
+  if (!(pick % AUTO_EXPLORE)) {
+    return auto_codecs[(pick / AUTO_EXPLORE) % n];
+  }
+  double fastest = est[auto_codecs[0]].ns_per_byte;
+  for (int c : auto_codecs) {
+    fastest = std::min(fastest, est[c].ns_per_byte);
+  }
+  int best = auto_codecs[0];
+  for (int c : auto_codecs) {
+    if (est[c].ns_per_byte <= fastest * AUTO_CPU_FACTOR && est[c].ratio < est[best].ratio) {
+      best = c;
+    }
+  }
+  return best;
+}
+
+void
+RamCacheCLFUS::_update_estimate(int kind, int codec, uint32_t in, uint32_t out, ink_hrtime elapsed)
+{
+  CodecEstimate &est = this->_estimate[kind][codec];
+  double ratio       = static_cast<double>(out) / in;
+  double ns_per_byte = static_cast<double>(elapsed) / in;
+  if (!est.samples) {
+    est.ratio       = ratio;
+    est.ns_per_byte = ns_per_byte;
+  } else {
+    est.ratio       = (ratio + est.ratio * (AUTO_AVERAGE_OVER - 1)) / AUTO_AVERAGE_OVER;
+    est.ns_per_byte = (ns_per_byte + est.ns_per_byte * (AUTO_AVERAGE_OVER - 1)) / AUTO_AVERAGE_OVER;
+  }
+  est.samples++;
+}
+
+// Must be called before the compressed data of an entry is dropped.
+void
+RamCacheCLFUS::_release_compressed(RamCacheCLFUSEntry *e)
+{
+#ifdef HAVE_ZSTD_H
+  if (e->flag_bits.compressed == CACHE_COMPRESSION_ZSTD && e->data) {
+    if (RamCacheZstdDict *d = this->_zstd_dict(e->data->data(), e->compressed_len)) {
+      d->entries--;
+    }
+  }
+#else
+  (void)e;
+#endif
+}
+
 class RamCacheCLFUSCompressor : public Continuation
 {
 public:
@@ -154,6 +483,18 @@ RamCacheCLFUSCompressor::mainEvent(int /* event ATS_UNUSED */, Event *e)
     Warning("lzma not available for RAM cache compression");
 #endif
     break;
+  case CACHE_COMPRESSION_ZSTD:
+#ifndef HAVE_ZSTD_H
+    Warning("zstd not available for RAM cache compression");
+#endif
+    break;
+  case CACHE_COMPRESSION_LZ4:
+#ifndef HAVE_LZ4_H
+    Warning("lz4 not available for RAM cache compression");
+#endif
+    break;
+  case CACHE_COMPRESSION_AUTO:
+    break;
   }
   if (cache_config_ram_cache_compress_percent) {
     rc->compress_entries(e->ethread);
@@ -200,6 +541,9 @@ RamCacheCLFUS::init(int64_t abytes, Vol *avol)
   ink_assert(avol != nullptr);
   vol              = avol;
   this->_max_bytes = abytes;
+  if (!this->mutex) {
+    this->mutex = avol->mutex;
+  }
   DDebug("ram_cache", "initializing ram_cache %" PRId64 " bytes", abytes);
   if (!this->_max_bytes) {
     return;
@@ -244,7 +588,7 @@ RamCacheCLFUS::get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint64_t auxkey
   RamCacheCLFUSEntry *e = this->_bucket[i].head;
   char *b               = nullptr;
   while (e) {
-    if (e->key == *key && e->auxkey == auxkey) {
+    if (e->key == *key && (e->auxkey == auxkey || auxkey == RAM_CACHE_ANY_AUXKEY)) {
       this->_move_compressed(e);
       if (!e->flag_bits.lru) { // in memory
         if (CACHE_VALUE(e) > this->_average_value) {
@@ -254,7 +598,8 @@ RamCacheCLFUS::get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint64_t auxkey
         e->hits++;
         uint32_t ram_hit_state = RAM_HIT_COMPRESS_NONE;
         if (e->flag_bits.compressed) {
-          b = static_cast<char *>(ats_malloc(e->len));
+          b                = static_cast<char *>(ats_malloc(e->len));
+          ink_hrtime start = Thread::get_hrtime_updated();
           switch (e->flag_bits.compressed) {
           default:
             goto Lfailed;
@@ -289,10 +634,36 @@ RamCacheCLFUS::get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint64_t auxkey
             break;
           }
 #endif
+#ifdef HAVE_ZSTD_H
+          case CACHE_COMPRESSION_ZSTD: {
+            // a frame that needs a dictionary we do not have fails to decompress
+            RamCacheZstdDict *dict = this->_zstd_dict(e->data->data(), e->compressed_len);
+            size_t l = dict ? ZSTD_decompress_usingDDict(zstd_decompress_context(), b, e->len, e->data->data(), e->compressed_len,
+                                                         dict->ddict) :
+                              ZSTD_decompressDCtx(zstd_decompress_context(), b, e->len, e->data->data(), e->compressed_len);
+            if (ZSTD_isError(l) || l != e->len) {
+              goto Lfailed;
+            }
+            ram_hit_state = RAM_HIT_COMPRESS_ZSTD;
+            break;
+          }
+#endif
+#ifdef HAVE_LZ4_H
+          case CACHE_COMPRESSION_LZ4: {
+            int l = static_cast<int>(e->len);
+            if (l != LZ4_decompress_safe(e->data->data(), b, e->compressed_len, l)) {
+              goto Lfailed;
+            }
+            ram_hit_state = RAM_HIT_COMPRESS_LZ4;
+            break;
           }
+#endif
+          }
+          CACHE_SUM_DYN_STAT_THREAD(codec_stats[e->flag_bits.compressed].decompress_time, Thread::get_hrtime_updated() - start);
           IOBufferData *data = new_xmalloc_IOBufferData(b, e->len);
           data->_mem_type    = DEFAULT_ALLOC;
           if (!e->flag_bits.copy) { // don't bother if we have to copy anyway
+            this->_release_compressed(e);
             int64_t delta = (static_cast<int64_t>(e->compressed_len)) - static_cast<int64_t>(e->size);
             this->_bytes += delta;
             CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_bytes_stat, delta);
@@ -368,6 +739,7 @@ RamCacheCLFUS::_victimize(RamCacheCLFUSEntry *e)
 {
   this->_objects--;
   DDebug("ram_cache", "put %X %" PRId64 " size %d VICTIMIZED", e->key.slice32(3), e->auxkey, e->size);
+  this->_release_compressed(e);
   e->data          = nullptr;
   e->flag_bits.lru = 1;
   this->_lru[1].enqueue(e);
@@ -397,6 +769,7 @@ RamCacheCLFUS::_destroy(RamCacheCLFUSEntry *e)
     this->_objects--;
     this->_bytes -= e->size + ENTRY_OVERHEAD;
     CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_bytes_stat, -(int64_t)e->size);
+    this->_release_compressed(e);
     e->data = nullptr;
   } else {
     this->_history--;
@@ -415,7 +788,13 @@ RamCacheCLFUS::compress_entries(EThread *thread, int do_at_most)
     return;
   }
   ink_assert(vol != nullptr);
-  MUTEX_TAKE_LOCK(vol->mutex, thread);
+  MUTEX_TAKE_LOCK(this->mutex, thread);
+#ifdef HAVE_ZSTD_H
+  if (cache_config_ram_cache_zstd_dict_size > 0 &&
+      (cache_config_ram_cache_compress == CACHE_COMPRESSION_ZSTD || cache_config_ram_cache_compress == CACHE_COMPRESSION_AUTO)) {
+    this->_train_zstd_dict(thread);
+  }
+#endif
   if (!this->_compressed) {
     this->_compressed  = this->_lru[0].head;
     this->_ncompressed = 0;
@@ -436,6 +815,15 @@ RamCacheCLFUS::compress_entries(EThread *thread, int do_at_most)
       e->compressed_len = e->size;
       uint32_t l        = 0;
       int ctype         = cache_config_ram_cache_compress;
+      int kind          = CONTENT_BINARY;
+      if (ctype == CACHE_COMPRESSION_AUTO) {
+        kind = content_kind(e->data->data(), e->len);
+        if (kind == CONTENT_COMPRESSED) {
+          e->flag_bits.incompressible = 1;
+          goto Lcontinue;
+        }
+        ctype = this->_pick_codec(kind);
+      }
       switch (ctype) {
       default:
         goto Lcontinue;
@@ -451,15 +839,32 @@ RamCacheCLFUS::compress_entries(EThread *thread, int do_at_most)
       case CACHE_COMPRESSION_LIBLZMA:
         l = e->len;
         break;
+#endif
+#ifdef HAVE_ZSTD_H
+      case CACHE_COMPRESSION_ZSTD:
+        l = static_cast<uint32_t>(ZSTD_compressBound(e->len));
+        break;
+#endif
+#ifdef HAVE_LZ4_H
+      case CACHE_COMPRESSION_LZ4:
+        l = static_cast<uint32_t>(LZ4_compressBound(e->len));
+        break;
 #endif
       }
       // store transient data for lock release
       Ptr<IOBufferData> edata = e->data;
       uint32_t elen           = e->len;
       CryptoHash key          = e->key;
-      MUTEX_UNTAKE_LOCK(vol->mutex, thread);
-      b           = static_cast<char *>(ats_malloc(l));
-      bool failed = false;
+#ifdef HAVE_ZSTD_H
+      RamCacheZstdDict *dict = nullptr;
+      if (ctype == CACHE_COMPRESSION_ZSTD && this->_zstd_dict_current >= 0) {
+        dict = this->_zstd_dicts[this->_zstd_dict_current];
+      }
+#endif
+      MUTEX_UNTAKE_LOCK(this->mutex, thread);
+      b                = static_cast<char *>(ats_malloc(l));
+      bool failed      = false;
+      ink_hrtime start = Thread::get_hrtime_updated();
       switch (ctype) {
       default:
         goto Lfailed;
@@ -492,9 +897,39 @@ RamCacheCLFUS::compress_entries(EThread *thread, int do_at_most)
         l = static_cast<int>(pos);
         break;
       }
+#endif
+#ifdef HAVE_ZSTD_H
+      case CACHE_COMPRESSION_ZSTD: {
+        size_t ll = dict ? ZSTD_compress_usingCDict(zstd_compress_context(), b, l, edata->data(), elen, dict->cdict) :
+                           ZSTD_compressCCtx(zstd_compress_context(), b, l, edata->data(), elen, ZSTD_LEVEL);
+        if (ZSTD_isError(ll)) {
+          failed = true;
+        }
+        l = static_cast<uint32_t>(ll);
+        break;
+      }
+#endif
+#ifdef HAVE_LZ4_H
+      case CACHE_COMPRESSION_LZ4: {
+        int ll = LZ4_compress_default(edata->data(), b, elen, l);
+        if (ll <= 0) {
+          failed = true;
+        }
+        l = static_cast<uint32_t>(ll);
+        break;
+      }
 #endif
       }
-      MUTEX_TAKE_LOCK(vol->mutex, thread);
+      if (!failed) {
+        ink_hrtime elapsed = Thread::get_hrtime_updated() - start;
+        CACHE_SUM_DYN_STAT_THREAD(codec_stats[ctype].bytes_in, elen);
+        CACHE_SUM_DYN_STAT_THREAD(codec_stats[ctype].bytes_out, l);
+        CACHE_SUM_DYN_STAT_THREAD(codec_stats[ctype].time, elapsed);
+        if (cache_config_ram_cache_compress == CACHE_COMPRESSION_AUTO) {
+          this->_update_estimate(kind, ctype, elen, l, elapsed);
+        }
+      }
+      MUTEX_TAKE_LOCK(this->mutex, thread);
       // see if the entry is till around
       {
         if (failed) {
@@ -521,7 +956,13 @@ RamCacheCLFUS::compress_entries(EThread *thread, int do_at_most)
         goto Lfailed;
       }
       if (l < e->len) {
-        e->flag_bits.compressed = cache_config_ram_cache_compress;
+        e->flag_bits.compressed = ctype;
+#ifdef HAVE_ZSTD_H
+        // the dictionary cannot have been retired, only this compressor does that
+        if (dict) {
+          dict->entries++;
+        }
+#endif
         bb                      = static_cast<char *>(ats_malloc(l));
         memcpy(bb, b, l);
         ats_free(b);
@@ -558,7 +999,7 @@ RamCacheCLFUS::compress_entries(EThread *thread, int do_at_most)
     this->_compressed = e->lru_link.next;
     this->_ncompressed++;
   }
-  MUTEX_UNTAKE_LOCK(vol->mutex, thread);
+  MUTEX_UNTAKE_LOCK(this->mutex, thread);
   return;
 }
 
@@ -598,6 +1039,7 @@ RamCacheCLFUS::put(CryptoHash *key, IOBufferData *data, uint32_t len, bool copy,
     e->hits++;
     if (!e->flag_bits.lru) { // already in cache
       this->_move_compressed(e);
+      this->_release_compressed(e);
       this->_lru[e->flag_bits.lru].remove(e);
       this->_lru[e->flag_bits.lru].enqueue(e);
       int64_t delta = (static_cast<int64_t>(size)) - static_cast<int64_t>(e->size);
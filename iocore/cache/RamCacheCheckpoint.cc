@@ -0,0 +1,304 @@
+/** @file
+
+  Save the keys of the hottest RAM cache entries on shutdown and re-read
+  those objects from disk after a restart.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_Cache.h"
+#include "tscore/ink_file.h"
+
+#include <algorithm>
+#include <atomic>
+
+/*
+  The checkpoint only stores keys, never object data: the objects are
+  read back from the cache volumes, which are consistent with the
+  directory written by sync_cache_dir_on_shutdown() just before the
+  checkpoint is saved.  Entries whose directory slot has been reused in
+  the meantime are detected on read and dropped.
+
+  File layout, native byte order:
+    RamCacheCheckpointHeader
+    for each volume: RamCacheCheckpointVol, followed by count RamCacheKey
+*/
+
+#define RAM_CACHE_CHECKPOINT_FILE "ram_cache.checkpoint"
+#define RAM_CACHE_CHECKPOINT_MAGIC 0x52434350 // 'RCCP'
+#define RAM_CACHE_CHECKPOINT_VERSION 1
+#define RAM_CACHE_WARM_PROBES 256 // directory probes per event before yielding
+
+struct RamCacheCheckpointHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t nvols;
+  uint32_t unused;
+};
+
+struct RamCacheCheckpointVol {
+  CryptoHash hash_id;
+  uint64_t count;
+};
+
+static ink_hrtime warm_start_time = 0;
+static std::atomic<int> warmers_active{0};
+
+static void
+checkpoint_path(char *path, size_t len)
+{
+  ats_scoped_str rundir(RecConfigReadRuntimeDir());
+  ink_filepath_make(path, len, rundir, RAM_CACHE_CHECKPOINT_FILE);
+}
+
+static bool
+write_all(int fd, const void *buf, size_t len)
+{
+  return static_cast<size_t>(write(fd, buf, len)) == len;
+}
+
+static bool
+read_all(int fd, void *buf, size_t len)
+{
+  return static_cast<size_t>(read(fd, buf, len)) == len;
+}
+
+/*
+  Re-reads the objects of one volume from disk and puts them into the
+  volume's RAM cache.  Runs under the volume lock and issues one read at
+  a time so that it never competes hard with live traffic.
+*/
+struct RamCacheWarmer : public Continuation {
+  Vol *vol;
+  std::vector<RamCacheKey> keys;
+  size_t next    = 0;
+  int64_t warmed = 0;
+  Dir dir;
+  AIOCallbackInternal io;
+  Ptr<IOBufferData> buf;
+
+  int mainEvent(int event, Event *e);
+  int handleReadDone(int event, void *data);
+
+  bool find(const RamCacheKey &k);
+  void read_object();
+
+  explicit RamCacheWarmer(Vol *avol) : Continuation(avol->mutex), vol(avol)
+  {
+    dir_clear(&dir);
+    SET_HANDLER(&RamCacheWarmer::mainEvent);
+  }
+};
+
+bool
+RamCacheWarmer::find(const RamCacheKey &k)
+{
+  Dir *last_collision = nullptr;
+  while (dir_probe(&k.key, vol, &dir, &last_collision)) {
+    if (static_cast<uint64_t>(dir_offset(&dir)) == k.auxkey) {
+      // still in the aggregation buffer, nothing to read from disk
+      return !dir_agg_buf_valid(vol, &dir);
+    }
+  }
+  return false;
+}
+
+void
+RamCacheWarmer::read_object()
+{
+  io.aiocb.aio_fildes = vol->fd;
+  io.aiocb.aio_offset = vol->vol_offset(&dir);
+  io.aiocb.aio_nbytes = dir_approx_size(&dir);
+  if (static_cast<off_t>(io.aiocb.aio_offset + io.aiocb.aio_nbytes) > static_cast<off_t>(vol->skip + vol->len)) {
+    io.aiocb.aio_nbytes = vol->skip + vol->len - io.aiocb.aio_offset;
+  }
+  buf              = new_IOBufferData(iobuffer_size_to_index(io.aiocb.aio_nbytes, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
+  io.aiocb.aio_buf = buf->data();
+  io.action        = this;
+  io.thread        = AIO_CALLBACK_THREAD_ANY;
+  io.then          = nullptr;
+  SET_HANDLER(&RamCacheWarmer::handleReadDone);
+  ink_assert(ink_aio_read(&io) >= 0);
+}
+
+int
+RamCacheWarmer::mainEvent(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  for (int probes = 0; next < keys.size(); ++probes) {
+    if (probes >= RAM_CACHE_WARM_PROBES) {
+      eventProcessor.schedule_imm(this);
+      return EVENT_CONT;
+    }
+    if (find(keys[next++])) {
+      read_object();
+      return EVENT_CONT;
+    }
+  }
+
+  Debug("cache_init", "warmed %" PRId64 " of %zu RAM cache objects for '%s'", warmed, keys.size(), vol->hash_text.get());
+  if (warmers_active.fetch_sub(1) == 1) {
+    GLOBAL_CACHE_SET_DYN_STAT(cache_ram_cache_warm_time_stat, Thread::get_hrtime() - warm_start_time);
+  }
+  delete this;
+  return EVENT_DONE;
+}
+
+int
+RamCacheWarmer::handleReadDone(int /* event ATS_UNUSED */, void * /* data ATS_UNUSED */)
+{
+  const RamCacheKey &k = keys[next - 1];
+  Doc *doc             = reinterpret_cast<Doc *>(buf->data());
+
+  // the slot may have been reused or the object removed since the checkpoint was taken
+  if (io.ok() && doc->magic == DOC_MAGIC && (doc->key == k.key || doc->first_key == k.key) && dir_valid(vol, &dir) &&
+      ts::VersionNumber(doc->v_major, doc->v_minor) <= CACHE_DB_VERSION) {
+    int okay = 1;
+    // same rule as CacheVC::handleReadDone: headers stay marshalled if the RAM cache may compress the entry
+    bool http_copy_hdr = cache_config_ram_cache_compress && doc->doc_type == CACHE_FRAG_TYPE_HTTP && doc->hlen;
+    if (!http_copy_hdr && doc->doc_type == CACHE_FRAG_TYPE_HTTP && doc->hlen) {
+      unmarshal_helper(doc, buf, okay);
+    }
+    if (okay) {
+      CryptoHash key = k.key;
+      int stored     = vol->ram_cache->put(&key, buf.get(), doc->len, http_copy_hdr, k.auxkey);
+      // the entry passed the seen filter before the restart, the first put only primed it again
+      if (!stored && cache_config_ram_cache_use_seen_filter) {
+        stored = vol->ram_cache->put(&key, buf.get(), doc->len, http_copy_hdr, k.auxkey);
+      }
+      if (stored) {
+        ++warmed;
+        CACHE_INCREMENT_DYN_STAT(cache_ram_cache_warm_objects_stat);
+      }
+    }
+  }
+  buf = nullptr;
+
+  SET_HANDLER(&RamCacheWarmer::mainEvent);
+  return mainEvent(EVENT_IMMEDIATE, nullptr);
+}
+
+void
+ram_cache_checkpoint_save()
+{
+  if (!cache_config_ram_cache_checkpoint || cache_config_ram_cache_checkpoint_objects <= 0) {
+    return;
+  }
+
+  char path[PATH_NAME_MAX];
+  char tmp_path[PATH_NAME_MAX];
+  checkpoint_path(path, sizeof(path));
+  snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+  ats_scoped_fd fd(open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644));
+  if (fd < 0) {
+    Warning("unable to create RAM cache checkpoint '%s': %s", tmp_path, strerror(errno));
+    return;
+  }
+
+  RamCacheCheckpointHeader h = {RAM_CACHE_CHECKPOINT_MAGIC, RAM_CACHE_CHECKPOINT_VERSION, static_cast<uint32_t>(gnvol), 0};
+  bool ok                    = write_all(fd, &h, sizeof(h));
+  uint64_t total             = 0;
+
+  std::vector<RamCacheKey> keys;
+  for (int i = 0; ok && i < gnvol; i++) {
+    Vol *vol = gvol[i];
+    keys.clear();
+    if (vol->ram_cache && !DISK_BAD(vol->disk)) {
+      vol->ram_cache->hot_keys(keys, cache_config_ram_cache_checkpoint_objects);
+    }
+    RamCacheCheckpointVol v = {vol->hash_id, keys.size()};
+    ok                      = write_all(fd, &v, sizeof(v)) && write_all(fd, keys.data(), keys.size() * sizeof(RamCacheKey));
+    total += keys.size();
+  }
+
+  if (!ok || fsync(fd) < 0 || rename(tmp_path, path) < 0) {
+    Warning("unable to write RAM cache checkpoint '%s': %s", path, strerror(errno));
+    unlink(tmp_path);
+    return;
+  }
+  Debug("cache_dir_sync", "saved %" PRIu64 " RAM cache keys to '%s'", total, path);
+}
+
+void
+ram_cache_checkpoint_load()
+{
+  if (!cache_config_ram_cache_checkpoint) {
+    return;
+  }
+
+  char path[PATH_NAME_MAX];
+  checkpoint_path(path, sizeof(path));
+  ats_scoped_fd fd(open(path, O_RDONLY));
+  if (fd < 0) {
+    if (errno != ENOENT) {
+      Warning("unable to open RAM cache checkpoint '%s': %s", path, strerror(errno));
+    }
+    return;
+  }
+  // the checkpoint describes a single shutdown, never replay it twice
+  unlink(path);
+
+  RamCacheCheckpointHeader h;
+  if (!read_all(fd, &h, sizeof(h)) || h.magic != RAM_CACHE_CHECKPOINT_MAGIC || h.version != RAM_CACHE_CHECKPOINT_VERSION) {
+    Warning("ignoring invalid RAM cache checkpoint '%s'", path);
+    return;
+  }
+
+  warm_start_time = Thread::get_hrtime();
+  for (uint32_t n = 0; n < h.nvols; n++) {
+    RamCacheCheckpointVol v;
+    if (!read_all(fd, &v, sizeof(v)) || v.count > static_cast<uint64_t>(INT_MAX)) {
+      Warning("truncated RAM cache checkpoint '%s'", path);
+      break;
+    }
+
+    Vol *vol = nullptr;
+    for (int i = 0; i < gnvol; i++) {
+      if (gvol[i]->hash_id == v.hash_id) {
+        vol = gvol[i];
+        break;
+      }
+    }
+
+    // keys of volumes that are gone or unusable are skipped, not loaded
+    if (!vol || !vol->ram_cache || DISK_BAD(vol->disk) || !v.count) {
+      if (v.count && lseek(fd, v.count * sizeof(RamCacheKey), SEEK_CUR) < 0) {
+        break;
+      }
+      continue;
+    }
+
+    RamCacheWarmer *w = new RamCacheWarmer(vol);
+    w->keys.resize(v.count);
+    if (!read_all(fd, w->keys.data(), v.count * sizeof(RamCacheKey))) {
+      Warning("truncated RAM cache checkpoint '%s'", path);
+      delete w;
+      break;
+    }
+    // keep no more than currently configured, hottest first
+    if (cache_config_ram_cache_checkpoint_objects >= 0 &&
+        w->keys.size() > static_cast<size_t>(cache_config_ram_cache_checkpoint_objects)) {
+      w->keys.resize(cache_config_ram_cache_checkpoint_objects);
+    }
+    // the RAM cache promotes on insert, so warm the coldest entries first
+    std::reverse(w->keys.begin(), w->keys.end());
+    ++warmers_active;
+    eventProcessor.schedule_imm(w);
+  }
+}
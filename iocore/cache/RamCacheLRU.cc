@@ -43,6 +43,7 @@ struct RamCacheLRU : public RamCache {
   int put(CryptoHash *key, IOBufferData *data, uint32_t len, bool copy = false, uint64_t auxkey = 0) override;
   int fixup(const CryptoHash *key, uint64_t old_auxkey, uint64_t new_auxkey) override;
   int64_t size() const override;
+  void hot_keys(std::vector<RamCacheKey> &keys, size_t max) const override;
 
   void init(int64_t max_bytes, Vol *vol) override;
 
@@ -71,6 +72,15 @@ RamCacheLRU::size() const
   return s;
 }
 
+void
+RamCacheLRU::hot_keys(std::vector<RamCacheKey> &keys, size_t max) const
+{
+  // the most recently used entries are at the tail
+  for (RamCacheLRUEntry *e = lru.tail; e && keys.size() < max; e = e->lru_link.prev) {
+    keys.push_back({e->key, e->auxkey});
+  }
+}
+
 ClassAllocator<RamCacheLRUEntry> ramCacheLRUEntryAllocator("RamCacheLRUEntry");
 
 static const int bucket_sizes[] = {127,     251,      509,      1021,     2039,      4093,      8191,     16381,
@@ -125,7 +135,7 @@ RamCacheLRU::get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint64_t auxkey)
   uint32_t i          = key->slice32(3) % nbuckets;
   RamCacheLRUEntry *e = bucket[i].head;
   while (e) {
-    if (e->key == *key && e->auxkey == auxkey) {
+    if (e->key == *key && (e->auxkey == auxkey || auxkey == RAM_CACHE_ANY_AUXKEY)) {
       lru.remove(e);
       lru.enqueue(e);
       (*ret_data) = e->data;
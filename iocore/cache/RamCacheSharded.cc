@@ -0,0 +1,273 @@
+/** @file
+
+  A RAM cache split into independent shards, with a small per thread
+  front cache for the hottest small objects.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_Cache.h"
+
+#include <atomic>
+
+/*
+  Each shard is a complete RamCacheLRU or RamCacheCLFUS owning a fraction
+  of the volume's RAM cache, selected by key, behind a lock of its own.
+  The volume lock is not needed, so readers look up the fragments of a
+  body before they take it (see CacheVC::openReadMain), and with CLFUS
+  every shard runs its own compressor under its own lock.
+
+  The front cache is per thread and per volume.  It is direct mapped and
+  holds references to small objects the shards returned, replacing a
+  resident object only after it missed out on enough hits.  A hit there
+  touches no shared memory at all.  Entries are matched on key and auxkey
+  like in the shards; the auxkey is the disk offset of the document, so a
+  matching entry is the same document even if the shard dropped it since.
+  Entries found with RAM_CACHE_ANY_AUXKEY match any auxkey, they are body
+  fragments whose key is never reused.  The front caches of all threads
+  share a budget taken out of the volume's RAM cache size.
+*/
+
+#define FRONT_CACHE_MAX_HITS 15   // cap on the hit count protecting a front cache slot
+#define FRONT_CACHE_BUDGET_SHIFT 3 // the front caches get up to 1/8 of the RAM cache size
+
+struct RamCacheFrontSlot {
+  CryptoHash key;
+  uint64_t auxkey = 0;
+  int hits        = 0;
+  Ptr<IOBufferData> data;
+};
+
+struct RamCacheFrontCache {
+  uint32_t mask;
+  RamCacheFrontSlot *slots;
+
+  explicit RamCacheFrontCache(uint32_t n) : mask(n - 1), slots(new RamCacheFrontSlot[n]) {}
+  ~RamCacheFrontCache() { delete[] slots; }
+};
+
+class RamCacheSharded : public RamCache
+{
+public:
+  RamCacheSharded(RamCache *(*new_shard)(), int nshards);
+  ~RamCacheSharded() override;
+
+  int get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint64_t auxkey = 0) override;
+  int put(CryptoHash *key, IOBufferData *data, uint32_t len, bool copy = false, uint64_t auxkey = 0) override;
+  int fixup(const CryptoHash *key, uint64_t old_auxkey, uint64_t new_auxkey) override;
+  int64_t size() const override;
+  void hot_keys(std::vector<RamCacheKey> &keys, size_t max) const override;
+
+  bool
+  has_own_locks() const override
+  {
+    return true;
+  }
+
+  void init(int64_t max_bytes, Vol *vol) override;
+
+private:
+  Vol *vol = nullptr; // for stats
+  std::vector<RamCache *> _shards;
+  size_t _index; // of this cache in every thread's front_caches
+  int64_t _front_budget = 0;
+  std::atomic<int64_t> _front_bytes{0};
+
+  RamCache *
+  _shard(const CryptoHash *key) const
+  {
+    return this->_shards[key->slice32(2) % this->_shards.size()];
+  }
+  RamCacheFrontCache *_front_cache() const;
+  void _front_fill(RamCacheFrontSlot *slot, CryptoHash *key, uint64_t auxkey, Ptr<IOBufferData> &data);
+};
+
+static std::atomic<size_t> next_index{0};
+static thread_local std::vector<RamCacheFrontCache *> front_caches;
+
+RamCacheSharded::RamCacheSharded(RamCache *(*new_shard)(), int nshards) : _index(next_index++)
+{
+  for (int i = 0; i < nshards; i++) {
+    RamCache *shard = new_shard();
+    shard->mutex    = new_ProxyMutex();
+    this->_shards.push_back(shard);
+  }
+}
+
+RamCacheSharded::~RamCacheSharded()
+{
+  for (auto shard : this->_shards) {
+    delete shard;
+  }
+}
+
+void
+RamCacheSharded::init(int64_t max_bytes, Vol *avol)
+{
+  vol = avol;
+  if (cache_config_ram_cache_front_objects) {
+    this->_front_budget = max_bytes >> FRONT_CACHE_BUDGET_SHIFT;
+  }
+  for (auto shard : this->_shards) {
+    shard->init((max_bytes - this->_front_budget) / this->_shards.size(), avol);
+  }
+}
+
+// Front caches are created on first use by each event thread, threads never exit so they are never freed.
+RamCacheFrontCache *
+RamCacheSharded::_front_cache() const
+{
+  if (!cache_config_ram_cache_front_objects || !this_ethread()) {
+    return nullptr;
+  }
+  if (front_caches.size() <= this->_index) {
+    front_caches.resize(this->_index + 1, nullptr);
+  }
+  if (!front_caches[this->_index]) {
+    uint32_t n = 1;
+    while (n < static_cast<uint32_t>(cache_config_ram_cache_front_objects)) {
+      n <<= 1;
+    }
+    front_caches[this->_index] = new RamCacheFrontCache(n);
+  }
+  return front_caches[this->_index];
+}
+
+// Store data in an unprotected slot of the front cache, if it fits in the budget.
+void
+RamCacheSharded::_front_fill(RamCacheFrontSlot *slot, CryptoHash *key, uint64_t auxkey, Ptr<IOBufferData> &data)
+{
+  int64_t len   = data->block_size();
+  int64_t freed = slot->data ? slot->data->block_size() : 0;
+  if (this->_front_bytes.fetch_add(len - freed) + len - freed > this->_front_budget) {
+    this->_front_bytes -= len - freed;
+    return;
+  }
+  CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_bytes_stat, len - freed);
+  slot->key    = *key;
+  slot->auxkey = auxkey;
+  slot->hits   = 1;
+  if (cache_config_ram_cache_compress) {
+    // keep our own copy, the one returned is about to be unmarshalled
+    IOBufferData *copy = new_IOBufferData(iobuffer_size_to_index(len, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
+    memcpy(copy->data(), data->data(), len);
+    slot->data = copy;
+  } else {
+    slot->data = data;
+  }
+}
+
+int
+RamCacheSharded::get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint64_t auxkey)
+{
+  RamCacheFrontCache *front = this->_front_cache();
+  RamCacheFrontSlot *slot   = front ? &front->slots[key->slice32(3) & front->mask] : nullptr;
+
+  if (slot && slot->data && slot->key == *key &&
+      (slot->auxkey == auxkey || slot->auxkey == RAM_CACHE_ANY_AUXKEY || auxkey == RAM_CACHE_ANY_AUXKEY)) {
+    if (slot->hits < FRONT_CACHE_MAX_HITS) {
+      slot->hits++;
+    }
+    // the reader unmarshals the headers in place when the RAM cache keeps them marshalled
+    if (cache_config_ram_cache_compress) {
+      int64_t len        = slot->data->block_size();
+      IOBufferData *data = new_IOBufferData(iobuffer_size_to_index(len, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
+      memcpy(data->data(), slot->data->data(), len);
+      (*ret_data) = data;
+    } else {
+      (*ret_data) = slot->data;
+    }
+    CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_hits_stat, 1);
+    CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_front_hits_stat, 1);
+    DDebug("ram_cache", "get %X %" PRIu64 " FRONT HIT", key->slice32(3), auxkey);
+    return RAM_HIT_COMPRESS_NONE;
+  }
+
+  int ret;
+  {
+    RamCache *shard = this->_shard(key);
+    SCOPED_MUTEX_LOCK(lock, shard->mutex, this_ethread());
+    ret = shard->get(key, ret_data, auxkey);
+  }
+  if (ret && slot && (*ret_data)->block_size() <= cache_config_ram_cache_front_max_size) {
+    if (!slot->data || !slot->hits) {
+      this->_front_fill(slot, key, auxkey, *ret_data);
+    } else {
+      slot->hits--;
+    }
+  }
+  return ret;
+}
+
+int
+RamCacheSharded::put(CryptoHash *key, IOBufferData *data, uint32_t len, bool copy, uint64_t auxkey)
+{
+  RamCache *shard = this->_shard(key);
+  SCOPED_MUTEX_LOCK(lock, shard->mutex, this_ethread());
+  return shard->put(key, data, len, copy, auxkey);
+}
+
+int
+RamCacheSharded::fixup(const CryptoHash *key, uint64_t old_auxkey, uint64_t new_auxkey)
+{
+  RamCache *shard = this->_shard(key);
+  SCOPED_MUTEX_LOCK(lock, shard->mutex, this_ethread());
+  return shard->fixup(key, old_auxkey, new_auxkey);
+}
+
+int64_t
+RamCacheSharded::size() const
+{
+  int64_t s = this->_front_bytes;
+  for (auto shard : this->_shards) {
+    SCOPED_MUTEX_LOCK(lock, shard->mutex, this_ethread());
+    s += shard->size();
+  }
+  return s;
+}
+
+void
+RamCacheSharded::hot_keys(std::vector<RamCacheKey> &keys, size_t max) const
+{
+  // interleave the shards so that the result stays roughly ordered by recency
+  std::vector<std::vector<RamCacheKey>> per_shard(this->_shards.size());
+  for (size_t i = 0; i < this->_shards.size(); i++) {
+    RamCache *shard = this->_shards[i];
+    SCOPED_MUTEX_LOCK(lock, shard->mutex, this_ethread());
+    shard->hot_keys(per_shard[i], max / this->_shards.size() + 1);
+  }
+  for (size_t rank = 0; keys.size() < max; rank++) {
+    bool more = false;
+    for (size_t i = 0; i < per_shard.size() && keys.size() < max; i++) {
+      if (rank < per_shard[i].size()) {
+        keys.push_back(per_shard[i][rank]);
+        more = true;
+      }
+    }
+    if (!more) {
+      break;
+    }
+  }
+}
+
+RamCache *
+new_RamCacheSharded(RamCache *(*new_shard)(), int nshards)
+{
+  return new RamCacheSharded(new_shard, nshards);
+}
@@ -0,0 +1,214 @@
+/** @file
+
+  Cache aggregation write throughput benchmark
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include "tscore/I_Layout.h"
+#include "RecordsConfig.h"
+#include "P_Cache.h"
+
+#include "diags.i"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+/*
+  Pushes documents through Vol::aggWrite into a scratch file and reports
+  the write throughput for several aggregation buffer sizes and counts.
+  The file is created in $TMPDIR (default /tmp) and opened with O_DIRECT
+  when the file system allows it, point TMPDIR at the device to measure.
+*/
+
+#define SEGMENTS 1
+#define BUCKETS 1024
+#define DOC_BYTES (256 * 1024)
+#define TOTAL_BYTES (static_cast<off_t>(64) * 1024 * 1024)
+
+namespace
+{
+RecRawStatBlock *vol_rsb = nullptr;
+
+// A volume backed by a scratch file, with just enough state for the aggregation write path.
+struct BenchVol {
+  Vol vol;
+  CacheVol cache_vol;
+
+  BenchVol(int fd, int agg_size, int agg_buffers)
+  {
+    cache_vol.vol_rsb = vol_rsb;
+    vol.cache_vol     = &cache_vol;
+    vol.hash_text     = ats_strdup("benchmark");
+    vol.fd            = fd;
+    vol.sector_size   = CACHE_BLOCK_SIZE;
+    vol.segments      = SEGMENTS;
+    vol.buckets       = BUCKETS;
+    vol.skip          = 0;
+    vol.start         = vol.skip + 2 * vol.dirlen();
+    vol.len           = vol.start + TOTAL_BYTES + static_cast<off_t>(agg_size) * (agg_buffers + 2);
+
+    vol.raw_dir = static_cast<char *>(ats_memalign(ats_pagesize(), vol.dirlen()));
+    memset(vol.raw_dir, 0, vol.dirlen());
+    vol.dir    = reinterpret_cast<Dir *>(vol.raw_dir + vol.headerlen());
+    vol.header = reinterpret_cast<VolHeaderFooter *>(vol.raw_dir);
+    vol.footer = reinterpret_cast<VolHeaderFooter *>(vol.raw_dir + vol.dirlen() - ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter)));
+    vol.dir_mark_all_dirty();
+    vol_init_dir(&vol);
+    vol.header->write_pos = vol.header->agg_pos = vol.header->last_write_pos = vol.start;
+    vol.scan_pos                                                             = vol.start;
+
+    vol.evacuate_size = static_cast<int>(vol.len / EVACUATION_BUCKET_SIZE) + 2;
+    vol.evacuate = static_cast<DLL<EvacuationBlock> *>(ats_calloc(vol.evacuate_size, sizeof(DLL<EvacuationBlock>)));
+
+    vol.agg_size    = agg_size;
+    vol.agg_buffers = agg_buffers;
+    for (int i = 0; i < agg_buffers; i++) {
+      vol.agg_writes[i].buffer = static_cast<char *>(ats_memalign(ats_pagesize(), agg_size));
+      memset(vol.agg_writes[i].buffer, 0, agg_size);
+    }
+    vol.agg_buffer = vol.agg_writes[0].buffer;
+  }
+
+  ~BenchVol()
+  {
+    ats_free(vol.evacuate);
+    ats_free(vol.raw_dir);
+  }
+};
+
+// The documents are queued like evacuated fragments, which aggWrite copies without touching the directory.
+void
+queue_docs(Vol *vol, Ptr<IOBufferData> &doc)
+{
+  for (off_t n = 0; n < TOTAL_BYTES / DOC_BYTES; n++) {
+    CacheVC *c = new_DocEvacuator(sizeof(Doc), vol);
+    c->buf     = doc;
+    dir_clear(&c->overwrite_dir);
+    c->agg_len = vol->round_to_approx_size(DOC_BYTES);
+    vol->agg_todo_size += c->agg_len;
+    vol->agg.enqueue(c);
+  }
+}
+
+double
+write_all(int fd, int agg_size, int agg_buffers, Ptr<IOBufferData> &doc)
+{
+  BenchVol bv(fd, agg_size, agg_buffers);
+  Vol *vol = &bv.vol;
+
+  auto start = std::chrono::steady_clock::now();
+  {
+    SCOPED_MUTEX_LOCK(lock, vol->mutex, this_ethread());
+    queue_docs(vol, doc);
+    vol->aggWrite(EVENT_NONE, nullptr);
+  }
+  // the rest is driven by the write completions
+  for (bool busy = true; busy;) {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+    SCOPED_MUTEX_LOCK(lock, vol->mutex, this_ethread());
+    busy = vol->agg.head || vol->agg_buf_pos || vol->agg_writes_in_flight;
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  // every document landed where its buffer was issued, buffers are numbered by write_serial
+  char *check = static_cast<char *>(ats_memalign(ats_pagesize(), STORE_BLOCK_SIZE));
+  int bad     = 0;
+  for (off_t o = 0; o < TOTAL_BYTES; o += DOC_BYTES) {
+    Doc *d = reinterpret_cast<Doc *>(check);
+    if (pread(fd, check, STORE_BLOCK_SIZE, vol->start + o) != STORE_BLOCK_SIZE || d->magic != DOC_MAGIC ||
+        d->write_serial != static_cast<uint32_t>(o / agg_size)) {
+      ++bad;
+    }
+  }
+  ats_free(check);
+  REQUIRE(bad == 0);
+  REQUIRE(vol->header->write_pos == vol->start + TOTAL_BYTES);
+
+  return TOTAL_BYTES / elapsed.count() / (1024 * 1024);
+}
+
+} // namespace
+
+TEST_CASE("cache aggregation write throughput", "[cache][agg]")
+{
+  const char *tmpdir = std::getenv("TMPDIR");
+  std::string path   = std::string(tmpdir && *tmpdir ? tmpdir : "/tmp") + "/benchmark_AggWrite.XXXXXX";
+  int fd             = mkstemp(&path[0]);
+  REQUIRE(fd >= 0);
+  close(fd);
+  // page cache writes say little about the device, bypass it if we can
+  fd          = open(path.c_str(), O_RDWR | O_DIRECT);
+  bool direct = fd >= 0;
+  if (!direct) {
+    fd = open(path.c_str(), O_RDWR);
+  }
+  unlink(path.c_str());
+  REQUIRE(fd >= 0);
+
+  Ptr<IOBufferData> doc(new_IOBufferData(iobuffer_size_to_index(DOC_BYTES, MAX_BUFFER_SIZE_INDEX), MEMALIGNED));
+  memset(doc->data(), 0x5a, DOC_BYTES);
+  Doc *d = reinterpret_cast<Doc *>(doc->data());
+  memset(static_cast<void *>(d), 0, sizeof(Doc));
+  d->magic = DOC_MAGIC;
+  d->len   = DOC_BYTES;
+
+  std::printf("%s, %s\n", path.c_str(), direct ? "O_DIRECT" : "buffered");
+  std::printf("%14s %8s %10s\n", "buffer size", "buffers", "MB/s");
+  for (int agg_size : {AGG_SIZE, 4 * AGG_SIZE}) {
+    for (int agg_buffers = 1; agg_buffers <= 3; agg_buffers++) {
+      REQUIRE(ftruncate(fd, 0) == 0);
+      double mbs = write_all(fd, agg_size, agg_buffers, doc);
+      std::printf("%12dMB %8d %10.1f\n", agg_size / (1024 * 1024), agg_buffers, mbs);
+    }
+  }
+  close(fd);
+}
+
+struct EventProcessorListener : Catch::TestEventListenerBase {
+  using TestEventListenerBase::TestEventListenerBase;
+
+  void
+  testRunStarting(Catch::TestRunInfo const &testRunInfo) override
+  {
+    Layout::create();
+    init_diags("", nullptr);
+    RecProcessInit(RECM_STAND_ALONE);
+    LibRecordsConfigInit();
+
+    ink_event_system_init(EVENT_SYSTEM_MODULE_PUBLIC_VERSION);
+    eventProcessor.start(1);
+    ink_aio_init(AIO_MODULE_PUBLIC_VERSION);
+
+    EThread *main_thread = new EThread;
+    main_thread->set_specific();
+    init_buffer_allocators(0);
+
+    cache_rsb = RecAllocateRawStatBlock(static_cast<int>(cache_stat_count));
+    vol_rsb   = RecAllocateRawStatBlock(static_cast<int>(cache_stat_count));
+  }
+};
+
+CATCH_REGISTER_LISTENER(EventProcessorListener);
@@ -0,0 +1,223 @@
+/** @file
+
+  Cache directory lookup benchmark
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include "tscore/I_Layout.h"
+#include "RecordsConfig.h"
+#include "P_Cache.h"
+
+#include "diags.i"
+
+#include <cstdio>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#define SEGMENTS 16
+#define DIR_LOAD 0.75 // fraction of the directory entries in use
+#define PROBES 10000
+#define CACHE_LINE 64
+
+namespace
+{
+RecRawStatBlock *vol_rsb = nullptr;
+
+// A volume with nothing but a directory, enough to drive the dir_* functions.
+struct BenchVol {
+  Vol vol;
+  CacheVol cache_vol;
+
+  BenchVol(int buckets, bool tag_index)
+  {
+    cache_vol.vol_rsb = vol_rsb;
+    vol.cache_vol     = &cache_vol;
+    vol.segments      = SEGMENTS;
+    vol.buckets       = buckets;
+    vol.skip          = 0;
+    vol.start         = vol.skip + 2 * vol.dirlen();
+
+    vol.raw_dir = static_cast<char *>(ats_memalign(ats_pagesize(), vol.dirlen()));
+    memset(vol.raw_dir, 0, vol.dirlen());
+    vol.dir    = reinterpret_cast<Dir *>(vol.raw_dir + vol.headerlen());
+    vol.header = reinterpret_cast<VolHeaderFooter *>(vol.raw_dir);
+    vol.footer = reinterpret_cast<VolHeaderFooter *>(vol.raw_dir + vol.dirlen() - ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter)));
+    vol.dir_mark_all_dirty();
+    if (tag_index) {
+      vol.tag_index = static_cast<uint16_t *>(ats_calloc(vol.segments * vol.buckets * DIR_DEPTH, sizeof(uint16_t)));
+    }
+    vol_init_dir(&vol);
+
+    // every offset handed out below is in phase and already written
+    vol.header->write_pos = vol.start + static_cast<off_t>(vol.segments) * vol.buckets * DIR_DEPTH * CACHE_BLOCK_SIZE;
+    vol.header->agg_pos   = vol.header->write_pos;
+    vol.len               = 2 * vol.header->write_pos;
+  }
+
+  ~BenchVol() { ats_free(vol.raw_dir); }
+};
+
+CacheKey
+random_key(std::mt19937_64 &rng)
+{
+  CacheKey key;
+  key.u64[0] = rng();
+  key.u64[1] = rng();
+  return key;
+}
+
+void
+fill(Vol *vol, const std::vector<CacheKey> &keys)
+{
+  Dir dir;
+  int64_t offset = 0;
+  for (auto const &key : keys) {
+    ++offset; // dir_set_offset evaluates its argument more than once
+    dir_clear(&dir);
+    dir_set_head(&dir, true);
+    dir_set_offset(&dir, offset);
+    dir_insert(&key, vol, &dir);
+  }
+}
+
+int
+probe_all(Vol *vol, const std::vector<CacheKey> &keys)
+{
+  int found = 0;
+  Dir result;
+  for (auto const &key : keys) {
+    Dir *last_collision = nullptr;
+    found += dir_probe(&key, vol, &result, &last_collision);
+  }
+  return found;
+}
+
+void
+add_lines(std::set<uintptr_t> &lines, const void *p, size_t len)
+{
+  uintptr_t a = reinterpret_cast<uintptr_t>(p);
+  for (uintptr_t l = a / CACHE_LINE; l <= (a + len - 1) / CACHE_LINE; l++) {
+    lines.insert(l);
+  }
+}
+
+// Average number of distinct cache lines a probe looks at, following the same path as dir_probe.
+double
+lines_per_probe(Vol *vol, const std::vector<CacheKey> &keys)
+{
+  size_t total = 0;
+  for (auto const &key : keys) {
+    std::set<uintptr_t> lines;
+    int s          = key.slice32(0) % vol->segments;
+    int b          = key.slice32(1) % vol->buckets;
+    unsigned int t = DIR_MASK_TAG(key.slice32(2));
+    Dir *seg       = vol->dir_segment(s);
+    bool walk      = true;
+    if (vol->tag_index) {
+      const uint16_t *row = vol->tag_index + (s * vol->buckets + b) * DIR_DEPTH;
+      add_lines(lines, row, DIR_DEPTH * sizeof(uint16_t));
+      walk = (row[0] & DIR_TAG_INDEX_OVERFLOW) != 0;
+      for (int i = 0; i < DIR_DEPTH && !walk; i++) {
+        walk = row[i] == (DIR_TAG_INDEX_USED | t);
+      }
+    }
+    for (Dir *e = walk ? dir_bucket(b, seg) : nullptr; e; e = next_dir(e, seg)) {
+      add_lines(lines, e, SIZEOF_DIR);
+      if (!dir_offset(e) || dir_tag(e) == t) {
+        break;
+      }
+    }
+    total += lines.size();
+  }
+  return static_cast<double>(total) / keys.size();
+}
+
+} // namespace
+
+TEST_CASE("cache directory probe", "[cache][dir]")
+{
+  std::printf("%10s %8s %22s %22s\n", "buckets", "layout", "cache lines per miss", "cache lines per hit");
+
+  for (int buckets : {1024, 4096, 16384}) {
+    std::mt19937_64 rng(buckets);
+    size_t n = SEGMENTS * buckets * DIR_DEPTH * DIR_LOAD;
+    std::vector<CacheKey> stored, hits, misses;
+    for (size_t i = 0; i < n; i++) {
+      stored.push_back(random_key(rng));
+    }
+    for (int i = 0; i < PROBES; i++) {
+      hits.push_back(stored[rng() % n]);
+      misses.push_back(random_key(rng));
+    }
+
+    BenchVol row(buckets, false);
+    BenchVol indexed(buckets, true);
+    SCOPED_MUTEX_LOCK(row_lock, row.vol.mutex, this_ethread());
+    SCOPED_MUTEX_LOCK(indexed_lock, indexed.vol.mutex, this_ethread());
+    fill(&row.vol, stored);
+    fill(&indexed.vol, stored);
+
+    // the tag index must never turn a hit into a miss
+    REQUIRE(probe_all(&row.vol, hits) == PROBES);
+    REQUIRE(probe_all(&indexed.vol, hits) == PROBES);
+    REQUIRE(probe_all(&row.vol, misses) == probe_all(&indexed.vol, misses));
+
+    std::printf("%10d %8s %22.2f %22.2f\n", buckets, "entries", lines_per_probe(&row.vol, misses),
+                lines_per_probe(&row.vol, hits));
+    std::printf("%10d %8s %22.2f %22.2f\n", buckets, "index", lines_per_probe(&indexed.vol, misses),
+                lines_per_probe(&indexed.vol, hits));
+
+    std::string suffix = " (" + std::to_string(buckets) + " buckets per segment)";
+    BENCHMARK("miss, entries" + suffix) { return probe_all(&row.vol, misses); };
+    BENCHMARK("miss, tag index" + suffix) { return probe_all(&indexed.vol, misses); };
+    BENCHMARK("hit, entries" + suffix) { return probe_all(&row.vol, hits); };
+    BENCHMARK("hit, tag index" + suffix) { return probe_all(&indexed.vol, hits); };
+  }
+}
+
+struct EventProcessorListener : Catch::TestEventListenerBase {
+  using TestEventListenerBase::TestEventListenerBase;
+
+  void
+  testRunStarting(Catch::TestRunInfo const &testRunInfo) override
+  {
+    Layout::create();
+    init_diags("", nullptr);
+    RecProcessInit(RECM_STAND_ALONE);
+    LibRecordsConfigInit();
+
+    ink_event_system_init(EVENT_SYSTEM_MODULE_PUBLIC_VERSION);
+    eventProcessor.start(1);
+
+    EThread *main_thread = new EThread;
+    main_thread->set_specific();
+
+    cache_rsb = RecAllocateRawStatBlock(static_cast<int>(cache_stat_count));
+    vol_rsb   = RecAllocateRawStatBlock(static_cast<int>(cache_stat_count));
+  }
+};
+
+CATCH_REGISTER_LISTENER(EventProcessorListener);
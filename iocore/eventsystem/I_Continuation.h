@@ -100,6 +100,34 @@ constexpr ContinuationHandler continuation_handler_void_ptr(std::nullptr_t)
   return static_cast<ContinuationHandler>(nullptr);
 }
 
+// The address of the function that calling handler fp on c runs, to name the handler with dladdr(). This depends
+// on the representation of member function pointers in the Itanium C++ ABI, the ARM variant keeps the virtual
+// flag in the adjustment instead of the pointer.
+//
+template <class C, typename T>
+inline const void *
+continuation_handler_address(const C *c, int (C::*fp)(int, T *))
+{
+  struct {
+    uintptr_t ptr;
+    ptrdiff_t adj;
+  } rep;
+  static_assert(sizeof(fp) == sizeof(rep), "unexpected member function pointer layout");
+  memcpy(&rep, &fp, sizeof(rep));
+#if defined(__arm__) || defined(__aarch64__)
+  bool is_virtual = rep.adj & 1;
+  rep.adj >>= 1;
+#else
+  bool is_virtual = rep.ptr & 1;
+  rep.ptr -= is_virtual;
+#endif
+  if (is_virtual) { // ptr is the offset of the function in the vtable
+    const char *vtable = *reinterpret_cast<const char *const *>(reinterpret_cast<const char *>(c) + rep.adj);
+    return *reinterpret_cast<const void *const *>(vtable + rep.ptr);
+  }
+  return reinterpret_cast<const void *>(rep.ptr);
+}
+
 class force_VFPT_to_top
 {
 public:
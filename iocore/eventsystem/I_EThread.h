@@ -95,7 +95,8 @@ public:
   {
   public:
     /** Called at the end of the event loop to block.
-        @a timeout is the maximum length of time (in ns) to block.
+        @a timeout is the maximum length of time (in ns) to block. The time spent blocked is added to
+        @c EThread::loop_wait_time.
     */
     virtual int waitForActivity(ink_hrtime timeout) = 0;
     /** Unblock.
@@ -366,7 +367,9 @@ public:
     int
     waitForActivity(ink_hrtime timeout) override
     {
-      _q.wait(Thread::get_hrtime() + timeout);
+      ink_hrtime start = Thread::get_hrtime_updated();
+      _q.wait(start + timeout);
+      this_ethread_ptr->loop_wait_time += Thread::get_hrtime_updated() - start;
       return 0;
     }
     void
@@ -460,6 +463,68 @@ public:
   {
     return const_cast<EventMetrics *>(++current > &metrics[N_EVENT_METRICS - 1] ? metrics : current); // cast to remove volatile
   }
+
+  /** Log-linear histogram of the loop time less @a loop_wait_time, since the thread started.
+      Bucket 0 counts the loops shorter than 16 microseconds, then each power of two is split in two
+      buckets, the last one counting everything from about 8 seconds up. Readers take differences.
+  */
+  static int const N_LOOP_BUCKETS = 40;
+  uint64_t loop_histogram[N_LOOP_BUCKETS] = {0};
+  /// Time spent waiting for activity in the current loop, the poll or the sleep of the tail handler.
+  ink_hrtime loop_wait_time = 0;
+
+  /// The bucket of @a loop_histogram for a loop time of @a t.
+  static int loop_bucket(ink_hrtime t);
+  /// The shortest loop time counted in @a bucket.
+  static ink_hrtime loop_bucket_floor(int bucket);
+
+  /// Time spent in the dispatches sampled for a continuation handler.
+  struct HandlerTime {
+    const void *_fn   = nullptr; ///< The handler function, the key of the entry.
+    const char *_name = nullptr; ///< The handler name, only known in debug builds.
+    int64_t _count    = 0;       ///< # of sampled dispatches.
+    ink_hrtime _total = 0;       ///< Time spent in the sampled dispatches.
+    ink_hrtime _max   = 0;       ///< Longest sampled dispatch.
+  };
+
+  /** The number of handlers timed in a thread.
+      This is an open addressed table on the handler address, the handlers that do not fit go in the
+      last entry, which has no handler.
+  */
+  static int const N_HANDLER_TIMES = 128;
+  HandlerTime handler_times[N_HANDLER_TIMES];
+
+  /** Charge the dispatch being sampled to @a to instead of @a from.
+      For continuations like the HTTP state machine that dispatch again internally, so the time goes
+      to the state instead of the common entry point. Nothing is done unless the dispatch is sampled
+      and was made to @a from on @a c.
+  */
+  template <class C, typename T>
+  void
+  dispatch_to(const C *c, int (C::*from)(int, T *), const void *to)
+  {
+    if (_sampled_fn != nullptr && _sampled_fn == continuation_handler_address(c, from)) {
+      _sampled_fn   = to;
+      _sampled_name = nullptr;
+    }
+  }
+
+  /** Start timing a dispatch to @a c on this thread if it is the one in
+      proxy.config.thread.handler_sample_rate to sample. Dispatches made while one is sampled are not.
+      @return The start time to give to end_dispatch(), 0 if the dispatch is not sampled.
+  */
+  ink_hrtime begin_dispatch(Continuation *c);
+  /// End the dispatch that begin_dispatch() returned @a start for.
+  void end_dispatch(ink_hrtime start);
+
+private:
+  /// Add the sampled dispatch that took @a t to its handler.
+  void record_dispatch(ink_hrtime t);
+
+  int _sample_countdown     = 0;       ///< Dispatches left until the next sample.
+  bool _sampling            = false;   ///< A dispatch is being sampled.
+  const void *_sampled_fn   = nullptr; ///< Handler of the dispatch being sampled.
+  const char *_sampled_name = nullptr; ///< Name of @a _sampled_fn, if known.
 };
 
 /**
@@ -481,3 +546,5 @@ operator new(size_t, ink_dummy_for_new *p)
 extern EThread *this_ethread();
 
 extern int thread_max_heartbeat_mseconds;
+extern int thread_timer_wheel;
+extern int thread_handler_sample_rate;
@@ -25,6 +25,7 @@
 
 #include "tscore/ink_platform.h"
 #include "I_Event.h"
+#include "I_TimerWheel.h"
 
 // <5ms, 10, 20, 40, 80, 160, 320, 640, 1280, 2560, 5120
 #define N_PQ_LIST 10
@@ -36,10 +37,16 @@ struct PriorityEventQueue {
   Que(Event, link) after[N_PQ_LIST];
   ink_hrtime last_check_time;
   uint32_t last_check_buckets;
+  /// The events are kept here instead of in the buckets, see proxy.config.thread.timer_wheel.
+  TimerWheel *wheel = nullptr;
 
   void
   enqueue(Event *e, ink_hrtime now)
   {
+    if (wheel) {
+      wheel->enqueue(e);
+      return;
+    }
     ink_hrtime t = e->timeout_at - now;
     int i        = 0;
     // equivalent but faster
@@ -88,6 +95,10 @@ struct PriorityEventQueue {
   void
   remove(Event *e)
   {
+    if (wheel) {
+      wheel->remove(e);
+      return;
+    }
     ink_assert(e->in_the_priority_queue);
     e->in_the_priority_queue = 0;
     after[e->in_heap].remove(e);
@@ -97,6 +108,9 @@ struct PriorityEventQueue {
   dequeue_ready(ink_hrtime t)
   {
     (void)t;
+    if (wheel) {
+      return wheel->dequeue_ready();
+    }
     Event *e = after[0].dequeue();
     if (e) {
       ink_assert(e->in_the_priority_queue);
@@ -110,6 +124,9 @@ struct PriorityEventQueue {
   ink_hrtime
   earliest_timeout()
   {
+    if (wheel) {
+      return wheel->earliest_timeout();
+    }
     for (int i = 0; i < N_PQ_LIST; i++) {
       if (after[i].head) {
         return last_check_time + (PQ_BUCKET_TIME(i) / 2);
@@ -118,5 +135,8 @@ struct PriorityEventQueue {
     return last_check_time + HRTIME_FOREVER;
   }
 
+  /// Keep the events in a timing wheel from now on, the queue must be empty.
+  void use_timer_wheel();
+
   PriorityEventQueue();
 };
@@ -24,8 +24,9 @@
 /****************************************************************************
 
   Protected Queue, a FIFO queue with the following functionality:
-  (1). Multiple threads could be simultaneously trying to enqueue
-       and dequeue. Hence the queue needs to be protected with mutex.
+  (1). Multiple threads could be simultaneously trying to enqueue,
+       only the owning thread dequeues. Enqueueing is wait free, it
+       is a single atomic exchange on the tail of the queue.
   (2). In case the queue is empty, dequeue() sleeps for a specified
        amount of time, or until a new element is inserted, whichever
        is earlier
@@ -36,6 +37,9 @@
 
 #include "tscore/ink_platform.h"
 #include "I_Event.h"
+
+#include <atomic>
+
 struct ProtectedQueue {
   void enqueue(Event *e);
   void signal();
@@ -44,8 +48,18 @@ struct ProtectedQueue {
   Event *dequeue_local();
   void dequeue_external();       // Dequeue any external events.
   void wait(ink_hrtime timeout); // Wait for @a timeout nanoseconds on a condition variable if there are no events.
+  bool empty_external() const;   // Called from the same thread, true if no external events are queued.
+  void push(Event *e);           // Append to the external events, from any thread.
+  Event *pop();                  // Take the oldest external event, from the same thread.
+
+  /// The external events, an intrusive MPSC list through @c Event::link.next with @a stub as a sentinel.
+  /// Producers swap themselves in at @a tail, the owning thread pops at @a head.
+  std::atomic<Event *> tail;
+  Event *head;
+  Event stub;
+  /// Set by the first producer after the owning thread drained the queue, the others do not signal.
+  std::atomic<bool> signalled{false};
 
-  InkAtomicList al;
   ink_mutex lock;
   ink_cond might_have_data;
   Que(Event, link) localQueue;
@@ -50,6 +50,13 @@
 #endif
 #endif
 
+#if !HAVE_RECVMMSG
+struct mmsghdr {
+  struct msghdr msg_hdr;
+  unsigned int msg_len;
+};
+#endif
+
 extern int net_config_poll_timeout;
 
 #define SOCKET int
@@ -75,6 +82,8 @@ int64_t read(int fd, void *buf, int len, void *pOLP = nullptr);
 int recv(int s, void *buf, int len, int flags);
 int recvfrom(int fd, void *buf, int size, int flags, struct sockaddr *addr, socklen_t *addrlen);
 int recvmsg(int fd, struct msghdr *m, int flags, void *pOLP = nullptr);
+// result is the number of messages or -errno, msg_len of each message is set to its length
+int recvmmsg(int fd, struct mmsghdr *m, unsigned int vlen, int flags);
 
 int64_t write(int fd, void *buf, int len, void *pOLP = nullptr);
 int64_t pwrite(int fd, void *buf, int len, off_t offset, char *tag = nullptr);
@@ -82,6 +91,8 @@ int64_t pwrite(int fd, void *buf, int len, off_t offset, char *tag = nullptr);
 int send(int fd, void *buf, int len, int flags);
 int sendto(int fd, void *buf, int len, int flags, struct sockaddr const *to, int tolen);
 int sendmsg(int fd, struct msghdr *m, int flags, void *pOLP = nullptr);
+// result is the number of messages sent or -errno if none was
+int sendmmsg(int fd, struct mmsghdr *m, unsigned int vlen, int flags);
 int64_t lseek(int fd, off_t offset, int whence);
 int fsync(int fildes);
 int poll(struct pollfd *fds, unsigned long nfds, int timeout);
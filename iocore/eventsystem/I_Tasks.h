@@ -26,13 +26,50 @@
 
 #include "I_EventSystem.h"
 
+#include <atomic>
+
 extern EventType ET_TASK;
+/// Send the immediate ET_TASK events to @c TasksProcessor::schedule_imm, see proxy.config.task_threads.work_stealing.
+extern int task_threads_work_stealing;
+
+struct TaskWorker;
 
 class TasksProcessor : public Processor
 {
 public:
   EventType register_event_type();
   int start(int task_threads, size_t stacksize = DEFAULT_STACKSIZE) override;
+
+  /** Call back @a c on the first task thread that is free.
+
+      The event is queued on this thread if it is a task thread, otherwise on the next task thread round
+      robin. A task thread that runs out of events takes them from the queues of the others, so a long
+      task only holds up the thread running it. The thread affinity of @a c is neither used nor set.
+  */
+  Event *schedule_imm(Continuation *c, int callback_event = EVENT_IMMEDIATE, void *cookie = nullptr);
+
+  /// Whether the immediate events for @a et go to @c schedule_imm.
+  bool
+  steals(EventType et) const
+  {
+    return _steal && et == ET_TASK;
+  }
+
+private:
+  static void init_worker(EThread *t);
+
+  bool wake(TaskWorker *w);
+  void wake_idle(TaskWorker *except);
+  Event *take(TaskWorker *w);
+  bool has_jobs();
+
+  std::atomic<TaskWorker *> _workers[MAX_THREADS_IN_EACH_TYPE] = {}; ///< By thread id, set when the thread starts.
+  int _n_workers                                                = 0;  ///< # of task threads.
+  std::atomic<int> _idle{0};                                          ///< # of workers about to sleep or sleeping.
+  std::atomic<unsigned> _next{0};
+  bool _steal = false;
+
+  friend struct TaskWorker;
 };
 
 extern TasksProcessor tasksProcessor;
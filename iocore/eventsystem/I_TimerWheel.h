@@ -0,0 +1,76 @@
+/** @file
+
+  Hierarchical timing wheel for the timed events of a thread
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include "tscore/ink_platform.h"
+#include "I_Event.h"
+
+// 1ms ticks, 5 levels of 64 slots reach 2^30 ticks, about 12 days
+#define TW_TICK HRTIME_MSECOND
+#define TW_BITS 6
+#define TW_SLOTS (1 << TW_BITS)
+#define TW_LEVELS 5
+// values of Event::in_heap for the events not in a slot
+#define TW_READY (TW_LEVELS * TW_SLOTS)
+#define TW_OVERFLOW (TW_READY + 1)
+
+class EThread;
+
+/**
+  Timed events in a hierarchical timing wheel.
+
+  An event goes in the slot of its tick on the lowest level whose range
+  covers it: level 0 has the next 64 ticks, level 1 the next 64 times 64
+  and so on. A slot of a higher level is only looked at when the time
+  reaches it, its events are then cascaded down to where they belong. So
+  inserting and removing are constant time, and checking costs nothing
+  for the events that are not due, however many there are.
+
+  Time only moves on to the ticks where some slot is due, found from the
+  bitmaps of the occupied slots. Events further out than the top level go
+  on an overflow list that is looked at whenever the top level moves on.
+
+  Events fire on the first tick at or after their timeout, where the
+  buckets of PriorityEventQueue may fire them up to 5ms early.
+*/
+struct TimerWheel {
+  Que(Event, link) slots[TW_LEVELS][TW_SLOTS];
+  uint64_t occupied[TW_LEVELS] = {0}; ///< A bit for each slot with events.
+  Que(Event, link) ready;             ///< Events that are due.
+  Que(Event, link) overflow;          ///< Events past the top level.
+  int64_t tick;                       ///< The last tick checked.
+
+  void enqueue(Event *e);
+  void remove(Event *e);
+  Event *dequeue_ready();
+  void check_ready(ink_hrtime now, EThread *t);
+  ink_hrtime earliest_timeout() const;
+
+  TimerWheel();
+
+private:
+  void _place(Event *e);
+  void _cascade(Que(Event, link) & q, EThread *t);
+  int64_t _next_tick() const;
+};
@@ -29,9 +29,22 @@ PriorityEventQueue::PriorityEventQueue()
   last_check_buckets = last_check_time / PQ_BUCKET_TIME(0);
 }
 
+void
+PriorityEventQueue::use_timer_wheel()
+{
+  for (int i = 0; i < N_PQ_LIST; i++) {
+    ink_assert(after[i].empty());
+  }
+  wheel = new TimerWheel();
+}
+
 void
 PriorityEventQueue::check_ready(ink_hrtime now, EThread *t)
 {
+  if (wheel) {
+    wheel->check_ready(now, t);
+    return;
+  }
   int i, j, k = 0;
   uint32_t check_buckets = static_cast<uint32_t>(now / PQ_BUCKET_TIME(0));
   uint32_t todo_buckets  = check_buckets ^ last_check_buckets;
@@ -34,12 +34,19 @@
 TS_INLINE
 ProtectedQueue::ProtectedQueue()
 {
-  Event e;
+  stub.link.next = nullptr;
+  head           = &stub;
+  tail           = &stub;
   ink_mutex_init(&lock);
-  ink_atomiclist_init(&al, "ProtectedQueue", (char *)&e.link.next - (char *)&e);
   ink_cond_init(&might_have_data);
 }
 
+TS_INLINE bool
+ProtectedQueue::empty_external() const
+{
+  return head == &stub && tail.load(std::memory_order_acquire) == &stub;
+}
+
 TS_INLINE void
 ProtectedQueue::signal()
 {
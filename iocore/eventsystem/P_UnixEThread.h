@@ -254,3 +254,27 @@ EThread::set_tail_handler(LoopTailHandler *handler)
 {
   ink_atomic_swap(&tail_cb, handler);
 }
+
+TS_INLINE ink_hrtime
+EThread::begin_dispatch(Continuation *c)
+{
+  if (thread_handler_sample_rate <= 0 || _sampling || --_sample_countdown > 0) {
+    return 0;
+  }
+  _sample_countdown = thread_handler_sample_rate;
+  _sampling         = true;
+  _sampled_fn       = continuation_handler_address(c, c->handler);
+#ifdef DEBUG
+  _sampled_name = c->handler_name;
+#endif
+  return ink_get_hrtime_internal();
+}
+
+TS_INLINE void
+EThread::end_dispatch(ink_hrtime start)
+{
+  if (start) {
+    record_dispatch(ink_get_hrtime_internal() - start);
+    _sampling = false;
+  }
+}
@@ -27,6 +27,7 @@
 
 #include "tscore/ink_align.h"
 #include "I_EventProcessor.h"
+#include "I_Tasks.h"
 
 const int LOAD_BALANCE_INTERVAL = 1;
 
@@ -129,6 +130,10 @@ EventProcessor::schedule(Event *e, EventType etype)
 TS_INLINE Event *
 EventProcessor::schedule_imm(Continuation *cont, EventType et, int callback_event, void *cookie)
 {
+  if (tasksProcessor.steals(et)) {
+    return tasksProcessor.schedule_imm(cont, callback_event, cookie);
+  }
+
   Event *e = eventAllocator.alloc();
 
   ink_assert(et < MAX_EVENT_TYPES);
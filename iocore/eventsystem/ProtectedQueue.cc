@@ -23,8 +23,11 @@
   @section details Details
 
   ProtectedQueue implements a FIFO queue with the following functionality:
-    -# Multiple threads could be simultaneously trying to enqueue and
-      dequeue. Hence the queue needs to be protected with mutex.
+    -# Multiple threads could be simultaneously trying to enqueue, only
+      the owning thread dequeues. The external events are an intrusive
+      multiple producer, single consumer list (D. Vyukov's). A producer
+      swaps itself in as the tail and then links the previous tail to
+      itself, it never waits or retries.
     -# In case the queue is empty, dequeue() sleeps for a specified amount
       of time, or until a new element is inserted, whichever is earlier.
 
@@ -43,15 +46,34 @@
 
 extern ClassAllocator<Event> eventAllocator;
 
+namespace
+{
+inline Event *
+next_of(Event *e)
+{
+  return __atomic_load_n(&e->link.next, __ATOMIC_ACQUIRE);
+}
+
+inline void
+set_next(Event *e, Event *next)
+{
+  __atomic_store_n(&e->link.next, next, __ATOMIC_RELEASE);
+}
+} // namespace
+
 void
 ProtectedQueue::enqueue(Event *e)
 {
   ink_assert(!e->in_the_prot_queue && !e->in_the_priority_queue);
   EThread *e_ethread   = e->ethread;
   e->in_the_prot_queue = 1;
-  bool was_empty       = (ink_atomiclist_push(&al, e) == nullptr);
+  push(e);
 
-  if (was_empty) {
+  // Pairs with the fence in dequeue_external(), either the drain sees e or this sees the flag cleared.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  // Only the first producer since the thread last drained the queue wakes it up,
+  // the thread takes everything queued by then in one go.
+  if (!signalled.load(std::memory_order_relaxed) && !signalled.exchange(true)) {
     EThread *inserting_thread = this_ethread();
     // queue e->ethread in the list of threads to be signalled
     // inserting_thread == 0 means it is not a regular EThread
@@ -62,17 +84,55 @@ ProtectedQueue::enqueue(Event *e)
 }
 
 void
-ProtectedQueue::dequeue_external()
+ProtectedQueue::push(Event *e)
+{
+  e->link.next = nullptr;
+  Event *prev  = tail.exchange(e, std::memory_order_acq_rel);
+  // Between the exchange and this the consumer sees the list cut short at prev, and
+  // stops there. The signal sent after this brings it back for the rest.
+  set_next(prev, e);
+}
+
+Event *
+ProtectedQueue::pop()
 {
-  Event *e = static_cast<Event *>(ink_atomiclist_popall(&al));
-  // invert the list, to preserve order
-  SLL<Event, Event::Link_link> l, t;
-  t.head = e;
-  while ((e = t.pop())) {
-    l.push(e);
+  Event *first = head;
+  Event *next  = next_of(first);
+  if (first == &stub) {
+    if (next == nullptr) {
+      return nullptr;
+    }
+    head  = next;
+    first = next;
+    next  = next_of(next);
+  }
+  if (next) {
+    head = next;
+    return first;
+  }
+  if (first != tail.load(std::memory_order_acquire)) {
+    return nullptr; // a producer is between its exchange and its link
   }
+  // first is the last one, the stub goes behind it so it can be taken off
+  push(&stub);
+  next = next_of(first);
+  if (next) {
+    head = next;
+    return first;
+  }
+  return nullptr;
+}
+
+void
+ProtectedQueue::dequeue_external()
+{
+  // cleared first, a producer that comes after is not seen by this drain and must signal
+  signalled.store(false, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  Event *e;
   // insert into localQueue
-  while ((e = l.pop())) {
+  while ((e = pop())) {
     if (!e->cancelled) {
       localQueue.enqueue(e);
     } else {
@@ -91,7 +151,7 @@ ProtectedQueue::wait(ink_hrtime timeout)
    *   - And then the Event Thread goes to sleep and waits for the wakeup signal of `EThread::might_have_data`,
    *   - The `EThread::lock` will be locked again when the Event Thread wakes up.
    */
-  if (INK_ATOMICLIST_EMPTY(al) && localQueue.empty()) {
+  if (empty_external() && localQueue.empty()) {
     timespec ts = ink_hrtime_to_timespec(timeout);
     ink_cond_timedwait(&might_have_data, &lock, &ts);
   }
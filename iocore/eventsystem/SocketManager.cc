@@ -60,6 +60,40 @@ accept4(int sockfd, struct sockaddr *addr, socklen_t *addrlen, int flags)
 }
 #endif
 
+#if !HAVE_RECVMMSG
+static int
+recvmmsg(int fd, struct mmsghdr *m, unsigned int vlen, int flags, struct timespec * /* timeout ATS_UNUSED */)
+{
+  unsigned int i;
+
+  for (i = 0; i < vlen; i++) {
+    ssize_t r = ::recvmsg(fd, &m[i].msg_hdr, flags);
+    if (r < 0) {
+      break;
+    }
+    m[i].msg_len = r;
+  }
+  return i ? static_cast<int>(i) : -1;
+}
+#endif
+
+#if !HAVE_SENDMMSG
+static int
+sendmmsg(int fd, struct mmsghdr *m, unsigned int vlen, int flags)
+{
+  unsigned int i;
+
+  for (i = 0; i < vlen; i++) {
+    ssize_t r = ::sendmsg(fd, &m[i].msg_hdr, flags);
+    if (r < 0) {
+      break;
+    }
+    m[i].msg_len = r;
+  }
+  return i ? static_cast<int>(i) : -1;
+}
+#endif
+
 int
 SocketManager::accept4(int s, struct sockaddr *addr, socklen_t *addrlen, int flags)
 {
@@ -73,6 +107,30 @@ SocketManager::accept4(int s, struct sockaddr *addr, socklen_t *addrlen, int fla
   return -errno;
 }
 
+int
+SocketManager::recvmmsg(int fd, struct mmsghdr *m, unsigned int vlen, int flags)
+{
+  int r;
+  do {
+    if (unlikely((r = ::recvmmsg(fd, m, vlen, flags, nullptr)) < 0)) {
+      r = -errno;
+    }
+  } while (r == -EINTR);
+  return r;
+}
+
+int
+SocketManager::sendmmsg(int fd, struct mmsghdr *m, unsigned int vlen, int flags)
+{
+  int r;
+  do {
+    if (unlikely((r = ::sendmmsg(fd, m, vlen, flags)) < 0)) {
+      r = -errno;
+    }
+  } while (r == -EINTR);
+  return r;
+}
+
 int
 SocketManager::ink_bind(int s, struct sockaddr const *name, int namelen, short Proto)
 {
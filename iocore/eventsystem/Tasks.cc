@@ -22,10 +22,163 @@
  */
 
 #include "I_Tasks.h"
+#include "P_EventSystem.h"
+
+#include <deque>
 
 // Globals
 EventType ET_TASK = ET_CALL;
 TasksProcessor tasksProcessor;
+int task_threads_work_stealing = 0;
+
+extern ClassAllocator<Event> eventAllocator;
+
+namespace
+{
+// How long the events waited in the queues and took to run, for each task thread.
+// proxy.process.task.<time>.<bucket>.thread.<n>, the bucket is the upper bound.
+enum {
+  TASK_QUEUE_WAIT,
+  TASK_RUN_TIME,
+  N_TASK_TIMES,
+};
+constexpr int N_TASK_BUCKETS                              = 7;
+constexpr ink_hrtime TASK_BUCKET_LIMIT[N_TASK_BUCKETS - 1] = {HRTIME_USECONDS(10), HRTIME_USECONDS(100), HRTIME_MSECONDS(1),
+                                                             HRTIME_MSECONDS(10), HRTIME_MSECONDS(100), HRTIME_SECOND};
+// Per thread, the histograms and then the # of events taken from other threads.
+constexpr int TASK_STOLEN       = N_TASK_TIMES * N_TASK_BUCKETS;
+constexpr int N_TASK_STATS      = TASK_STOLEN + 1;
+RecRawStatBlock *task_rsb       = nullptr;
+int task_stat_threads           = 0;
+thread_local TaskWorker *worker = nullptr;
+
+void
+register_task_stats(int n)
+{
+  static const char *times[N_TASK_TIMES]     = {"queue_wait", "run_time"};
+  static const char *buckets[N_TASK_BUCKETS] = {"10us", "100us", "1ms", "10ms", "100ms", "1s", "long"};
+  char name[64];
+
+  if (n <= 0 || (task_rsb = RecAllocateRawStatBlock(n * N_TASK_STATS)) == nullptr) {
+    return;
+  }
+  for (int i = 0; i < n; i++) {
+    for (int t = 0; t < N_TASK_TIMES; t++) {
+      for (int b = 0; b < N_TASK_BUCKETS; b++) {
+        snprintf(name, sizeof(name), "proxy.process.task.%s.%s.thread.%d", times[t], buckets[b], i);
+        RecRegisterRawStat(task_rsb, RECT_PROCESS, name, RECD_INT, RECP_NON_PERSISTENT, i * N_TASK_STATS + t * N_TASK_BUCKETS + b,
+                           RecRawStatSyncSum);
+      }
+    }
+    snprintf(name, sizeof(name), "proxy.process.task.stolen.thread.%d", i);
+    RecRegisterRawStat(task_rsb, RECT_PROCESS, name, RECD_INT, RECP_NON_PERSISTENT, i * N_TASK_STATS + TASK_STOLEN,
+                       RecRawStatSyncSum);
+  }
+  task_stat_threads = n;
+}
+
+inline void
+count_task(EThread *t, int idx, int stat)
+{
+  if (task_rsb && idx < task_stat_threads) {
+    RecIncrRawStat(task_rsb, t, idx * N_TASK_STATS + stat, 1);
+  }
+}
+
+inline void
+count_task_time(EThread *t, int idx, int kind, ink_hrtime time)
+{
+  int b = 0;
+  while (b < N_TASK_BUCKETS - 1 && time >= TASK_BUCKET_LIMIT[b]) {
+    ++b;
+  }
+  count_task(t, idx, kind * N_TASK_BUCKETS + b);
+}
+} // namespace
+
+/** The task thread side of the pool.
+
+    It is the tail handler of its thread. Between the runs of the event loop it runs the events of its
+    own queue, then those it can take from the other queues, and sleeps when there are none.
+*/
+struct TaskWorker : public EThread::LoopTailHandler {
+  EThread *thread = nullptr;
+  int idx         = 0;
+
+  /// The queued events, the worker takes from the front and the others from the back. A leaf lock.
+  ink_mutex jobs_lock;
+  std::deque<Event *> jobs;
+
+  /// Held while deciding to sleep and while sleeping, and to wake the worker.
+  ink_mutex lock;
+  ink_cond ready;
+  bool sleeping = false;
+
+  explicit TaskWorker(EThread *t, int i) : thread(t), idx(i)
+  {
+    ink_mutex_init(&jobs_lock);
+    ink_mutex_init(&lock);
+    ink_cond_init(&ready);
+  }
+
+  /// Whether the thread has events for its event loop.
+  bool
+  has_events() const
+  {
+    return !thread->EventQueueExternal.empty_external() || !thread->EventQueueExternal.localQueue.empty();
+  }
+
+  void
+  run(Event *e, ink_hrtime now)
+  {
+    count_task_time(thread, idx, TASK_QUEUE_WAIT, now - e->timeout_at);
+    e->timeout_at = 0;
+    e->ethread    = thread;
+    thread->process_event(e, e->callback_event);
+    count_task_time(thread, idx, TASK_RUN_TIME, Thread::get_hrtime_updated() - now);
+  }
+
+  int
+  waitForActivity(ink_hrtime timeout) override
+  {
+    ink_hrtime now      = Thread::get_hrtime_updated();
+    ink_hrtime deadline = now + timeout;
+    Event *e;
+
+    // Back to the event loop as soon as it has something to do, one task runs at a time anyway.
+    while ((e = tasksProcessor.take(this)) != nullptr) {
+      run(e, now);
+      now = Thread::get_hrtime_updated();
+      if (now >= deadline || has_events()) {
+        return 0;
+      }
+    }
+    if (timeout <= 0) {
+      return 0;
+    }
+
+    // An event queued after the look above is either seen by the look below or queued by a
+    // thread that sees this one idle and wakes it up.
+    ink_mutex_acquire(&lock);
+    sleeping = true;
+    ++tasksProcessor._idle;
+    if (!tasksProcessor.has_jobs() && !has_events()) {
+      timespec ts = ink_hrtime_to_timespec(deadline);
+      ink_cond_timedwait(&ready, &lock, &ts);
+      thread->loop_wait_time += Thread::get_hrtime_updated() - now;
+    }
+    --tasksProcessor._idle;
+    sleeping = false;
+    ink_mutex_release(&lock);
+    return 0;
+  }
+
+  void
+  signalActivity() override
+  {
+    tasksProcessor.wake(this);
+  }
+};
 
 EventType
 TasksProcessor::register_event_type()
@@ -39,6 +192,132 @@ TasksProcessor::register_event_type()
 int
 TasksProcessor::start(int task_threads, size_t stacksize)
 {
-  eventProcessor.spawn_event_threads(ET_TASK, std::max(1, task_threads), stacksize);
+  int n = std::max(1, task_threads);
+
+  register_task_stats(n);
+  eventProcessor.schedule_spawn(&TasksProcessor::init_worker, ET_TASK);
+  // the workers show up as their threads start, the pool skips those that have not yet
+  _n_workers = n;
+  _steal     = task_threads_work_stealing != 0;
+  eventProcessor.spawn_event_threads(ET_TASK, n, stacksize);
   return 0;
 }
+
+void
+TasksProcessor::init_worker(EThread *t)
+{
+  worker = new TaskWorker(t, t->id);
+  t->set_tail_handler(worker);
+  tasksProcessor._workers[t->id].store(worker, std::memory_order_release);
+}
+
+Event *
+TasksProcessor::schedule_imm(Continuation *c, int callback_event, void *cookie)
+{
+  Event *e          = eventAllocator.alloc();
+  e->callback_event = callback_event;
+  e->cookie         = cookie;
+  e->init(c, 0, 0);
+
+  TaskWorker *w = worker;
+  for (int i = 0; w == nullptr && i < _n_workers; ++i) {
+    w = _workers[_next++ % _n_workers].load(std::memory_order_acquire);
+  }
+  if (w == nullptr) {
+    return eventProcessor.schedule(e, ET_TASK);
+  }
+
+  if (c->mutex) {
+    e->mutex = c->mutex;
+  }
+  e->ethread    = w->thread;
+  e->timeout_at = Thread::get_hrtime(); // when it was queued, until it runs
+  ink_mutex_acquire(&w->jobs_lock);
+  w->jobs.push_back(e);
+  ink_mutex_release(&w->jobs_lock);
+
+  // Pairs with the increment of _idle by a worker going to sleep.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if ((w == worker || !wake(w)) && _idle.load() > 0) {
+    wake_idle(w);
+  }
+  return e;
+}
+
+bool
+TasksProcessor::wake(TaskWorker *w)
+{
+  bool woken = false;
+  ink_mutex_acquire(&w->lock);
+  if (w->sleeping) {
+    w->sleeping = false;
+    ink_cond_signal(&w->ready);
+    woken = true;
+  }
+  ink_mutex_release(&w->lock);
+  return woken;
+}
+
+void
+TasksProcessor::wake_idle(TaskWorker *except)
+{
+  unsigned start = _next++;
+  for (int i = 0; i < _n_workers; ++i) {
+    TaskWorker *w = _workers[(start + i) % _n_workers].load(std::memory_order_acquire);
+    if (w != nullptr && w != except && wake(w)) {
+      return;
+    }
+  }
+}
+
+Event *
+TasksProcessor::take(TaskWorker *w)
+{
+  Event *e = nullptr;
+
+  ink_mutex_acquire(&w->jobs_lock);
+  if (!w->jobs.empty()) {
+    e = w->jobs.front();
+    w->jobs.pop_front();
+  }
+  ink_mutex_release(&w->jobs_lock);
+  if (e) {
+    return e;
+  }
+
+  // Steal the newest event of another worker, its own worker gets to the older ones first.
+  for (int i = 1; i < _n_workers && e == nullptr; ++i) {
+    TaskWorker *v = _workers[(w->idx + i) % _n_workers].load(std::memory_order_acquire);
+    if (v == nullptr) {
+      continue;
+    }
+    ink_mutex_acquire(&v->jobs_lock);
+    if (!v->jobs.empty()) {
+      e = v->jobs.back();
+      v->jobs.pop_back();
+    }
+    ink_mutex_release(&v->jobs_lock);
+  }
+  if (e) {
+    count_task(w->thread, w->idx, TASK_STOLEN);
+  }
+  return e;
+}
+
+bool
+TasksProcessor::has_jobs()
+{
+  for (int i = 0; i < _n_workers; ++i) {
+    TaskWorker *v = _workers[i].load(std::memory_order_acquire);
+    if (v == nullptr) {
+      continue;
+    }
+    ink_mutex_acquire(&v->jobs_lock);
+    bool found = !v->jobs.empty();
+    ink_mutex_release(&v->jobs_lock);
+    if (found) {
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,195 @@
+/** @file
+
+  Hierarchical timing wheel for the timed events of a thread
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_EventSystem.h"
+
+#define TW_SHIFT(_l) (TW_BITS * (_l))
+#define TW_MASK (TW_SLOTS - 1)
+
+namespace
+{
+// The number of steps from @a cur to the first bit set in @a bits after it, going round, 0 if none is.
+inline int64_t
+steps_to_next(uint64_t bits, int64_t cur)
+{
+  if (!bits) {
+    return 0;
+  }
+  int r = (cur + 1) & TW_MASK;
+  if (r) {
+    bits = (bits >> r) | (bits << (TW_SLOTS - r));
+  }
+  return __builtin_ctzll(bits) + 1;
+}
+} // namespace
+
+TimerWheel::TimerWheel()
+{
+  tick = Thread::get_hrtime_updated() / TW_TICK;
+}
+
+void
+TimerWheel::enqueue(Event *e)
+{
+  e->in_the_priority_queue = 1;
+  _place(e);
+}
+
+void
+TimerWheel::_place(Event *e)
+{
+  // rounded up, the event never fires before its timeout
+  int64_t t     = (e->timeout_at + TW_TICK - 1) / TW_TICK;
+  int64_t delta = t - tick;
+
+  if (delta <= 0) {
+    e->in_heap = TW_READY;
+    ready.enqueue(e);
+    return;
+  }
+  for (int l = 0; l < TW_LEVELS; l++) {
+    if (delta < (static_cast<int64_t>(1) << TW_SHIFT(l + 1))) {
+      int s      = (t >> TW_SHIFT(l)) & TW_MASK;
+      e->in_heap = l * TW_SLOTS + s;
+      slots[l][s].enqueue(e);
+      occupied[l] |= static_cast<uint64_t>(1) << s;
+      return;
+    }
+  }
+  e->in_heap = TW_OVERFLOW;
+  overflow.enqueue(e);
+}
+
+void
+TimerWheel::remove(Event *e)
+{
+  ink_assert(e->in_the_priority_queue);
+  e->in_the_priority_queue = 0;
+  if (e->in_heap == TW_READY) {
+    ready.remove(e);
+  } else if (e->in_heap == TW_OVERFLOW) {
+    overflow.remove(e);
+  } else {
+    int l = e->in_heap / TW_SLOTS;
+    int s = e->in_heap % TW_SLOTS;
+    slots[l][s].remove(e);
+    if (!slots[l][s].head) {
+      occupied[l] &= ~(static_cast<uint64_t>(1) << s);
+    }
+  }
+}
+
+Event *
+TimerWheel::dequeue_ready()
+{
+  Event *e = ready.dequeue();
+  if (e) {
+    ink_assert(e->in_the_priority_queue);
+    e->in_the_priority_queue = 0;
+  }
+  return e;
+}
+
+void
+TimerWheel::_cascade(Que(Event, link) & q, EThread *t)
+{
+  Que(Event, link) moved = q;
+  Event *e;
+
+  q.clear();
+  while ((e = moved.dequeue()) != nullptr) {
+    if (e->cancelled) {
+      e->in_the_priority_queue = 0;
+      e->cancelled             = 0;
+      EVENT_FREE(e, eventAllocator, t);
+    } else {
+      _place(e);
+    }
+  }
+}
+
+int64_t
+TimerWheel::_next_tick() const
+{
+  int64_t next = INT64_MAX;
+
+  // a slot of level l is due when the time reaches its index there, with the lower bits 0
+  for (int l = 0; l < TW_LEVELS; l++) {
+    int64_t cur = tick >> TW_SHIFT(l);
+    int64_t d   = steps_to_next(occupied[l], cur);
+    if (d) {
+      next = std::min(next, (cur + d) << TW_SHIFT(l));
+    }
+  }
+  if (overflow.head) {
+    next = std::min(next, ((tick >> TW_SHIFT(TW_LEVELS - 1)) + 1) << TW_SHIFT(TW_LEVELS - 1));
+  }
+  return next;
+}
+
+void
+TimerWheel::check_ready(ink_hrtime now, EThread *t)
+{
+  int64_t target = now / TW_TICK;
+
+  while (tick < target) {
+    int64_t next = _next_tick();
+    if (next > target) {
+      tick = target;
+      break;
+    }
+    tick = next;
+
+    // the higher levels whose slot starts now, then the slot of this tick
+    for (int l = TW_LEVELS - 1; l > 0; l--) {
+      if ((tick & ((static_cast<int64_t>(1) << TW_SHIFT(l)) - 1)) == 0) {
+        int s = (tick >> TW_SHIFT(l)) & TW_MASK;
+        if (l == TW_LEVELS - 1 && overflow.head) {
+          _cascade(overflow, t);
+        }
+        if (occupied[l] & (static_cast<uint64_t>(1) << s)) {
+          occupied[l] &= ~(static_cast<uint64_t>(1) << s);
+          _cascade(slots[l][s], t);
+        }
+      }
+    }
+    int s = tick & TW_MASK;
+    if (occupied[0] & (static_cast<uint64_t>(1) << s)) {
+      occupied[0] &= ~(static_cast<uint64_t>(1) << s);
+      _cascade(slots[0][s], t);
+    }
+  }
+}
+
+ink_hrtime
+TimerWheel::earliest_timeout() const
+{
+  if (ready.head) {
+    return tick * TW_TICK;
+  }
+  int64_t next = _next_tick();
+  if (next == INT64_MAX) {
+    return tick * TW_TICK + HRTIME_FOREVER;
+  }
+  return next * TW_TICK;
+}
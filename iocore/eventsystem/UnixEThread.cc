@@ -50,6 +50,8 @@ char const *const EThread::STAT_NAME[] = {"proxy.process.eventloop.count",
 int const EThread::SAMPLE_COUNT[N_EVENT_TIMESCALES] = {10, 100, 1000};
 
 int thread_max_heartbeat_mseconds = THREAD_MAX_HEARTBEAT_MSECONDS;
+int thread_timer_wheel            = 0;
+int thread_handler_sample_rate    = 0;
 
 // To define a class inherits from Thread:
 //   1) Define an independent thread_local static member
@@ -150,7 +152,10 @@ EThread::process_event(Event *e, int calling_code)
     // Restore the client IP debugging flags
     set_cont_flags(e->continuation->control_flags);
 
+    // Time one dispatch in thread_handler_sample_rate and charge it to the handler.
+    ink_hrtime sample_start = begin_dispatch(e->continuation);
     e->continuation->handleEvent(calling_code, e);
+    end_dispatch(sample_start);
     ink_assert(!e->in_the_priority_queue);
     ink_assert(c_temp == e->continuation);
     MUTEX_RELEASE(lock);
@@ -224,11 +229,17 @@ EThread::execute_regular()
   // A statically initialized instance we can use as a prototype for initializing other instances.
   static EventMetrics METRIC_INIT;
 
+  // nothing is in the queue before the loop runs
+  if (thread_timer_wheel && !EventQueue.wheel) {
+    EventQueue.use_timer_wheel();
+  }
+
   // give priority to immediate events
   while (!TSSystemState::is_event_system_shut_down()) {
     loop_start_time = Thread::get_hrtime_updated();
     nq_count        = 0; // count # of elements put on negative queue.
     ev_count        = 0; // # of events handled.
+    loop_wait_time  = 0;
 
     current_metric = metrics + (loop_start_time / HRTIME_SECOND) % N_EVENT_METRICS;
     if (current_metric != prev_metric) {
@@ -301,6 +312,8 @@ EThread::execute_regular()
       if (delta < current_metric->_loop_time._min) {
         current_metric->_loop_time._min = delta;
       }
+      // the histogram shows the time spent working, idle threads would only add their sleeps
+      ++loop_histogram[loop_bucket(std::max<ink_hrtime>(delta - loop_wait_time, 0))];
     }
     if (ev_count < current_metric->_events._min) {
       current_metric->_events._min = ev_count;
@@ -360,6 +373,59 @@ EThread::execute()
   // coverity[missing_unlock]
 }
 
+void
+EThread::record_dispatch(ink_hrtime t)
+{
+  static int const N_SLOTS = N_HANDLER_TIMES - 1; // the last entry takes the overflow
+  HandlerTime *h           = &handler_times[N_SLOTS];
+
+  if (_sampled_fn) {
+    int slot = (reinterpret_cast<uintptr_t>(_sampled_fn) >> 4) % N_SLOTS;
+    for (int probe = 0; probe < N_SLOTS; ++probe, slot = (slot + 1) % N_SLOTS) {
+      if (handler_times[slot]._fn == _sampled_fn) {
+        h = &handler_times[slot];
+        break;
+      } else if (handler_times[slot]._fn == nullptr) {
+        h        = &handler_times[slot];
+        h->_name = _sampled_name;
+        h->_fn   = _sampled_fn;
+        break;
+      }
+    }
+  }
+
+  ++h->_count;
+  h->_total += t;
+  if (t > h->_max) {
+    h->_max = t;
+  }
+  _sampled_fn   = nullptr;
+  _sampled_name = nullptr;
+}
+
+int
+EThread::loop_bucket(ink_hrtime t)
+{
+  uint64_t usec = t / HRTIME_USECOND;
+  if (usec < 16) {
+    return 0;
+  }
+  // two buckets per power of two, the bit under the top one picks the half
+  int msb    = 63 - __builtin_clzll(usec);
+  int bucket = 1 + (msb - 4) * 2 + ((usec >> (msb - 1)) & 1);
+  return std::min(bucket, N_LOOP_BUCKETS - 1);
+}
+
+ink_hrtime
+EThread::loop_bucket_floor(int bucket)
+{
+  if (bucket <= 0) {
+    return 0;
+  }
+  int msb = 4 + (bucket - 1) / 2;
+  return (HRTIME_USECOND << msb) + ((bucket - 1) % 2) * (HRTIME_USECOND << (msb - 1));
+}
+
 EThread::EventMetrics &
 EThread::EventMetrics::operator+=(EventMetrics const &that)
 {
@@ -33,6 +33,12 @@
 #include "tscore/ink_hw.h"
 #include "tscore/hugepages.h"
 
+#include <dlfcn.h>
+#include <cxxabi.h>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
 /// Global singleton.
 class EventProcessor eventProcessor;
 
@@ -120,6 +126,140 @@ EventMetricStatSync(const char *, RecDataT, RecData *, RecRawStatBlock *rsb, int
   return REC_ERR_OKAY;
 }
 
+/// Loop time percentiles over the last stat sync period, in tenths of a percent.
+struct {
+  int permille;
+  const char *name;
+} const LOOP_PERCENTILES[] = {{500, "p50"}, {900, "p90"}, {990, "p99"}, {999, "p999"}};
+int const N_LOOP_PERCENTILES = countof(LOOP_PERCENTILES);
+
+/// # of handlers reported, the ones with the most sampled time.
+int const N_HANDLER_RANKS = 10;
+
+/** Stats of the loop time histogram and the handler times, in the order of the block.
+    The histogram buckets, then the percentiles, then count, time and max of each handler rank.
+*/
+int const HANDLER_STAT_BASE   = EThread::N_LOOP_BUCKETS + N_LOOP_PERCENTILES;
+int const N_LOOP_TIME_STATS   = HANDLER_STAT_BASE + 3 * N_HANDLER_RANKS;
+char const HANDLER_STAT_FMT[] = "proxy.process.eventloop.handler.%d.%s";
+
+void
+set_raw_stat(RecRawStatBlock *rsb, int id, int64_t value)
+{
+  rsb->global[id]->sum   = value;
+  rsb->global[id]->count = 1;
+  RecRawStatUpdateSum(rsb, id);
+}
+
+/// Name the handler of @a h in @a buf.
+void
+handler_symbol(const EThread::HandlerTime &h, char *buf, size_t size)
+{
+  const void *fn = h._fn;
+  Dl_info info;
+
+  if (fn == nullptr) {
+    ink_strlcpy(buf, "(other)", size);
+  } else if (h._name) {
+    ink_strlcpy(buf, h._name, size);
+  } else if (dladdr(const_cast<void *>(fn), &info) && info.dli_sname) {
+    int status;
+    char *name = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+    if (info.dli_saddr == fn) {
+      ink_strlcpy(buf, name ? name : info.dli_sname, size);
+    } else { // a local function, past the symbol found
+      snprintf(buf, size, "%s+%#tx", name ? name : info.dli_sname,
+               static_cast<const char *>(fn) - static_cast<const char *>(info.dli_saddr));
+    }
+    free(name);
+  } else {
+    snprintf(buf, size, "%p", fn);
+  }
+}
+
+int
+EventLoopTimeStatSync(const char *, RecDataT, RecData *, RecRawStatBlock *rsb, int)
+{
+  static uint64_t prior[EThread::N_LOOP_BUCKETS]; // totals at the previous sync
+  uint64_t totals[EThread::N_LOOP_BUCKETS] = {0};
+  uint64_t recent[EThread::N_LOOP_BUCKETS];
+  uint64_t n_recent = 0;
+  ink_hrtime percentile[N_LOOP_PERCENTILES];
+
+  for (EThread *t : eventProcessor.active_group_threads(ET_CALL)) {
+    for (int b = 0; b < EThread::N_LOOP_BUCKETS; ++b) {
+      totals[b] += t->loop_histogram[b];
+    }
+  }
+  for (int b = 0; b < EThread::N_LOOP_BUCKETS; ++b) {
+    recent[b] = totals[b] - prior[b];
+    prior[b]  = totals[b];
+    n_recent += recent[b];
+  }
+
+  // Report the top of the bucket, the loops at the percentile took at most that long.
+  for (int p = 0; p < N_LOOP_PERCENTILES; ++p) {
+    uint64_t rank = (n_recent * LOOP_PERCENTILES[p].permille + 999) / 1000;
+    uint64_t seen = recent[0];
+    int b         = 0;
+    while (seen < rank && b < EThread::N_LOOP_BUCKETS - 1) {
+      seen += recent[++b];
+    }
+    percentile[p] = n_recent ? EThread::loop_bucket_floor(std::min(b + 1, EThread::N_LOOP_BUCKETS - 1)) : 0;
+  }
+
+  // The same handler runs on many threads, sum them up before ranking.
+  std::unordered_map<const void *, EThread::HandlerTime> handlers;
+  for (int i = 0; i < eventProcessor.n_ethreads; ++i) {
+    for (const EThread::HandlerTime &h : eventProcessor.all_ethreads[i]->handler_times) {
+      const void *fn = h._fn; // the owning thread may be filling in the entry
+      if (h._count) {
+        EThread::HandlerTime &sum = handlers[fn];
+        sum._fn                   = fn;
+        sum._name                 = sum._name ? sum._name : h._name;
+        sum._count += h._count;
+        sum._total += h._total;
+        sum._max = std::max(sum._max, h._max);
+      }
+    }
+  }
+  std::vector<EThread::HandlerTime> ranked;
+  ranked.reserve(handlers.size());
+  for (const auto &entry : handlers) {
+    ranked.push_back(entry.second);
+  }
+  int n_ranked = std::min(static_cast<int>(ranked.size()), N_HANDLER_RANKS);
+  std::partial_sort(ranked.begin(), ranked.begin() + n_ranked, ranked.end(),
+                    [](const EThread::HandlerTime &lhs, const EThread::HandlerTime &rhs) { return lhs._total > rhs._total; });
+
+  ink_mutex_acquire(&(rsb->mutex));
+  for (int b = 0; b < EThread::N_LOOP_BUCKETS; ++b) {
+    set_raw_stat(rsb, b, totals[b]);
+  }
+  for (int p = 0; p < N_LOOP_PERCENTILES; ++p) {
+    set_raw_stat(rsb, EThread::N_LOOP_BUCKETS + p, percentile[p]);
+  }
+  for (int r = 0; r < N_HANDLER_RANKS; ++r) {
+    EThread::HandlerTime h = r < n_ranked ? ranked[r] : EThread::HandlerTime();
+    set_raw_stat(rsb, HANDLER_STAT_BASE + 3 * r, h._count);
+    set_raw_stat(rsb, HANDLER_STAT_BASE + 3 * r + 1, h._total);
+    set_raw_stat(rsb, HANDLER_STAT_BASE + 3 * r + 2, h._max);
+  }
+  ink_mutex_release(&(rsb->mutex));
+
+  for (int r = 0; r < N_HANDLER_RANKS; ++r) {
+    char name[256];
+    char symbol[256] = "";
+    if (r < n_ranked) {
+      handler_symbol(ranked[r], symbol, sizeof(symbol));
+    }
+    snprintf(name, sizeof(name), HANDLER_STAT_FMT, r, "name");
+    RecSetRecordString(name, symbol, REC_SOURCE_DEFAULT);
+  }
+
+  return REC_ERR_OKAY;
+}
+
 /// This is a wrapper used to convert a static function into a continuation. The function pointer is
 /// passed in the cookie. For this reason the class is used as a singleton.
 /// @internal This is the implementation for @c schedule_spawn... overloads.
@@ -499,6 +639,28 @@ EventProcessor::start(int n_event_threads, size_t stacksize)
   // Name must be that of a stat, pick one at random since we do all of them in one pass/callback.
   RecRegisterRawStatSyncCb(name, EventMetricStatSync, rsb, 0);
 
+  // The loop time histogram and the handler times, also done in one callback.
+  rsb = RecAllocateRawStatBlock(N_LOOP_TIME_STATS);
+  for (int b = 0; b < EThread::N_LOOP_BUCKETS; ++b) {
+    snprintf(name, sizeof(name), "proxy.process.eventloop.time.hist.%" PRId64 "us", EThread::loop_bucket_floor(b) / HRTIME_USECOND);
+    RecRegisterRawStat(rsb, RECT_PROCESS, name, RECD_INT, RECP_NON_PERSISTENT, b, NULL);
+  }
+  for (int p = 0; p < N_LOOP_PERCENTILES; ++p) {
+    snprintf(name, sizeof(name), "proxy.process.eventloop.time.%s", LOOP_PERCENTILES[p].name);
+    RecRegisterRawStat(rsb, RECT_PROCESS, name, RECD_INT, RECP_NON_PERSISTENT, EThread::N_LOOP_BUCKETS + p, NULL);
+  }
+  for (int r = 0; r < N_HANDLER_RANKS; ++r) {
+    snprintf(name, sizeof(name), HANDLER_STAT_FMT, r, "name");
+    RecRegisterStatString(RECT_PROCESS, name, const_cast<char *>(""), RECP_NON_PERSISTENT);
+    snprintf(name, sizeof(name), HANDLER_STAT_FMT, r, "count");
+    RecRegisterRawStat(rsb, RECT_PROCESS, name, RECD_INT, RECP_NON_PERSISTENT, HANDLER_STAT_BASE + 3 * r, NULL);
+    snprintf(name, sizeof(name), HANDLER_STAT_FMT, r, "time");
+    RecRegisterRawStat(rsb, RECT_PROCESS, name, RECD_INT, RECP_NON_PERSISTENT, HANDLER_STAT_BASE + 3 * r + 1, NULL);
+    snprintf(name, sizeof(name), HANDLER_STAT_FMT, r, "max");
+    RecRegisterRawStat(rsb, RECT_PROCESS, name, RECD_INT, RECP_NON_PERSISTENT, HANDLER_STAT_BASE + 3 * r + 2, NULL);
+  }
+  RecRegisterRawStatSyncCb(name, EventLoopTimeStatSync, rsb, 0);
+
   this->spawn_event_threads(ET_CALL, n_event_threads, stacksize);
 
   Debug("iocore_thread", "Created event thread group id %d with %d threads", ET_CALL, n_event_threads);
@@ -0,0 +1,170 @@
+/** @file
+
+  Benchmark of the timed event queue, with buckets and with a timing wheel
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include "P_EventSystem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#define SPAN HRTIME_SECONDS(60)       // the timeouts are spread over this
+#define LOOP HRTIME_MSECONDS(1)       // how often the event loop checks the queue
+#define MIN_DELAY HRTIME_MSECONDS(10) // past the first bucket, which the buckets fire right away
+
+namespace
+{
+// N events pending in a queue, as an event thread would have them.
+struct BenchQueue {
+  PriorityEventQueue q;
+  std::vector<Event> events;
+  std::mt19937_64 rng;
+  ink_hrtime now;
+
+  BenchQueue(size_t n, bool wheel) : events(n), rng(n)
+  {
+    if (wheel) {
+      q.use_timer_wheel();
+    }
+    now = Thread::get_hrtime_updated();
+  }
+
+  ink_hrtime
+  random_timeout()
+  {
+    return now + MIN_DELAY + static_cast<ink_hrtime>(rng() % SPAN);
+  }
+
+  void
+  schedule_all()
+  {
+    for (auto &e : events) {
+      e.timeout_at = random_timeout();
+      q.enqueue(&e, now);
+    }
+  }
+
+  // Run the event loop until every event fired, return how many fired before their timeout.
+  size_t
+  fire_all()
+  {
+    size_t fired = 0;
+    size_t early = 0;
+    Event *e;
+    while (fired < events.size()) {
+      now += LOOP;
+      q.check_ready(now, nullptr);
+      while ((e = q.dequeue_ready(now)) != nullptr) {
+        early += e->timeout_at > now;
+        ++fired;
+      }
+    }
+    return early;
+  }
+
+  // One run of the event loop with all the events pending, those that fire are scheduled again.
+  int
+  loop()
+  {
+    int fired = 0;
+    Event *e;
+    now += LOOP;
+    q.check_ready(now, nullptr);
+    while ((e = q.dequeue_ready(now)) != nullptr) {
+      e->timeout_at = random_timeout();
+      q.enqueue(e, now);
+      ++fired;
+    }
+    return fired;
+  }
+};
+
+template <typename F>
+double
+per_second(size_t n, F &&f)
+{
+  auto start = std::chrono::steady_clock::now();
+  f();
+  std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+  return n / d.count();
+}
+
+const char *
+queue_name(bool wheel)
+{
+  return wheel ? "wheel" : "buckets";
+}
+
+} // namespace
+
+TEST_CASE("timed event queue", "[iocore][event]")
+{
+  std::printf("%10s %8s %16s %16s %16s\n", "events", "queue", "schedule/s", "cancel/s", "fire/s");
+
+  for (size_t n : {10000, 100000, 1000000}) {
+    for (bool wheel : {false, true}) {
+      auto b = std::make_unique<BenchQueue>(n, wheel);
+
+      double schedule = per_second(n, [&] { b->schedule_all(); });
+
+      std::vector<Event *> order;
+      for (auto &e : b->events) {
+        order.push_back(&e);
+      }
+      std::shuffle(order.begin(), order.end(), b->rng);
+      double cancel = per_second(n, [&] {
+        for (auto e : order) {
+          b->q.remove(e);
+        }
+      });
+      REQUIRE(std::none_of(b->events.begin(), b->events.end(), [](const Event &e) { return e.in_the_priority_queue; }));
+
+      b->schedule_all();
+      size_t early = 0;
+      double fire  = per_second(n, [&] { early = b->fire_all(); });
+      if (wheel) {
+        REQUIRE(early == 0);
+      }
+
+      std::printf("%10zu %8s %16.0f %16.0f %16.0f\n", n, queue_name(wheel), schedule, cancel, fire);
+    }
+  }
+}
+
+TEST_CASE("event loop with pending timeouts", "[iocore][event]")
+{
+  for (size_t n : {10000, 100000, 1000000}) {
+    for (bool wheel : {false, true}) {
+      auto b = std::make_unique<BenchQueue>(n, wheel);
+      b->schedule_all();
+      BENCHMARK("loop, " + std::to_string(n) + " pending, " + queue_name(wheel)) { return b->loop(); };
+    }
+  }
+}
@@ -0,0 +1,172 @@
+/** @file
+
+  Contention benchmark of the external event queue of a thread, with many producers
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include "P_EventSystem.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#define EVENTS_PER_RUN 1000000 // split between the producers
+
+namespace
+{
+// Counts the wakeups instead of sending them.
+struct CountingTailHandler : public EThread::LoopTailHandler {
+  std::atomic<int64_t> signals{0};
+
+  int
+  waitForActivity(ink_hrtime) override
+  {
+    return 0;
+  }
+
+  void
+  signalActivity() override
+  {
+    signals.fetch_add(1, std::memory_order_relaxed);
+  }
+};
+
+// The queue as it was, an InkAtomicList signalled on the push to an empty list.
+struct AtomicListQueue {
+  InkAtomicList al;
+  Que(Event, link) localQueue;
+
+  AtomicListQueue()
+  {
+    Event e;
+    ink_atomiclist_init(&al, "AtomicListQueue", (char *)&e.link.next - (char *)&e);
+  }
+
+  void
+  enqueue(Event *e)
+  {
+    e->in_the_prot_queue = 1;
+    if (ink_atomiclist_push(&al, e) == nullptr) {
+      e->ethread->tail_cb->signalActivity();
+    }
+  }
+
+  void
+  dequeue_external()
+  {
+    Event *e = static_cast<Event *>(ink_atomiclist_popall(&al));
+    SLL<Event, Event::Link_link> l, t;
+    t.head = e;
+    while ((e = t.pop())) {
+      l.push(e);
+    }
+    while ((e = l.pop())) {
+      localQueue.enqueue(e);
+    }
+  }
+
+  Event *
+  dequeue_local()
+  {
+    Event *e = localQueue.dequeue();
+    if (e) {
+      e->in_the_prot_queue = 0;
+    }
+    return e;
+  }
+};
+
+// P producers enqueue all their events while the owning thread drains the queue.
+template <typename Q>
+double
+run(Q &q, EThread *owner, int producers)
+{
+  int per_producer = EVENTS_PER_RUN / producers;
+  int total        = per_producer * producers;
+  std::vector<std::vector<Event>> events;
+  for (int p = 0; p < producers; ++p) {
+    events.emplace_back(per_producer);
+    for (auto &e : events.back()) {
+      e.ethread = owner;
+    }
+  }
+
+  std::atomic<bool> go{false};
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; ++p) {
+    threads.emplace_back([&, p] {
+      while (!go.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+      for (auto &e : events[p]) {
+        q.enqueue(&e);
+      }
+    });
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  go.store(true, std::memory_order_release);
+  int seen = 0;
+  while (seen < total) {
+    q.dequeue_external();
+    while (q.dequeue_local()) {
+      ++seen;
+    }
+  }
+  std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+
+  for (auto &t : threads) {
+    t.join();
+  }
+  return total / d.count();
+}
+
+} // namespace
+
+TEST_CASE("external event queue", "[iocore][event]")
+{
+  // never started, it only carries the tail handler
+  EThread *owner = new EThread();
+  CountingTailHandler counter;
+  owner->set_tail_handler(&counter);
+
+  std::printf("%10s %8s %16s %16s\n", "producers", "queue", "enqueue/s", "signals");
+
+  for (int producers : {2, 4, 8, 16, 32, 64, 128}) {
+    {
+      AtomicListQueue q;
+      counter.signals = 0;
+      double rate     = run(q, owner, producers);
+      std::printf("%10d %8s %16.0f %16ld\n", producers, "atomic", rate, static_cast<long>(counter.signals.load()));
+    }
+    {
+      ProtectedQueue q;
+      counter.signals = 0;
+      double rate     = run(q, owner, producers);
+      std::printf("%10d %8s %16.0f %16ld\n", producers, "mpsc", rate, static_cast<long>(counter.signals.load()));
+      REQUIRE(q.empty_external());
+    }
+  }
+}
@@ -110,3 +110,29 @@ TEST_CASE("ProxyAllocator", "[iocore]")
 
   delete bench_thread;
 }
+
+TEST_CASE("Allocator magazines", "[iocore]")
+{
+  int count = 64;
+
+  auto run = [&]() {
+    BItem *items[64];
+    for (int i = 0; i < count; i++) {
+      items[i] = ioAllocator.alloc();
+    }
+    for (int i = 0; i < count; i++) {
+      ioAllocator.free(items[i]);
+    }
+    return items[0];
+  };
+
+  int magazine_size = thread_magazine_size;
+
+  BENCHMARK("alloc free magazine") { return run(); };
+
+  // Blocks left in the magazine are still used, it is emptied on the next free.
+  thread_magazine_size = 0;
+  BENCHMARK("alloc free global pool") { return run(); };
+
+  thread_magazine_size = magazine_size;
+}
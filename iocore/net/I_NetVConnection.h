@@ -26,6 +26,7 @@
 #include "ProxyProtocol.h"
 #include "I_Net.h"
 
+#include <atomic>
 #include <string_view>
 #include <optional>
 
@@ -709,6 +710,78 @@ public:
   /** Attempt to push any changed options down */
   virtual void apply_options() = 0;
 
+  /** Move the data of the current read VIO to the socket of @a to without copying it.
+
+      Both VIOs must be set up. Until the read is done the read VIO counts
+      the bytes, but they never appear in its buffer, and the write VIO of
+      @a to sends them once its buffer is empty.
+
+      @return @c false if either side cannot be spliced, nothing changed.
+   */
+  virtual bool
+  splice_to(NetVConnection *to)
+  {
+    (void)to;
+    return false;
+  }
+
+  /** Limit the rate this connection sends at to @a rate bytes per second.
+
+      A negative @a rate follows the throughput the connection achieves,
+      0 stops pacing. The kernel paces where it can, the net thread
+      otherwise, see proxy.config.net.sock_pacing_rate_in.
+   */
+  virtual void
+  set_pacing_rate(int64_t rate)
+  {
+    (void)rate;
+  }
+
+  /// Whether sendfile_from() can be used, the socket takes file data without it passing through user space.
+  virtual bool
+  is_sendfile_capable() const
+  {
+    return false;
+  }
+
+  /** Send @a len bytes of the file @a fd from @a offset as part of the current write VIO.
+
+      The bytes are sent once the write buffer is empty and are counted by
+      the write VIO. The write VIO signals @c VC_EVENT_WRITE_READY when they
+      are sent, the file must stay open until then.
+
+      If the file is overwritten while the part is sent, @a clock counts the
+      writes to it and the part is valid while it is below @a limit. It is
+      checked before each send, once it is reached the rest of the part is
+      not sent and the write VIO signals @c VC_EVENT_ERROR.
+
+      @return @c false if a part is still pending or the VC cannot send files, nothing changed.
+   */
+  virtual bool
+  sendfile_from(int fd, off_t offset, int64_t len, const std::atomic<int64_t> *clock = nullptr, int64_t limit = 0)
+  {
+    (void)fd;
+    (void)offset;
+    (void)len;
+    (void)clock;
+    (void)limit;
+    return false;
+  }
+
+  /// Bytes given to sendfile_from() that are not sent yet.
+  virtual int64_t
+  sendfile_pending() const
+  {
+    return 0;
+  }
+
+  /// Bytes this connection sent with sendfile_from().
+  virtual int64_t
+  get_sendfile_bytes() const
+  {
+    return 0;
+  }
+
   //
   // Private
   //
@@ -57,6 +57,20 @@ public:
    */
   void append_block(IOBufferBlock *block);
 
+  /**
+     Add a datagram to a packet sent as several datagrams of the same
+     size with UDP segmentation offload (or one sendmmsg() where the
+     kernel cannot segment). Every datagram but the last must have the
+     size of the first one.
+
+     @param block the datagram, a single block.
+     @return false if the datagram cannot be added, the packet should
+     then be sent and another one started with it.
+   */
+  bool append_segment(IOBufferBlock *block);
+  /// Size of the datagrams of a segmented packet, 0 if the packet is a single datagram.
+  int getSegmentSize() const;
+
   IpEndpoint from; // what address came from
   IpEndpoint to;   // what address to send to
 
@@ -56,6 +56,22 @@ configure_net()
   // These are not reloadable
   REC_ReadConfigInteger(net_event_period, "proxy.config.net.event_period");
   REC_ReadConfigInteger(net_accept_period, "proxy.config.net.accept_period");
+  REC_ReadConfigInteger(net_config_io_uring_recv, "proxy.config.net.io_uring.recv");
+  REC_ReadConfigInteger(net_config_io_uring_recv_buffers, "proxy.config.net.io_uring.recv_buffers");
+  REC_ReadConfigInteger(net_config_io_uring_recv_buffer_size, "proxy.config.net.io_uring.recv_buffer_size");
+#if !TS_USE_LINUX_IO_URING_RECV
+  if (net_config_io_uring_recv) {
+    Warning("proxy.config.net.io_uring.recv is set but this build has no io_uring socket reads, reading sockets with epoll");
+    net_config_io_uring_recv = 0;
+  }
+#endif
+  REC_EstablishStaticConfigInt32(net_config_splice, "proxy.config.net.splice.enabled");
+  REC_ReadConfigInteger(net_config_splice_pipe_size, "proxy.config.net.splice.pipe_size");
+  REC_EstablishStaticConfigInt32(net_config_busy_poll_usec, "proxy.config.net.busy_poll.usec");
+  REC_ReadConfigInteger(net_config_busy_poll_epoll_usec, "proxy.config.net.busy_poll.epoll_usec");
+  REC_EstablishStaticConfigInt32(net_config_zerocopy, "proxy.config.net.zerocopy.enabled");
+  REC_EstablishStaticConfigInteger(net_config_zerocopy_min_size, "proxy.config.net.zerocopy.min_size");
+  REC_EstablishStaticConfigInt32(net_config_pacing_kernel, "proxy.config.net.pacing.kernel");
 
   // This is kinda fugly, but better than it was before (on every connection in and out)
   // Note that these would need to be ats_free()'d if we ever want to clean that up, but
@@ -95,6 +111,15 @@ register_net_stats()
     {"proxy.process.net.write_bytes", net_write_bytes_stat},
     {"proxy.process.net.fastopen_out.attempts", net_fastopen_attempts_stat},
     {"proxy.process.net.fastopen_out.successes", net_fastopen_successes_stat},
+    {"proxy.process.net.io_uring.recv_completions", net_io_uring_recv_stat},
+    {"proxy.process.net.splice.count", net_splice_count_stat},
+    {"proxy.process.net.splice.bytes", net_splice_bytes_stat},
+    {"proxy.process.net.sendfile.count", net_sendfile_count_stat},
+    {"proxy.process.net.sendfile.bytes", net_sendfile_bytes_stat},
+    {"proxy.process.net.zerocopy.bytes", net_zerocopy_bytes_stat},
+    {"proxy.process.net.zerocopy.copied_bytes", net_zerocopy_copied_bytes_stat},
+    {"proxy.process.net.pacing.connections", net_pacing_connections_stat},
+    {"proxy.process.net.pacing.deferred_writes", net_pacing_deferred_writes_stat},
     {"proxy.process.socks.connections_successful", socks_connections_successful_stat},
     {"proxy.process.socks.connections_unsuccessful", socks_connections_unsuccessful_stat},
   };
@@ -128,6 +153,15 @@ register_net_stats()
   NET_CLEAR_DYN_STAT(net_calls_to_writetonet_afterpoll_stat);
   NET_CLEAR_DYN_STAT(net_calls_to_write_stat);
   NET_CLEAR_DYN_STAT(net_calls_to_write_nodata_stat);
+  NET_CLEAR_DYN_STAT(net_io_uring_recv_stat);
+  NET_CLEAR_DYN_STAT(net_splice_count_stat);
+  NET_CLEAR_DYN_STAT(net_splice_bytes_stat);
+  NET_CLEAR_DYN_STAT(net_sendfile_count_stat);
+  NET_CLEAR_DYN_STAT(net_sendfile_bytes_stat);
+  NET_CLEAR_DYN_STAT(net_zerocopy_bytes_stat);
+  NET_CLEAR_DYN_STAT(net_zerocopy_copied_bytes_stat);
+  NET_CLEAR_DYN_STAT(net_pacing_connections_stat);
+  NET_CLEAR_DYN_STAT(net_pacing_deferred_writes_stat);
   NET_CLEAR_DYN_STAT(socks_connections_currently_open_stat);
   NET_CLEAR_DYN_STAT(keep_alive_queue_timeout_total_stat);
   NET_CLEAR_DYN_STAT(keep_alive_queue_timeout_count_stat);
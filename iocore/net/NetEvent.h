@@ -76,6 +76,7 @@ public:
   ink_hrtime next_inactivity_timeout_at = 0;
   ink_hrtime next_activity_timeout_at   = 0;
   ink_hrtime submit_time                = 0;
+  ink_hrtime paced_until                = 0; ///< When a write put off by pacing may go on.
 
   bool default_inactivity_timeout = false;
 
@@ -87,6 +88,7 @@ public:
   SLINKM(NetEvent, write, enable_link)
   LINK(NetEvent, keep_alive_queue_link);
   LINK(NetEvent, active_queue_link);
+  LINK(NetEvent, paced_link);
 
   /// Values for @a f.shutdown
   static constexpr unsigned SHUTDOWN_READ  = 1;
@@ -97,6 +99,8 @@ public:
     struct {
       unsigned int got_local_addr : 1;
       unsigned int shutdown : 2;
+      unsigned int recv_completions : 1; ///< Reads complete on the io_uring of the thread, not through epoll.
+      unsigned int zerocopy : 1;         ///< Sends complete on the error queue, reaped by the write path.
     } f;
   };
 };
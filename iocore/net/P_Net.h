@@ -59,6 +59,15 @@ enum Net_Stats {
   net_connections_throttled_in_stat,
   net_connections_throttled_out_stat,
   net_requests_max_throttled_in_stat,
+  net_io_uring_recv_stat,
+  net_splice_count_stat,
+  net_splice_bytes_stat,
+  net_sendfile_count_stat,
+  net_sendfile_bytes_stat,
+  net_zerocopy_bytes_stat,
+  net_zerocopy_copied_bytes_stat,
+  net_pacing_connections_stat,
+  net_pacing_deferred_writes_stat,
   Net_Stat_Count
 };
 
@@ -101,6 +110,10 @@ extern RecRawStatBlock *net_rsb;
 #include "P_UnixNetProcessor.h"
 #include "P_NetAccept.h"
 #include "P_UnixNetVConnection.h"
+#include "P_UnixNetIOUring.h"
+#include "P_UnixNetSplice.h"
+#include "P_UnixNetZeroCopy.h"
+#include "P_UnixNetPacing.h"
 #include "P_UnixPollDescriptor.h"
 #include "P_Socks.h"
 #include "P_CompletionUtil.h"
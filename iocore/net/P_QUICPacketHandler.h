@@ -43,6 +43,8 @@ public:
 
   void send_packet(const QUICPacket &packet, QUICNetVConnection *vc, const QUICPacketHeaderProtector &pn_protector);
   void send_packet(QUICNetVConnection *vc, const Ptr<IOBufferBlock> &udp_payload);
+  // Send datagrams to the peer of vc coalesced with UDPPacket::append_segment
+  void send_packet(QUICNetVConnection *vc, UDPPacket *udp_packet);
 
   void close_connection(QUICNetVConnection *conn);
 
@@ -50,6 +52,7 @@ protected:
   void _send_packet(const QUICPacket &packet, UDPConnection *udp_con, IpEndpoint &addr, uint32_t pmtu,
                     const QUICPacketHeaderProtector *ph_protector, int dcil);
   void _send_packet(UDPConnection *udp_con, IpEndpoint &addr, Ptr<IOBufferBlock> udp_payload);
+  void _send_packet(UDPConnection *udp_con, IpEndpoint &addr, UDPPacket *udp_packet);
   QUICConnection *_check_stateless_reset(const uint8_t *buf, size_t buf_len);
 
   // FIXME Remove this
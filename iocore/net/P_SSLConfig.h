@@ -115,6 +115,9 @@ struct SSLConfigParams : public ConfigInfo {
   static bool server_allow_early_data_params;
 
   static int ssl_maxrecord;
+  static int64_t ssl_dynamic_record_grow_bytes;
+  static int ssl_dynamic_record_grow_rtts;
+  static int ssl_dynamic_record_idle_msec;
   static int ssl_misc_max_iobuffer_size_index;
   static bool ssl_allow_client_renegotiation;
 
@@ -76,8 +76,6 @@
 // For larger records, the size is determined by TLS protocol record size
 #define SSL_DEF_TLS_RECORD_SIZE 1300  // 1500 - 40 (IP) - 20 (TCP) - 40 (TCP options) - TLS overhead (60-100)
 #define SSL_MAX_TLS_RECORD_SIZE 16383 // 2^14 - 1
-#define SSL_DEF_TLS_RECORD_BYTE_THRESHOLD 1000000
-#define SSL_DEF_TLS_RECORD_MSEC_THRESHOLD 1000
 
 struct SSLCertLookup;
 
@@ -128,6 +126,13 @@ public:
     return sslHandshakeStatus != SSL_HANDSHAKE_ONGOING;
   }
 
+  /// The socket carries TLS records.
+  bool
+  plainSocketIO() const override
+  {
+    return false;
+  }
+
   virtual void
   setSSLHandShakeComplete(enum SSLHandshakeStatus state)
   {
@@ -138,6 +143,8 @@ public:
   int sslClientHandShakeEvent(int &err);
   void net_read_io(NetHandler *nh, EThread *lthread) override;
   int64_t load_buffer_and_write(int64_t towrite, MIOBufferAccessor &buf, int64_t &total_written, int &needs) override;
+  bool is_sendfile_capable() const override;
+  int64_t sendfile_and_write(int fd, off_t offset, int64_t towrite) override;
   void do_io_close(int lerrno = -1) override;
 
   ////////////////////////////////////////////////////////////
@@ -447,6 +454,12 @@ private:
 
   int64_t redoWriteSize = 0;
 
+  /// Dynamic TLS record sizing, whether records grew to full size and since when small ones are written.
+  bool _full_records              = false;
+  ink_hrtime _small_records_since = 0;
+  /// When to look at the congestion window again, once per round trip.
+  ink_hrtime _window_check_at = 0;
+
   X509_STORE_CTX *verify_cert = nullptr;
 
   // Null-terminated string, or nullptr if there is no SNI server name.
@@ -470,6 +483,7 @@ private:
   int _ssl_read_from_net(EThread *lthread, int64_t &ret);
   ssl_error_t _ssl_read_buffer(void *buf, int64_t nbytes, int64_t &nread);
   ssl_error_t _ssl_write_buffer(const void *buf, int64_t nbytes, int64_t &nwritten);
+  uint32_t _dynamic_record_size(ink_hrtime now);
   ssl_error_t _ssl_connect();
   ssl_error_t _ssl_accept();
 };
@@ -46,6 +46,7 @@ public:
   bool binding_valid    = false;
   int tobedestroyed     = 0;
   int sendGenerationNum = 0;
+  bool gso_enabled      = false; // the kernel segments the packets sent on fd
 
   // this is for doing packet scheduling: we keep two values so that we can
   // implement cancel.  The first value tracks the startTime of the last
@@ -61,6 +61,13 @@ extern UDPNetProcessorInternal udpNetInternal;
 constexpr int UDP_PERIOD    = 9;
 constexpr int UDP_NH_PERIOD = UDP_PERIOD + 1;
 
+// Most datagrams read by one recvmmsg() or sent by one sendmmsg().
+constexpr int UDP_IO_BATCH_MAX = 64;
+
+extern int32_t g_udp_io_batch_size;
+extern int32_t g_udp_enable_gso;
+extern int32_t g_udp_enable_gro;
+
 class PacketQueue
 {
 public:
@@ -286,7 +293,7 @@ public:
   void service(UDPNetHandler *);
 
   void SendPackets();
-  void SendUDPPacket(UDPPacketInternal *p, int32_t pktLen);
+  void SendUDPPackets(UDPPacketInternal **p, int n);
 
   // Interface exported to the outside world
   void send(UDPPacket *p);
@@ -311,6 +318,8 @@ public:
   Que(UnixUDPConnection, link) open_list;
   // to be called back with data
   Que(UnixUDPConnection, callback_link) udp_callbacks;
+  // blocks of the next recvmmsg(), a block is only replaced when it is handed out in pieces
+  Ptr<IOBufferBlock> recv_blocks[UDP_IO_BATCH_MAX];
 
   Event *trigger_event = nullptr;
   EThread *thread      = nullptr;
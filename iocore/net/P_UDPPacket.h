@@ -32,6 +32,10 @@
 
 #include "I_UDPNet.h"
 
+// Limits of the kernel for a packet segmented with UDP_SEGMENT.
+constexpr int UDP_GSO_MAX_SEGMENTS = 64;
+constexpr int UDP_GSO_MAX_BYTES    = 65507;
+
 class UDPPacketInternal : public UDPPacket
 {
 public:
@@ -43,6 +47,8 @@ public:
   SLINK(UDPPacketInternal, alink); // atomic link
   // packet scheduling stuff: keep it a doubly linked list
   uint64_t pktLength = 0;
+  int segment_size   = 0; // datagram size of a segmented packet
+  int segments       = 0; // datagrams of a segmented packet, one block each
 
   int reqGenerationNum     = 0;
   ink_hrtime delivery_time = 0; // when to deliver packet
@@ -99,6 +105,37 @@ UDPPacket::append_block(IOBufferBlock *block)
   }
 }
 
+TS_INLINE bool
+UDPPacket::append_segment(IOBufferBlock *block)
+{
+  UDPPacketInternal *p = static_cast<UDPPacketInternal *>(this);
+  int64_t len          = block->read_avail();
+
+  ink_assert(block->next == nullptr);
+  if (!p->chain) {
+    p->segment_size = len;
+    p->segments     = 1;
+    p->chain        = block;
+    return true;
+  }
+  // only the last datagram may be shorter
+  int64_t total = getPktLength();
+  if (p->segments == 0 || len > p->segment_size || p->segments == UDP_GSO_MAX_SEGMENTS ||
+      total != static_cast<int64_t>(p->segments) * p->segment_size || total + len > UDP_GSO_MAX_BYTES) {
+    return false;
+  }
+  append_block(block);
+  p->segments++;
+  return true;
+}
+
+TS_INLINE int
+UDPPacket::getSegmentSize() const
+{
+  const UDPPacketInternal *p = static_cast<const UDPPacketInternal *>(this);
+  return p->segments > 1 ? p->segment_size : 0;
+}
+
 TS_INLINE int64_t
 UDPPacket::getPktLength() const
 {
@@ -23,7 +23,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <bitset>
+#include <vector>
 
 #include "tscore/ink_platform.h"
 
@@ -149,6 +151,7 @@ struct EventIO {
 
 class NetEvent;
 class NetHandler;
+class NetIOUring;
 typedef int (NetHandler::*NetContHandler)(int, void *);
 typedef unsigned int uint32;
 
@@ -161,6 +164,8 @@ extern int fds_throttle;
 extern int fds_limit;
 extern ink_hrtime last_transient_accept_error;
 extern int http_accept_port_number;
+extern int net_config_busy_poll_usec;
+extern int net_config_busy_poll_epoll_usec;
 
 //
 // Configuration Parameter had to move here to share
@@ -277,6 +282,27 @@ public:
   Que(NetEvent, active_queue_link) active_queue;
   uint32_t active_queue_size = 0;
 
+  /// Completion based reads, see P_UnixNetIOUring.h. Null unless proxy.config.net.io_uring.recv is set.
+  NetIOUring *uring = nullptr;
+
+  /// Continuations to call back before the next poll, see call_at_loop_tail().
+  std::vector<Continuation *> loop_tail_list;
+
+  /// Writes put off until the pacing of their connection allows more, see pace_write().
+  Que(NetEvent, paced_link) paced_list;
+
+  /** Busy polling, see proxy.config.net.busy_poll.usec.
+
+      While the thread spins, signalActivity() sets @a woken instead of
+      writing the event fd, the thread checks it between polls. It is
+      checked again once @a spinning is cleared, so a signal sent as the
+      thread stops spinning either sees it stopped or is seen by it.
+  */
+  std::atomic<bool> spinning{false};
+  std::atomic<bool> woken{false};
+  /// How long to spin before sleeping, grows while activity comes soon after going to sleep.
+  ink_hrtime busy_poll_budget = 0;
+
   /// configuration settings for managing the active and keep-alive queues
   struct Config {
     uint32_t max_connections_in                 = 0;
@@ -375,6 +401,27 @@ public:
    */
   void stopCop(NetEvent *ne);
 
+  /**
+    Call back @a c with NET_EVENT_LOOP_TAIL once, at the end of the current loop of this thread,
+    right before it polls. What the event handlers of the loop piled up, such as the frames of
+    several streams of a connection, is then handed to the net at once.
+    Only be called on the thread of this NetHandler, with the mutex of @a c held. A continuation
+    whose mutex cannot be taken then is called back in the next loop.
+
+    @param c Continuation to call back, not added twice by the caller.
+   */
+  void call_at_loop_tail(Continuation *c);
+  /// Forget @a c, to be called before @a c is freed.
+  void cancel_loop_tail(Continuation *c);
+
+  /** Put off the write of @a ne until @a until, its pacing allows nothing before.
+
+      The write is taken off the ready list and put back on it at @a until,
+      if it is still enabled and the socket writable. The poll waits no
+      longer than the earliest of these.
+   */
+  void pace_write(NetEvent *ne, ink_hrtime until);
+
   // Signal the epoll_wait to terminate.
   void signalActivity() override;
 
@@ -389,6 +436,12 @@ public:
 
 private:
   void _close_ne(NetEvent *ne, ink_hrtime now, int &handle_event, int &closed, int &total_idle_time, int &total_idle_count);
+  /// Poll the sockets, spinning first when busy polling.
+  void _poll(ink_hrtime timeout);
+  /// Call back the continuations of @c loop_tail_list.
+  void _process_loop_tail();
+  /// Put the writes of @c paced_list that are due back on the ready list, return when the next one is.
+  ink_hrtime _process_paced_list(ink_hrtime now);
 
   /// Static method used as the callback for runtime configuration updates.
   static int update_nethandler_config(const char *name, RecDataT, RecData data, void *);
@@ -848,7 +901,7 @@ NetHandler::startIO(NetEvent *ne)
   int res = 0;
 
   PollDescriptor *pd = get_PollDescriptor(this->thread);
-  if (ne->ep.start(pd, ne, EVENTIO_READ | EVENTIO_WRITE) < 0) {
+  if (ne->ep.start(pd, ne, ne->f.recv_completions ? EVENTIO_WRITE : EVENTIO_READ | EVENTIO_WRITE) < 0) {
     res = errno;
     // EEXIST should be ok, though it should have been cleared before we got back here
     if (errno != EEXIST) {
@@ -873,6 +926,9 @@ NetHandler::stopIO(NetEvent *ne)
 
   read_ready_list.remove(ne);
   write_ready_list.remove(ne);
+  if (paced_list.in(ne)) {
+    paced_list.remove(ne);
+  }
   if (ne->read.in_enabled_list) {
     read_enable_list.remove(ne);
     ne->read.in_enabled_list = 0;
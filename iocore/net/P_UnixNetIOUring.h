@@ -0,0 +1,121 @@
+/** @file
+
+  Completion based socket reads on the io_uring of a net thread
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include "tscore/ink_config.h"
+
+extern int net_config_io_uring_recv;
+extern int net_config_io_uring_recv_buffers;
+extern int net_config_io_uring_recv_buffer_size;
+
+#if TS_USE_LINUX_IO_URING_RECV
+
+#include "I_AIO.h"
+#include "I_IOBuffer.h"
+
+#include <vector>
+
+class UnixNetVConnection;
+
+/**
+  The provided buffer ring of a net thread.
+
+  Multishot receives pick a buffer from the ring for each completion. The
+  buffers are IOBufferData, so a completed buffer is handed to the VC as an
+  IOBufferBlock without a copy and a fresh buffer takes its place in the ring.
+*/
+class NetIOUring
+{
+public:
+  static constexpr int BUFFER_GROUP = 1;
+
+  explicit NetIOUring(DiskHandler *dh);
+  ~NetIOUring();
+
+  /// Whether the ring could be set up, if not reads stay on epoll.
+  bool
+  ok() const
+  {
+    return _br != nullptr;
+  }
+
+  /// A submission entry, submitted with the next poll of the thread.
+  io_uring_sqe *get_sqe();
+
+  /// Take the buffer @a bid that a receive of @a len bytes completed into.
+  IOBufferBlock *take_buffer(int bid, int len);
+
+private:
+  void _provide(int bid);
+
+  DiskHandler *_dh        = nullptr;
+  io_uring_buf_ring *_br  = nullptr;
+  unsigned _entries       = 0;
+  int64_t _size_index     = 0;
+  std::vector<Ptr<IOBufferData>> _buffers;
+};
+
+/**
+  A multishot receive on the socket of an inbound UnixNetVConnection.
+
+  Data is queued in @c pending as it completes, whether or not the VC is
+  reading, and read_from_net() moves it to the read VIO. Once more than
+  the pending limit is queued the receive is cancelled and re-armed as the
+  VC catches up, so a slow reader does not drain the buffer ring.
+
+  The object outlives its VC until the kernel is done with the receive,
+  see detach().
+*/
+class NetIOUringRecv : public IOUringCompletionHandler
+{
+public:
+  NetIOUringRecv(UnixNetVConnection *vc, NetIOUring *ctx);
+
+  /// Start receiving.
+  void arm();
+  /// The VC is going away, drop the data and free this once the receive is cancelled.
+  void detach();
+  /// Move up to @a len bytes to @a buf, returns like recv(): the byte count, 0 at EOS, -errno otherwise.
+  int64_t read(MIOBuffer *buf, int64_t len);
+
+  void handle_complete(io_uring_cqe *cqe) override;
+
+private:
+  ~NetIOUringRecv() override;
+
+  void _cancel();
+  void _signal();
+
+  UnixNetVConnection *_vc = nullptr;
+  NetIOUring *_ctx        = nullptr;
+  int _fd                 = -1;
+  MIOBuffer *_pending     = nullptr;
+  IOBufferReader *_reader = nullptr;
+  bool _armed             = false;
+  bool _cancelling        = false;
+  bool _eos               = false;
+  int _error              = 0;
+};
+
+#endif
@@ -0,0 +1,75 @@
+/** @file
+
+  Limit the rate a connection sends at, in the kernel or with a token bucket
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include "tscore/ink_platform.h"
+#include "tscore/ink_hrtime.h"
+
+extern int net_config_pacing_kernel;
+
+/**
+  The pacing rate of a connection.
+
+  The rate is set on the socket with SO_MAX_PACING_RATE where the kernel
+  has it, it then spaces the segments out itself. Otherwise, or with
+  proxy.config.net.pacing.kernel off, the write path takes its bytes from a
+  token bucket holding a couple of milliseconds of the rate, and a write
+  finding it empty is put off by the NetHandler until it has refilled.
+
+  An automatic rate follows what the connection can deliver, a congestion
+  window per round trip, with some headroom for the window to grow.
+*/
+struct NetPacing {
+  int64_t rate   = 0;     ///< Bytes per second, 0 until an automatic rate is probed.
+  bool automatic = false; ///< The rate follows the throughput of the connection.
+  bool in_kernel = false; ///< The kernel paces, SO_MAX_PACING_RATE is set on the socket.
+  bool no_kernel = false; ///< SO_MAX_PACING_RATE failed on the socket.
+
+  int64_t tokens       = 0; ///< Bytes that may be sent now, negative after sending more.
+  ink_hrtime filled_at = 0;
+  ink_hrtime probed_at = 0;
+
+  /// Pace @a fd at @a rate bytes per second, automatically if negative, stop if 0.
+  void set(int fd, int64_t rate);
+  /// The bytes that may be written to @a fd now, INT64_MAX unless paced here.
+  int64_t allowance(int fd, ink_hrtime now);
+  /// When a write put off for an empty bucket may go on.
+  ink_hrtime ready_at(ink_hrtime now) const;
+
+  void
+  sent(int64_t n)
+  {
+    tokens -= n;
+  }
+
+  bool
+  active() const
+  {
+    return rate > 0 || automatic;
+  }
+
+private:
+  void _apply(int fd, int64_t rate);
+  int64_t _burst() const;
+};
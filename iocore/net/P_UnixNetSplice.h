@@ -0,0 +1,56 @@
+/** @file
+
+  Zero copy transfers between two sockets of a net thread with splice(2)
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include "tscore/ink_platform.h"
+
+class UnixNetVConnection;
+
+extern int net_config_splice;
+extern int net_config_splice_pipe_size;
+
+/**
+  A pipe between the read VIO of @c src and the write VIO of @c dst.
+
+  Once a UnixNetVConnection is spliced to another, read_from_net() of the
+  source moves socket data into the pipe instead of its read buffer, and
+  write_to_net() of the destination moves it from the pipe to its socket
+  once its write buffer is empty. The VIOs count the bytes as usual, so
+  the continuation sees the same events without seeing the data.
+
+  Each side lets go with its VIO, the source when its read is done, so the
+  pipe still drains into the destination.
+*/
+struct NetSplice {
+  UnixNetVConnection *src = nullptr;
+  UnixNetVConnection *dst = nullptr;
+  int fd[2]               = {NO_FD, NO_FD};
+  int64_t size            = 0; ///< Capacity of the pipe.
+  int64_t bytes           = 0; ///< Bytes in the pipe.
+};
+
+/// A splice with a pipe of the thread's pool, nullptr if no pipe could be made.
+NetSplice *new_NetSplice();
+/// Free @a s once neither side uses it, an empty pipe goes back to the pool.
+void free_NetSplice(NetSplice *s);
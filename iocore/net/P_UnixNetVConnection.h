@@ -37,9 +37,13 @@
 #include "P_Connection.h"
 #include "P_NetAccept.h"
 #include "NetEvent.h"
+#include "P_UnixNetPacing.h"
 
 class UnixNetVConnection;
 class NetHandler;
+class NetIOUringRecv;
+struct NetSplice;
+struct NetZeroCopy;
 struct PollDescriptor;
 
 enum tcp_congestion_control_t { CLIENT_SIDE, SERVER_SIDE };
@@ -132,6 +136,13 @@ public:
     return (true);
   }
 
+  /// Whether the bytes on the socket are the bytes of the stream, so they may be received on io_uring or spliced.
+  virtual bool
+  plainSocketIO() const
+  {
+    return true;
+  }
+
   virtual bool
   trackFirstHandshake()
   {
@@ -178,6 +189,8 @@ public:
   }
 
   virtual int64_t load_buffer_and_write(int64_t towrite, MIOBufferAccessor &buf, int64_t &total_written, int &needs);
+  /// Send @a towrite bytes of the file @a fd at @a offset to the socket, the bytes sent or -errno.
+  virtual int64_t sendfile_and_write(int fd, off_t offset, int64_t towrite);
   void readDisable(NetHandler *nh);
   void readSignalError(NetHandler *nh, int err);
   int readSignalDone(int event, NetHandler *nh);
@@ -201,6 +214,30 @@ public:
   bool from_accept_thread  = false;
   NetAccept *accept_object = nullptr;
 
+  /// The receive armed when the thread reads sockets with io_uring, see P_UnixNetIOUring.h.
+  NetIOUringRecv *uring_recv = nullptr;
+  /// The pipe this reads into and the pipe this writes from when spliced, see P_UnixNetSplice.h.
+  NetSplice *splice_read  = nullptr;
+  NetSplice *splice_write = nullptr;
+
+  /// The file part to send once the write buffer is empty, see sendfile_from().
+  int sendfile_fd       = NO_FD;
+  off_t sendfile_offset = 0;
+  int64_t sendfile_len  = 0;
+  /// The writes to the file and the count at which the part may no longer be sent.
+  const std::atomic<int64_t> *sendfile_clock = nullptr;
+  int64_t sendfile_limit                     = 0;
+
+  /// Bytes sent and sendfile calls made on this connection.
+  int64_t sendfile_bytes = 0;
+  int64_t sendfile_calls = 0;
+
+  /// The MSG_ZEROCOPY sends the kernel may still read from, see P_UnixNetZeroCopy.h.
+  NetZeroCopy *zerocopy = nullptr;
+
+  /// The rate this sends at, see P_UnixNetPacing.h.
+  NetPacing pacing;
+
   int startEvent(int event, Event *e);
   int acceptEvent(int event, Event *e);
   int mainEvent(int event, Event *e);
@@ -212,6 +249,8 @@ public:
    */
   virtual int populate(Connection &con, Continuation *c, void *arg);
   virtual void clear();
+  /// Hand the MSG_ZEROCOPY sends over to the thread before closing the socket, which then stays open until they complete.
+  void free_zerocopy();
 
   ink_hrtime get_inactivity_timeout() override;
   ink_hrtime get_active_timeout() override;
@@ -222,6 +261,12 @@ public:
   void set_remote_addr(const sockaddr *) override;
   int set_tcp_congestion_control(int side) override;
   void apply_options() override;
+  bool splice_to(NetVConnection *to) override;
+  void set_pacing_rate(int64_t rate) override;
+  bool is_sendfile_capable() const override;
+  bool sendfile_from(int fd, off_t offset, int64_t len, const std::atomic<int64_t> *clock, int64_t limit) override;
+  int64_t sendfile_pending() const override;
+  int64_t get_sendfile_bytes() const override;
 
   friend void write_to_net_io(NetHandler *, UnixNetVConnection *, EThread *);
 
@@ -0,0 +1,89 @@
+/** @file
+
+  Transmit with MSG_ZEROCOPY, keeping the sent blocks until the kernel is done with them
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include "tscore/ink_platform.h"
+#include "I_IOBuffer.h"
+
+#include <deque>
+
+#if defined(linux) && defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+#define TS_HAS_ZEROCOPY 1
+#else
+#define TS_HAS_ZEROCOPY 0
+#endif
+
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0
+#endif
+
+extern int net_config_zerocopy;
+extern int64_t net_config_zerocopy_min_size;
+
+/**
+  The MSG_ZEROCOPY sends of a socket the kernel may still read from.
+
+  The kernel numbers the sendmsg() calls of a socket that sent bytes with
+  MSG_ZEROCOPY and reports ranges of numbers on the error queue of the socket
+  once it no longer needs their pages. Until then the sent part of the write
+  buffer is kept referenced here, the write VIO moves on as usual.
+
+  When the kernel reports it copied the data anyway, as it does for
+  loopback, the socket goes back to plain sends.
+*/
+struct NetZeroCopy {
+  struct Send {
+    uint32_t id;
+    int64_t len;
+    Ptr<IOBufferBlock> blocks;
+  };
+
+  std::deque<Send> sends;
+  uint32_t next_id = 0;
+  bool enabled     = false; ///< SO_ZEROCOPY is set on the socket.
+  bool off         = false; ///< The socket sends with copies, SO_ZEROCOPY failed or the kernel copied.
+
+  int fd                 = NO_FD; ///< The socket of a closed connection, kept open until its sends complete or it is reset.
+  ink_hrtime linger_till = 0;
+
+  /// Whether to send on @a fd with MSG_ZEROCOPY, SO_ZEROCOPY is set on the first call.
+  bool want(int fd);
+  /// Keep the @a len bytes sent from the start of @a reader until the kernel reports the send complete.
+  void sent(IOBufferReader *reader, int64_t len);
+  /// Release the sends reported complete on the error queue of @a fd.
+  void reap(int fd);
+
+  bool
+  pending() const
+  {
+    return !sends.empty();
+  }
+};
+
+/// A tracker for a socket, nullptr if MSG_ZEROCOPY is not available.
+NetZeroCopy *new_NetZeroCopy();
+/// Free @a zc, a socket with sends pending is closed by the thread once they complete.
+void free_NetZeroCopy(NetZeroCopy *zc, int fd);
+/// Reap the sockets of closed connections of this thread, called from the NetHandler loop.
+void net_zerocopy_reap_closed();
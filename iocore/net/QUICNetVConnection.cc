@@ -1486,6 +1486,8 @@ QUICNetVConnection::_state_common_send_packet()
 {
   uint32_t packet_count = 0;
   uint32_t error        = 0;
+  // datagrams of the same size go to the peer as one segmented UDP packet
+  UDPPacket *udp_packet = nullptr;
   while (error == 0 && packet_count < PACKET_PER_EVENT) {
     uint32_t window = this->_congestion_controller->credit();
 
@@ -1563,12 +1565,22 @@ QUICNetVConnection::_state_common_send_packet()
     }
 
     if (written) {
-      this->_packet_handler->send_packet(this, udp_payload);
+      if (udp_packet && !udp_packet->append_segment(udp_payload.get())) {
+        this->_packet_handler->send_packet(this, udp_packet);
+        udp_packet = nullptr;
+      }
+      if (udp_packet == nullptr) {
+        udp_packet = new_UDPPacket();
+        udp_packet->append_segment(udp_payload.get());
+      }
     } else {
       udp_payload->dealloc();
       break;
     }
   }
+  if (udp_packet) {
+    this->_packet_handler->send_packet(this, udp_packet);
+  }
 
   if (packet_count) {
     this->_context->trigger(QUICContext::CallbackEvent::METRICS_UPDATE, this->_congestion_controller->congestion_window(),
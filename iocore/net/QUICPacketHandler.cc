@@ -100,15 +100,23 @@ QUICPacketHandler::_send_packet(const QUICPacket &packet, UDPConnection *udp_con
 void
 QUICPacketHandler::_send_packet(UDPConnection *udp_con, IpEndpoint &addr, Ptr<IOBufferBlock> udp_payload)
 {
-  UDPPacket *udp_packet = new_UDPPacket(addr, 0, udp_payload);
+  this->_send_packet(udp_con, addr, new_UDPPacket(addr, 0, udp_payload));
+}
+
+void
+QUICPacketHandler::_send_packet(UDPConnection *udp_con, IpEndpoint &addr, UDPPacket *udp_packet)
+{
+  ats_ip_copy(&udp_packet->to, &addr);
 
   if (is_debug_tag_set(v_debug_tag)) {
     ip_port_text_buffer ipb;
     QUICConnectionId dcid = QUICConnectionId::ZERO();
     QUICConnectionId scid = QUICConnectionId::ZERO();
 
-    const uint8_t *buf = reinterpret_cast<uint8_t *>(udp_payload->buf());
-    uint64_t buf_len   = udp_payload->size();
+    // the first datagram of a segmented packet
+    IOBufferBlock *udp_payload = udp_packet->getIOBlockChain();
+    const uint8_t *buf         = reinterpret_cast<uint8_t *>(udp_payload->buf());
+    uint64_t buf_len           = udp_payload->size();
 
     if (!QUICInvariants::dcid(dcid, buf, buf_len)) {
       ink_assert(false);
@@ -120,8 +128,9 @@ QUICPacketHandler::_send_packet(UDPConnection *udp_con, IpEndpoint &addr, Ptr<IO
       }
     }
 
-    QUICVPHDebug(dcid, scid, "send %s packet to %s from port %u size=%" PRId64, (QUICInvariants::is_long_header(buf) ? "LH" : "SH"),
-                 ats_ip_nptop(&addr, ipb, sizeof(ipb)), udp_con->getPortNum(), buf_len);
+    QUICVPHDebug(dcid, scid, "send %s packet to %s from port %u size=%" PRId64 " total=%" PRId64,
+                 (QUICInvariants::is_long_header(buf) ? "LH" : "SH"), ats_ip_nptop(&addr, ipb, sizeof(ipb)), udp_con->getPortNum(),
+                 buf_len, udp_packet->getPktLength());
   }
 
   udp_con->send(this->_get_continuation(), udp_packet);
@@ -397,6 +406,12 @@ QUICPacketHandler::send_packet(QUICNetVConnection *vc, const Ptr<IOBufferBlock>
   this->_send_packet(vc->get_udp_con(), vc->con.addr, udp_payload);
 }
 
+void
+QUICPacketHandler::send_packet(QUICNetVConnection *vc, UDPPacket *udp_packet)
+{
+  this->_send_packet(vc->get_udp_con(), vc->con.addr, udp_packet);
+}
+
 int
 QUICPacketHandlerIn::_stateless_retry(const uint8_t *buf, uint64_t buf_len, UDPConnection *connection, IpEndpoint from,
                                       QUICConnectionId dcid, QUICConnectionId scid, QUICConnectionId *original_cid,
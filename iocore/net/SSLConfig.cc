@@ -59,6 +59,9 @@ int SSLConfig::configids[]                                  = {0, 0};
 int SSLCertificateConfig::configid                          = 0;
 int SSLTicketKeyConfig::configid                            = 0;
 int SSLConfigParams::ssl_maxrecord                          = 0;
+int64_t SSLConfigParams::ssl_dynamic_record_grow_bytes      = 1000000;
+int SSLConfigParams::ssl_dynamic_record_grow_rtts           = 4;
+int SSLConfigParams::ssl_dynamic_record_idle_msec           = 1000;
 int SSLConfigParams::ssl_misc_max_iobuffer_size_index       = 8;
 bool SSLConfigParams::ssl_allow_client_renegotiation        = false;
 bool SSLConfigParams::ssl_ocsp_enabled                      = false;
@@ -356,6 +359,9 @@ SSLConfigParams::initialize()
 
   // SSL record size
   REC_EstablishStaticConfigInt32(ssl_maxrecord, "proxy.config.ssl.max_record_size");
+  REC_EstablishStaticConfigInteger(ssl_dynamic_record_grow_bytes, "proxy.config.ssl.dynamic_record.grow_bytes");
+  REC_EstablishStaticConfigInt32(ssl_dynamic_record_grow_rtts, "proxy.config.ssl.dynamic_record.grow_rtts");
+  REC_EstablishStaticConfigInt32(ssl_dynamic_record_idle_msec, "proxy.config.ssl.dynamic_record.idle_msec");
 
   // SSL OCSP Stapling configurations
   REC_ReadConfigInt32(ssl_ocsp_enabled, "proxy.config.ssl.ocsp.enabled");
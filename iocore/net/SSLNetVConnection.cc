@@ -760,6 +760,101 @@ SSLNetVConnection::net_read_io(NetHandler *nh, EThread *lthread)
   }
 }
 
+// Histogram of the bytes a SSL_write() turned into records, over 16K makes several
+static void
+count_record_size(int64_t n)
+{
+  if (n <= 2048) {
+    SSL_INCREMENT_DYN_STAT(ssl_record_size_2K);
+  } else if (n <= 4096) {
+    SSL_INCREMENT_DYN_STAT(ssl_record_size_4K);
+  } else if (n <= 8192) {
+    SSL_INCREMENT_DYN_STAT(ssl_record_size_8K);
+  } else if (n <= 16384) {
+    SSL_INCREMENT_DYN_STAT(ssl_record_size_16K);
+  } else {
+    SSL_INCREMENT_DYN_STAT(ssl_record_size_inf);
+  }
+}
+
+// The smoothed round trip time of socket @a fd and whether its congestion window holds a full-size record.
+static bool
+tcp_window(int fd, ink_hrtime &rtt, bool &holds_record)
+{
+#if defined(TCP_INFO) && defined(HAVE_STRUCT_TCP_INFO)
+  struct tcp_info info;
+  socklen_t len = sizeof(info);
+  if (getsockopt(fd, IPPROTO_TCP, TCP_INFO, &info, &len) != 0) {
+    return false;
+  }
+#if defined(linux)
+  // the window is counted in segments on Linux, in bytes elsewhere
+  uint64_t cwnd = static_cast<uint64_t>(info.tcpi_snd_cwnd) * info.tcpi_snd_mss;
+#else
+  uint64_t cwnd = info.tcpi_snd_cwnd;
+#endif
+  rtt          = HRTIME_USECONDS(info.tcpi_rtt);
+  holds_record = cwnd >= SSL_MAX_TLS_RECORD_SIZE;
+  return true;
+#else
+  (void)fd;
+  (void)rtt;
+  (void)holds_record;
+  return false;
+#endif
+}
+
+/**
+  The size of the records to write now, proxy.config.ssl.max_record_size -1.
+
+  Records that fit in a segment can be decrypted as soon as the segment
+  arrives, while a congestion window still opening, or one that a loss just
+  shrank, would stall a full-size record over several round trips. Records
+  grow to full size once enough bytes went out with small ones, or once the
+  connection was busy for some round trips and its congestion window holds a
+  full-size record. They are small again after the connection was idle, the
+  window reported then is not to be trusted as Linux only restarts it when
+  the next segment is sent. The window is looked at once per round trip.
+ */
+uint32_t
+SSLNetVConnection::_dynamic_record_size(ink_hrtime now)
+{
+  ink_hrtime rtt    = 0;
+  bool holds_record = false;
+
+  if (ink_hrtime_diff_msec(now, sslLastWriteTime) > SSLConfigParams::ssl_dynamic_record_idle_msec) {
+    if (_full_records) {
+      SSL_INCREMENT_DYN_STAT(ssl_dyn_record_reset_count);
+    }
+    sslTotalBytesSent    = 0;
+    _full_records        = false;
+    _small_records_since = now;
+    _window_check_at     = 0;
+  }
+
+  if (!_full_records) {
+    if (sslTotalBytesSent >= SSLConfigParams::ssl_dynamic_record_grow_bytes) {
+      _full_records = true;
+      SSL_INCREMENT_DYN_STAT(ssl_dyn_record_grow_bytes_count);
+    } else if (SSLConfigParams::ssl_dynamic_record_grow_rtts > 0 && now >= _window_check_at) {
+      if (tcp_window(this->con.fd, rtt, holds_record) && rtt > 0) {
+        _window_check_at = now + rtt;
+        if (holds_record && now - _small_records_since >= SSLConfigParams::ssl_dynamic_record_grow_rtts * rtt) {
+          _full_records = true;
+          SSL_INCREMENT_DYN_STAT(ssl_dyn_record_grow_rtt_count);
+        }
+      } else {
+        // no round trip time yet, or none reported at all
+        _window_check_at = now + HRTIME_MSECONDS(SSLConfigParams::ssl_dynamic_record_idle_msec);
+      }
+    }
+  }
+
+  Debug("ssl", "now=%" PRId64 " lastwrite=%" PRId64 " sent=%" PRId64 " rtt=%" PRId64 " full_records=%d", now, sslLastWriteTime,
+        sslTotalBytesSent, rtt, _full_records);
+  return _full_records ? SSL_MAX_TLS_RECORD_SIZE : SSL_DEF_TLS_RECORD_SIZE;
+}
+
 int64_t
 SSLNetVConnection::load_buffer_and_write(int64_t towrite, MIOBufferAccessor &buf, int64_t &total_written, int &needs)
 {
@@ -769,21 +864,15 @@ SSLNetVConnection::load_buffer_and_write(int64_t towrite, MIOBufferAccessor &buf
   uint32_t dynamic_tls_record_size = 0;
   ssl_error_t err                  = SSL_ERROR_NONE;
 
+  if (HttpProxyPort::TRANSPORT_BLIND_TUNNEL == this->attributes) {
+    return this->super::load_buffer_and_write(towrite, buf, total_written, needs);
+  }
+
   // Dynamic TLS record sizing
   ink_hrtime now = 0;
   if (SSLConfigParams::ssl_maxrecord == -1) {
-    now                       = Thread::get_hrtime();
-    int msec_since_last_write = ink_hrtime_diff_msec(now, sslLastWriteTime);
-
-    if (msec_since_last_write > SSL_DEF_TLS_RECORD_MSEC_THRESHOLD) {
-      // reset sslTotalBytesSent upon inactivity for SSL_DEF_TLS_RECORD_MSEC_THRESHOLD
-      sslTotalBytesSent = 0;
-    }
-    Debug("ssl", "now=%" PRId64 " lastwrite=%" PRId64 " msec_since_last_write=%d", now, sslLastWriteTime, msec_since_last_write);
-  }
-
-  if (HttpProxyPort::TRANSPORT_BLIND_TUNNEL == this->attributes) {
-    return this->super::load_buffer_and_write(towrite, buf, total_written, needs);
+    now                     = Thread::get_hrtime();
+    dynamic_tls_record_size = this->_dynamic_record_size(now);
   }
 
   Debug("ssl", "towrite=%" PRId64, towrite);
@@ -813,11 +902,9 @@ SSLNetVConnection::load_buffer_and_write(int64_t towrite, MIOBufferAccessor &buf
       if (SSLConfigParams::ssl_maxrecord > 0 && l > SSLConfigParams::ssl_maxrecord) {
         l = SSLConfigParams::ssl_maxrecord;
       } else if (SSLConfigParams::ssl_maxrecord == -1) {
-        if (sslTotalBytesSent < SSL_DEF_TLS_RECORD_BYTE_THRESHOLD) {
-          dynamic_tls_record_size = SSL_DEF_TLS_RECORD_SIZE;
+        if (dynamic_tls_record_size < SSL_MAX_TLS_RECORD_SIZE) {
           SSL_INCREMENT_DYN_STAT(ssl_total_dyn_def_tls_record_count);
         } else {
-          dynamic_tls_record_size = SSL_MAX_TLS_RECORD_SIZE;
           SSL_INCREMENT_DYN_STAT(ssl_total_dyn_max_tls_record_count);
         }
         if (l > dynamic_tls_record_size) {
@@ -839,6 +926,7 @@ SSLNetVConnection::load_buffer_and_write(int64_t towrite, MIOBufferAccessor &buf
     if (num_really_written > 0) {
       total_written += num_really_written;
       buf.reader()->consume(num_really_written);
+      count_record_size(num_really_written);
     }
 
     Debug("ssl", "try_to_write=%" PRId64 " written=%" PRId64 " total_written=%" PRId64, try_to_write, num_really_written,
@@ -897,6 +985,48 @@ SSLNetVConnection::load_buffer_and_write(int64_t towrite, MIOBufferAccessor &buf
   return num_really_written;
 }
 
+bool
+SSLNetVConnection::is_sendfile_capable() const
+{
+#ifdef SSL_OP_ENABLE_KTLS
+  // only a kernel TLS socket encrypts file data on its own
+  return this->ssl != nullptr && getSSLHandShakeComplete() && BIO_get_ktls_send(SSL_get_wbio(this->ssl));
+#else
+  return false;
+#endif
+}
+
+int64_t
+SSLNetVConnection::sendfile_and_write(int fd, off_t offset, int64_t towrite)
+{
+#ifdef SSL_OP_ENABLE_KTLS
+  ERR_clear_error();
+  ossl_ssize_t r = SSL_sendfile(this->ssl, fd, offset, towrite, 0);
+  if (r > 0) {
+    sslTotalBytesSent += r;
+    return r;
+  }
+
+  switch (SSL_get_error(this->ssl, r)) {
+  case SSL_ERROR_WANT_WRITE:
+    Debug("ssl.error", "SSL_sendfile-SSL_ERROR_WANT_WRITE");
+    return -EAGAIN;
+  case SSL_ERROR_SYSCALL:
+    SSL_INCREMENT_DYN_STAT(ssl_error_syscall);
+    Debug("ssl.error", "SSL_sendfile-SSL_ERROR_SYSCALL");
+    return errno ? -errno : -EPIPE;
+  default:
+    SSL_CLR_ERR_INCR_DYN_STAT(this, ssl_error_ssl, "SSL_sendfile-SSL_ERROR_SSL errno=%d", errno);
+    return -EPIPE;
+  }
+#else
+  (void)fd;
+  (void)offset;
+  (void)towrite;
+  return -ENOTSUP;
+#endif
+}
+
 SSLNetVConnection::SSLNetVConnection() {}
 
 void
@@ -980,6 +1110,9 @@ SSLNetVConnection::clear()
   sslHandshakeStatus          = SSL_HANDSHAKE_ONGOING;
   sslLastWriteTime            = 0;
   sslTotalBytesSent           = 0;
+  _full_records               = false;
+  _small_records_since        = 0;
+  _window_check_at            = 0;
   sslClientRenegotiationAbort = false;
 
   curHook         = nullptr;
@@ -997,6 +1130,7 @@ SSLNetVConnection::free(EThread *t)
   if (con.fd != NO_FD) {
     NET_SUM_GLOBAL_DYN_STAT(net_connections_currently_open_stat, -1);
   }
+  free_zerocopy();
   con.close();
 
 #if TS_HAS_TLS_EARLY_DATA
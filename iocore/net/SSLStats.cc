@@ -186,6 +186,22 @@ SSLInitializeStatistics()
                      (int)ssl_total_dyn_max_tls_record_count, RecRawStatSyncSum);
   RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.redo_record_size_count", RECD_COUNTER, RECP_PERSISTENT,
                      (int)ssl_total_dyn_redo_tls_record_count, RecRawStatSyncCount);
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.dynamic_record_grow_bytes", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)ssl_dyn_record_grow_bytes_count, RecRawStatSyncCount);
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.dynamic_record_grow_rtt", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)ssl_dyn_record_grow_rtt_count, RecRawStatSyncCount);
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.dynamic_record_reset", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)ssl_dyn_record_reset_count, RecRawStatSyncCount);
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.record_size_2K", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)ssl_record_size_2K, RecRawStatSyncCount);
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.record_size_4K", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)ssl_record_size_4K, RecRawStatSyncCount);
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.record_size_8K", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)ssl_record_size_8K, RecRawStatSyncCount);
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.record_size_16K", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)ssl_record_size_16K, RecRawStatSyncCount);
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.record_size_inf", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)ssl_record_size_inf, RecRawStatSyncCount);
 
   // error stats
   RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.ssl_error_syscall", RECD_COUNTER, RECP_PERSISTENT,
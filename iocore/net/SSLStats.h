@@ -79,6 +79,14 @@ enum SSL_Stats {
   ssl_total_dyn_def_tls_record_count,
   ssl_total_dyn_max_tls_record_count,
   ssl_total_dyn_redo_tls_record_count,
+  ssl_dyn_record_grow_bytes_count, // dynamic record sizing went to full-size records
+  ssl_dyn_record_grow_rtt_count,
+  ssl_dyn_record_reset_count, // and back to small records after idle
+  ssl_record_size_2K,         // histogram of the bytes written per SSL_write
+  ssl_record_size_4K,
+  ssl_record_size_8K,
+  ssl_record_size_16K,
+  ssl_record_size_inf,
   ssl_session_cache_hit,
   ssl_origin_session_cache_hit,
   ssl_session_cache_miss,
@@ -24,6 +24,13 @@
 #include "P_Net.h"
 #include "I_AIO.h"
 
+#include <algorithm>
+#include <mutex>
+
+#if TS_USE_EPOLL
+#include <sys/ioctl.h>
+#endif
+
 using namespace std::literals;
 
 ink_hrtime last_throttle_warning;
@@ -33,6 +40,8 @@ bool net_memory_throttle = false;
 int fds_throttle;
 int fds_limit = 8000;
 ink_hrtime last_transient_accept_error;
+int net_config_busy_poll_usec       = 0;
+int net_config_busy_poll_epoll_usec = 0;
 
 NetHandler::Config NetHandler::global_config;
 std::bitset<std::numeric_limits<unsigned int>::digits> NetHandler::active_thread_types;
@@ -40,6 +49,47 @@ const std::bitset<NetHandler::CONFIG_ITEM_COUNT> NetHandler::config_value_affect
 
 extern "C" void fd_reify(struct ev_loop *);
 
+// Where each thread of ET_NET waits, proxy.process.net.poll.<kind>_time.thread.<n>
+enum {
+  POLL_SPIN_TIME,  ///< Spinning before sleeping.
+  POLL_IDLE_TIME,  ///< Spinning that found nothing to do.
+  POLL_SLEEP_TIME, ///< Blocked in the poll.
+  POLL_TIME_COUNT
+};
+static RecRawStatBlock *poll_thread_rsb = nullptr;
+static int poll_thread_count            = 0;
+
+static void
+register_poll_thread_stats()
+{
+  static std::once_flag once;
+  std::call_once(once, [] {
+    static const char *kinds[POLL_TIME_COUNT] = {"spin", "idle", "sleep"};
+    int n                                     = eventProcessor.thread_group[ET_NET]._count;
+    char name[64];
+
+    if (n <= 0 || (poll_thread_rsb = RecAllocateRawStatBlock(n * POLL_TIME_COUNT)) == nullptr) {
+      return;
+    }
+    for (int i = 0; i < n; i++) {
+      for (int k = 0; k < POLL_TIME_COUNT; k++) {
+        snprintf(name, sizeof(name), "proxy.process.net.poll.%s_time.thread.%d", kinds[k], i);
+        RecRegisterRawStat(poll_thread_rsb, RECT_PROCESS, name, RECD_INT, RECP_NON_PERSISTENT, i * POLL_TIME_COUNT + k,
+                           RecRawStatSyncSum);
+      }
+    }
+    poll_thread_count = n;
+  });
+}
+
+static inline void
+count_poll_time(EThread *t, int kind, ink_hrtime time)
+{
+  if (poll_thread_rsb && time > 0 && t->is_event_type(ET_NET) && t->id < poll_thread_count) {
+    RecIncrRawStat(poll_thread_rsb, t, t->id * POLL_TIME_COUNT + kind, time);
+  }
+}
+
 // INKqa10496
 // One Inactivity cop runs on each thread once every second and
 // loops through the list of NetEvents and calls the timeouts
@@ -253,6 +303,20 @@ initialize_thread_for_net(EThread *thread)
   nh->configure_per_thread_values();
   thread->schedule_every(inactivityCop, HRTIME_SECONDS(cop_freq));
 
+  register_poll_thread_stats();
+#if TS_USE_EPOLL && defined(EPIOCSPARAMS)
+  // let the kernel busy poll the device queues of the sockets as well
+  if (net_config_busy_poll_epoll_usec > 0) {
+    struct epoll_params params;
+    ink_zero(params);
+    params.busy_poll_usecs  = net_config_busy_poll_epoll_usec;
+    params.prefer_busy_poll = 1;
+    if (ioctl(pd->epoll_fd, EPIOCSPARAMS, &params) < 0) {
+      Warning("unable to set the epoll busy poll parameters: %s", strerror(errno));
+    }
+  }
+#endif
+
   thread->set_tail_handler(nh);
   thread->ep = static_cast<EventIO *>(ats_malloc(sizeof(EventIO)));
   new (thread->ep) EventIO();
@@ -262,6 +326,15 @@ initialize_thread_for_net(EThread *thread)
 #if TS_USE_LINUX_IO_URING
   thread->ep->start(pd, DiskHandler::local_context());
 #endif
+#if TS_USE_LINUX_IO_URING_RECV
+  if (net_config_io_uring_recv) {
+    nh->uring = new NetIOUring(DiskHandler::local_context());
+    if (!nh->uring->ok()) {
+      delete nh->uring;
+      nh->uring = nullptr;
+    }
+  }
+#endif
 #else
   thread->ep->start(pd, thread->evpipe[0], nullptr, EVENTIO_READ);
 #endif
@@ -498,15 +571,34 @@ NetHandler::waitForActivity(ink_hrtime timeout)
   NET_INCREMENT_DYN_STAT(net_handler_run_stat);
   SCOPED_MUTEX_LOCK(lock, mutex, this->thread);
 
+  // what the callbacks enable is written once the poll returns, it must not sleep first
+  if (!loop_tail_list.empty()) {
+    _process_loop_tail();
+    timeout = 0;
+  }
+
   process_enabled_list();
 
+  // paced writes that are due go on the ready list, the poll waits for the next one
+  if (!paced_list.empty()) {
+    ink_hrtime now  = Thread::get_hrtime_updated();
+    ink_hrtime next = _process_paced_list(now);
+    if (next) {
+      ink_hrtime wait = (next - now + HRTIME_MSECOND - 1) / HRTIME_MSECOND * HRTIME_MSECOND;
+      if (timeout < 0 || timeout > wait) {
+        timeout = wait;
+      }
+    }
+  }
+
 #if AIO_MODE == AIO_MODE_IO_URING
   dh->submit();
 #endif
 
   // Polling event by PollCont
-  PollCont *p = get_PollCont(this->thread);
-  p->do_poll(timeout);
+  ink_hrtime poll_start = Thread::get_hrtime_updated();
+  _poll(timeout);
+  this->thread->loop_wait_time += Thread::get_hrtime_updated() - poll_start;
 
   // Get & Process polling result
   PollDescriptor *pd = get_PollDescriptor(this->thread);
@@ -529,7 +621,8 @@ NetHandler::waitForActivity(ink_hrtime timeout)
           read_ready_list.enqueue(ne);
         }
       }
-      if (flags & (EVENTIO_WRITE)) {
+      // MSG_ZEROCOPY completions on the error queue are reaped by the write path
+      if ((flags & (EVENTIO_WRITE)) || ((flags & (EVENTIO_ERROR)) && ne->f.zerocopy)) {
         ne->write.triggered = 1;
         if (!write_ready_list.in(ne)) {
           write_ready_list.enqueue(ne);
@@ -565,20 +658,152 @@ NetHandler::waitForActivity(ink_hrtime timeout)
 
   pd->result = 0;
 
-  process_ready_list();
-
 #if AIO_MODE == AIO_MODE_IO_URING
+  // before the ready lists, socket read completions put their VCs on the read ready list
   if (servicedh) {
     dh->service();
   }
 #endif
 
+  process_ready_list();
+
+  // sockets of closed connections waiting for their MSG_ZEROCOPY sends
+  net_zerocopy_reap_closed();
+
   return EVENT_CONT;
 }
 
+void
+NetHandler::_poll(ink_hrtime timeout)
+{
+  PollCont *p        = get_PollCont(this->thread);
+  PollDescriptor *pd = p->pollDescriptor;
+  ink_hrtime max     = HRTIME_USECONDS(net_config_busy_poll_usec);
+  ink_hrtime start   = Thread::get_hrtime_updated();
+  ink_hrtime spin    = 0;
+
+  // whether there is nothing to do but wait, do_poll() does not wait otherwise
+  bool idle = timeout != 0 && read_ready_list.empty() && write_ready_list.empty() && read_enable_list.empty() &&
+              write_enable_list.empty();
+
+  if (max > 0 && idle) {
+    ink_hrtime limit = std::min(busy_poll_budget, max);
+    if (timeout > 0) {
+      limit = std::min(limit, timeout);
+    }
+    if (limit > 0) {
+      bool found = false;
+      spinning   = true;
+      do {
+        p->do_poll(0);
+        found = pd->result > 0 || woken.exchange(false);
+        spin  = Thread::get_hrtime_updated() - start;
+      } while (!found && spin < limit);
+      spinning = false;
+      count_poll_time(thread, POLL_SPIN_TIME, spin);
+      if (found || woken.exchange(false)) {
+        busy_poll_budget = std::min(max, busy_poll_budget * 2);
+        return;
+      }
+      count_poll_time(thread, POLL_IDLE_TIME, spin);
+    }
+  }
+
+  p->do_poll(timeout > 0 ? std::max<ink_hrtime>(timeout - spin, 0) : timeout);
+  if (!idle) {
+    return;
+  }
+  ink_hrtime sleep = Thread::get_hrtime_updated() - start - spin;
+  count_poll_time(thread, POLL_SLEEP_TIME, sleep);
+
+  // activity that came within the limit would have been caught by spinning
+  // for it, spin longer next time, otherwise the spinning was wasted
+  if (max > 0) {
+    if (pd->result > 0 && spin + sleep <= max) {
+      busy_poll_budget = std::min(max, std::max(busy_poll_budget * 2, max / 16));
+    } else {
+      busy_poll_budget /= 2;
+    }
+  }
+}
+
+void
+NetHandler::call_at_loop_tail(Continuation *c)
+{
+  ink_assert(this->thread == this_ethread());
+  loop_tail_list.push_back(c);
+}
+
+void
+NetHandler::cancel_loop_tail(Continuation *c)
+{
+  // cleared rather than removed, the list may be being walked
+  std::replace(loop_tail_list.begin(), loop_tail_list.end(), c, static_cast<Continuation *>(nullptr));
+}
+
+void
+NetHandler::_process_loop_tail()
+{
+  // continuations added by the callbacks go after n and wait for the next loop,
+  // those that could not be locked are moved down to the front
+  size_t n    = loop_tail_list.size();
+  size_t kept = 0;
+  for (size_t i = 0; i < n; ++i) {
+    Continuation *c = loop_tail_list[i];
+    if (c == nullptr) {
+      continue;
+    }
+    loop_tail_list[i] = nullptr;
+    MUTEX_TRY_LOCK(lock, c->mutex, this->thread);
+    if (!lock.is_locked()) {
+      loop_tail_list[kept++] = c;
+      continue;
+    }
+    c->handleEvent(NET_EVENT_LOOP_TAIL, nullptr);
+  }
+  loop_tail_list.erase(std::remove(loop_tail_list.begin() + kept, loop_tail_list.end(), nullptr), loop_tail_list.end());
+}
+
+void
+NetHandler::pace_write(NetEvent *ne, ink_hrtime until)
+{
+  write_ready_list.remove(ne);
+  ne->paced_until = until;
+  if (!paced_list.in(ne)) {
+    paced_list.enqueue(ne);
+  }
+}
+
+ink_hrtime
+NetHandler::_process_paced_list(ink_hrtime now)
+{
+  ink_hrtime next = 0;
+  NetEvent *ne    = paced_list.head;
+  while (ne) {
+    NetEvent *n = ne->paced_link.next;
+    if (ne->paced_until <= now) {
+      paced_list.remove(ne);
+      if (ne->write.enabled && ne->write.triggered) {
+        write_ready_list.in_or_enqueue(ne);
+      }
+    } else if (next == 0 || ne->paced_until < next) {
+      next = ne->paced_until;
+    }
+    ne = n;
+  }
+  return next;
+}
+
 void
 NetHandler::signalActivity()
 {
+  // a spinning thread checks for the signal between polls, sparing the write and the wakeup
+  if (spinning) {
+    woken = true;
+    if (spinning) {
+      return;
+    }
+  }
 #if HAVE_EVENTFD
   uint64_t counter = 1;
   ATS_UNUSED_RETURN(write(thread->evfd, &counter, sizeof(uint64_t)));
@@ -26,6 +26,12 @@
 
 #include "P_Net.h"
 
+#include <mutex>
+
+#if defined(linux)
+#include <linux/filter.h>
+#endif
+
 using NetAcceptHandler = int (NetAccept::*)(int, void *);
 int accept_till_done   = 1;
 
@@ -39,6 +45,94 @@ safe_delay(int msec)
   SocketManager::poll(nullptr, 0, msec);
 }
 
+// Connections accepted by each thread of ET_NET, proxy.process.net.accepts.thread.<n>
+static RecRawStatBlock *accept_thread_rsb = nullptr;
+static int accept_thread_count            = 0;
+
+static void
+register_accept_thread_stats()
+{
+  static std::once_flag once;
+  std::call_once(once, [] {
+    int n = eventProcessor.thread_group[ET_NET]._count;
+    char name[64];
+
+    if (n <= 0 || (accept_thread_rsb = RecAllocateRawStatBlock(n)) == nullptr) {
+      return;
+    }
+    for (int i = 0; i < n; i++) {
+      snprintf(name, sizeof(name), "proxy.process.net.accepts.thread.%d", i);
+      RecRegisterRawStat(accept_thread_rsb, RECT_PROCESS, name, RECD_INT, RECP_NON_PERSISTENT, i, RecRawStatSyncSum);
+    }
+    accept_thread_count = n;
+  });
+}
+
+static inline void
+count_thread_accept(EThread *t)
+{
+  if (accept_thread_rsb && t->is_event_type(ET_NET) && t->id < accept_thread_count) {
+    RecIncrRawStat(accept_thread_rsb, t, t->id, 1);
+  }
+}
+
+// Steer each connection to the listener of the thread running on the CPU
+// that received it, so the softirq, the accept and the transaction share a
+// cache. The program returns the index of the listener in the reuseport
+// group, which is the order the threads listened in: for each CPU, a thread
+// whose affinity includes it, spread over the threads sharing the CPU. An
+// index out of the group, for a CPU no thread may run on, lets the kernel
+// pick by hash.
+static void
+attach_cpu_steering(int fd, EventType etype, int n)
+{
+#if defined(SO_ATTACH_REUSEPORT_CBPF) && defined(SKF_AD_CPU)
+  int ncpus = std::min<long>(sysconf(_SC_NPROCESSORS_CONF), CPU_SETSIZE);
+  // two instructions per CPU, within the 4096 of a classic BPF program
+  ncpus = std::min(ncpus, (BPF_MAXINSNS - 2) / 2);
+
+  std::vector<cpu_set_t> masks(n);
+  for (int i = 0; i < n; i++) {
+    CPU_ZERO(&masks[i]);
+    if (pthread_getaffinity_np(eventProcessor.thread_group[etype]._thread[i]->tid, sizeof(cpu_set_t), &masks[i]) != 0) {
+      CPU_ZERO(&masks[i]);
+    }
+  }
+
+  std::vector<sock_filter> code;
+  std::vector<int> candidates;
+  code.push_back(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU)));
+  for (int cpu = 0; cpu < ncpus; cpu++) {
+    candidates.clear();
+    for (int i = 0; i < n; i++) {
+      if (CPU_ISSET(cpu, &masks[i])) {
+        candidates.push_back(i);
+      }
+    }
+    if (candidates.empty()) {
+      continue;
+    }
+    int index = candidates[cpu % candidates.size()];
+    code.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, static_cast<uint32_t>(cpu), 0, 1));
+    code.push_back(BPF_STMT(BPF_RET | BPF_K, static_cast<uint32_t>(index)));
+    Debug("iocore_net_accept", "steering connections received on CPU %d to thread %d", cpu, index);
+  }
+  code.push_back(BPF_STMT(BPF_RET | BPF_K, UINT32_MAX));
+
+  sock_fprog prog;
+  prog.len    = code.size();
+  prog.filter = code.data();
+  if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)) < 0) {
+    Warning("unable to steer connections by CPU, SO_ATTACH_REUSEPORT_CBPF failed: %s", strerror(errno));
+  }
+#else
+  (void)fd;
+  (void)etype;
+  (void)n;
+  Warning("proxy.config.exec_thread.listen_cpu_steering is not supported on this platform");
+#endif
+}
+
 //
 // General case network connection accept code
 //
@@ -77,6 +171,7 @@ net_accept(NetAccept *na, void *ep, bool blockable)
       goto Ldone;
     }
     NET_SUM_GLOBAL_DYN_STAT(net_tcp_accept_stat, 1);
+    count_thread_accept(e->ethread);
 
     vc = static_cast<UnixNetVConnection *>(na->getNetProcessor()->allocate_vc(e->ethread));
     if (!vc) {
@@ -202,9 +297,12 @@ int
 NetAccept::accept_per_thread(int event, void *ep)
 {
   int listen_per_thread = 0;
+  int cpu_steering      = 0;
   REC_ReadConfigInteger(listen_per_thread, "proxy.config.exec_thread.listen");
+  REC_ReadConfigInteger(cpu_steering, "proxy.config.exec_thread.listen_cpu_steering");
 
-  if (listen_per_thread == 1) {
+  // when steering, the listeners were opened in the order of the threads by init_accept_per_thread()
+  if (listen_per_thread == 1 && cpu_steering == 0) {
     if (do_listen(NON_BLOCKING)) {
       Fatal("[NetAccept::accept_per_thread]:error listenting on ports");
       return -1;
@@ -229,9 +327,12 @@ NetAccept::init_accept_per_thread()
 {
   int i, n;
   int listen_per_thread = 0;
+  int cpu_steering      = 0;
 
   ink_assert(opt.etype >= 0);
   REC_ReadConfigInteger(listen_per_thread, "proxy.config.exec_thread.listen");
+  REC_ReadConfigInteger(cpu_steering, "proxy.config.exec_thread.listen_cpu_steering");
+  register_accept_thread_stats();
 
   if (listen_per_thread == 0) {
     if (do_listen(NON_BLOCKING)) {
@@ -247,6 +348,17 @@ NetAccept::init_accept_per_thread()
     NetAccept *a = (i < n - 1) ? clone() : this;
     EThread *t   = eventProcessor.thread_group[opt.etype]._thread[i];
     a->mutex     = get_NetHandler(t)->mutex;
+    // the index of a listener in the reuseport group is the order it listened in
+    if (listen_per_thread == 1 && cpu_steering == 1) {
+      if (a->do_listen(NON_BLOCKING)) {
+        Fatal("[NetAccept::accept_per_thread]:error listenting on ports");
+        return;
+      }
+      // the group takes the program of its first listener, indexes yet to listen go by hash meanwhile
+      if (i == 0) {
+        attach_cpu_steering(a->server.fd, opt.etype, n);
+      }
+    }
     t->schedule_imm(a);
   }
 }
@@ -445,6 +557,7 @@ NetAccept::acceptFastEvent(int event, void *ep)
       }
       Debug("iocore_net", "accepted a new socket: %d", fd);
       NET_SUM_GLOBAL_DYN_STAT(net_tcp_accept_stat, 1);
+      count_thread_accept(e->ethread);
       if (opt.send_bufsize > 0) {
         if (unlikely(SocketManager::set_sndbuf_size(fd, opt.send_bufsize))) {
           bufsz = ROUNDUP(opt.send_bufsize, 1024);
@@ -0,0 +1,235 @@
+/** @file
+
+  Completion based socket reads on the io_uring of a net thread
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_Net.h"
+
+int net_config_io_uring_recv             = 0;
+int net_config_io_uring_recv_buffers     = 256;
+int net_config_io_uring_recv_buffer_size = 16384;
+
+#if TS_USE_LINUX_IO_URING_RECV
+
+/*
+  Instead of waiting for epoll to report a readable socket and then
+  calling recv, an inbound VC has a multishot receive armed on the
+  io_uring of its net thread.  The kernel completes it into a buffer of
+  the thread's provided buffer ring each time data arrives, and the
+  completions are reaped with the disk completions of the same ring in
+  NetHandler::waitForActivity, which saves a system call per read.
+
+  The socket is still in the epoll set for writes, and accept and
+  writes are unchanged.
+*/
+
+// Bytes queued for a VC before its receive is cancelled.
+#define NET_IO_URING_RECV_PENDING_MAX (4 * static_cast<int64_t>(net_config_io_uring_recv_buffer_size))
+
+NetIOUring::NetIOUring(DiskHandler *dh) : _dh(dh)
+{
+  unsigned entries = 1;
+  while (entries < static_cast<unsigned>(net_config_io_uring_recv_buffers)) {
+    entries <<= 1;
+  }
+  _size_index = iobuffer_size_to_index(net_config_io_uring_recv_buffer_size, MAX_BUFFER_SIZE_INDEX);
+
+  int ret = 0;
+  _br     = io_uring_setup_buf_ring(_dh->get_ring(), entries, BUFFER_GROUP, 0, &ret);
+  if (!_br) {
+    Warning("io_uring provided buffer ring of %u buffers failed: %s, reading sockets with epoll", entries, strerror(-ret));
+    return;
+  }
+  _entries = entries;
+  _buffers.resize(_entries);
+  for (unsigned bid = 0; bid < _entries; ++bid) {
+    _provide(bid);
+  }
+}
+
+NetIOUring::~NetIOUring()
+{
+  if (_br) {
+    io_uring_free_buf_ring(_dh->get_ring(), _br, _entries, BUFFER_GROUP);
+  }
+}
+
+io_uring_sqe *
+NetIOUring::get_sqe()
+{
+  io_uring_sqe *sqe = _dh->next_sqe();
+  if (!sqe) {
+    // the submission queue is full, make room
+    _dh->submit();
+    sqe = _dh->next_sqe();
+  }
+  return sqe;
+}
+
+void
+NetIOUring::_provide(int bid)
+{
+  _buffers[bid] = new_IOBufferData(_size_index);
+  io_uring_buf_ring_add(_br, _buffers[bid]->data(), _buffers[bid]->block_size(), bid, io_uring_buf_ring_mask(_entries), 0);
+  io_uring_buf_ring_advance(_br, 1);
+}
+
+IOBufferBlock *
+NetIOUring::take_buffer(int bid, int len)
+{
+  IOBufferBlock *b = new_IOBufferBlock();
+  b->set(_buffers[bid].get(), len);
+  _provide(bid);
+  return b;
+}
+
+NetIOUringRecv::NetIOUringRecv(UnixNetVConnection *vc, NetIOUring *ctx) : _vc(vc), _ctx(ctx), _fd(vc->con.fd)
+{
+  _pending = new_empty_MIOBuffer(BUFFER_SIZE_INDEX_4K);
+  _reader  = _pending->alloc_reader();
+}
+
+NetIOUringRecv::~NetIOUringRecv()
+{
+  if (_pending) {
+    free_MIOBuffer(_pending);
+  }
+}
+
+void
+NetIOUringRecv::arm()
+{
+  io_uring_sqe *sqe = _ctx->get_sqe();
+  if (!sqe) {
+    _error = ENOMEM;
+    _signal();
+    return;
+  }
+  io_uring_prep_recv_multishot(sqe, _fd, nullptr, 0, 0);
+  sqe->flags |= IOSQE_BUFFER_SELECT;
+  sqe->buf_group = NetIOUring::BUFFER_GROUP;
+  io_uring_sqe_set_data(sqe, user_data());
+  _armed = true;
+}
+
+void
+NetIOUringRecv::_cancel()
+{
+  if (_cancelling) {
+    return;
+  }
+  io_uring_sqe *sqe = _ctx->get_sqe();
+  if (!sqe) {
+    return;
+  }
+  io_uring_prep_cancel(sqe, user_data(), 0);
+  io_uring_sqe_set_data(sqe, nullptr);
+  _cancelling = true;
+}
+
+void
+NetIOUringRecv::_signal()
+{
+  if (!_vc) {
+    return;
+  }
+  NetHandler *nh      = _vc->nh;
+  _vc->read.triggered = 1;
+  if (nh->cop_list.in(_vc)) {
+    nh->cop_list.remove(_vc);
+  }
+  if (!nh->read_ready_list.in(_vc)) {
+    nh->read_ready_list.enqueue(_vc);
+  }
+}
+
+void
+NetIOUringRecv::handle_complete(io_uring_cqe *cqe)
+{
+  if (cqe->res > 0 && (cqe->flags & IORING_CQE_F_BUFFER)) {
+    IOBufferBlock *b = _ctx->take_buffer(cqe->flags >> IORING_CQE_BUFFER_SHIFT, cqe->res);
+    if (_pending) {
+      _pending->append_block(b);
+    } else {
+      b->free();
+    }
+    RecIncrRawStatSum(net_rsb, this_ethread(), net_io_uring_recv_stat, 1);
+  } else if (cqe->res == 0) {
+    _eos = true;
+  } else if (cqe->res < 0 && cqe->res != -ECANCELED && cqe->res != -ENOBUFS) {
+    _error = -cqe->res;
+  }
+
+  if (!(cqe->flags & IORING_CQE_F_MORE)) {
+    _armed      = false;
+    _cancelling = false;
+  }
+  if (!_vc) {
+    if (!_armed) {
+      delete this;
+    }
+    return;
+  }
+
+  if (!_armed && cqe->res == -ENOBUFS) {
+    // the ring ran dry, retry once buffers are back
+    arm();
+  } else if (_armed && _reader->read_avail() > NET_IO_URING_RECV_PENDING_MAX) {
+    _cancel();
+  }
+  _signal();
+}
+
+int64_t
+NetIOUringRecv::read(MIOBuffer *buf, int64_t len)
+{
+  int64_t n = std::min(len, _reader->read_avail());
+  if (n > 0) {
+    buf->write(_reader, n);
+    _reader->consume(n);
+  }
+  if (!_armed && !_eos && !_error && _reader->read_avail() <= NET_IO_URING_RECV_PENDING_MAX) {
+    arm();
+  }
+  if (n > 0) {
+    return n;
+  }
+  if (_error) {
+    return -_error;
+  }
+  return _eos ? 0 : -EAGAIN;
+}
+
+void
+NetIOUringRecv::detach()
+{
+  _vc = nullptr;
+  free_MIOBuffer(_pending);
+  _pending = nullptr;
+  _reader  = nullptr;
+  if (_armed) {
+    _cancel();
+  } else {
+    delete this;
+  }
+}
+
+#endif
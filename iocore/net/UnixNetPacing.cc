@@ -0,0 +1,155 @@
+/** @file
+
+  Limit the rate a connection sends at, in the kernel or with a token bucket
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_Net.h"
+
+#include <algorithm>
+
+int net_config_pacing_kernel = 1;
+
+// The bucket holds this much of the rate, and no less than a few segments,
+// the poll only waits in milliseconds.
+#define NET_PACING_BURST_TIME HRTIME_MSECONDS(2)
+#define NET_PACING_MIN_BURST 16384
+// How often an automatic rate is recomputed.
+#define NET_PACING_PROBE_PERIOD HRTIME_MSECONDS(100)
+
+namespace
+{
+// What @a fd can deliver per second, a congestion window per round trip, with
+// the headroom Linux paces at itself: twice that in slow start, 1.2 times after.
+int64_t
+probe_rate(int fd)
+{
+#if defined(TCP_INFO) && defined(HAVE_STRUCT_TCP_INFO)
+  struct tcp_info info;
+  socklen_t len = sizeof(info);
+  if (getsockopt(fd, IPPROTO_TCP, TCP_INFO, &info, &len) != 0 || info.tcpi_rtt == 0) {
+    return 0;
+  }
+#if defined(linux)
+  // the window is counted in segments on Linux, in bytes elsewhere
+  uint64_t cwnd = static_cast<uint64_t>(info.tcpi_snd_cwnd) * info.tcpi_snd_mss;
+#else
+  uint64_t cwnd = info.tcpi_snd_cwnd;
+#endif
+  uint64_t rate = cwnd * 1000000 / info.tcpi_rtt;
+  return info.tcpi_snd_cwnd < info.tcpi_snd_ssthresh ? rate * 2 : rate * 6 / 5;
+#else
+  (void)fd;
+  return 0;
+#endif
+}
+} // namespace
+
+void
+NetPacing::set(int fd, int64_t r)
+{
+  if (r < 0 ? automatic : (!automatic && r == rate)) {
+    return;
+  }
+  automatic = r < 0;
+  if (automatic) {
+    // probed on the next write
+    probed_at = 0;
+    return;
+  }
+  _apply(fd, r);
+}
+
+void
+NetPacing::_apply(int fd, int64_t r)
+{
+  bool kernel = false;
+
+#ifdef SO_MAX_PACING_RATE
+  if ((r > 0 && net_config_pacing_kernel && !no_kernel) || in_kernel) {
+    unsigned long value = r > 0 ? static_cast<unsigned long>(r) : ~0UL;
+    if (setsockopt(fd, SOL_SOCKET, SO_MAX_PACING_RATE, &value, sizeof(value)) == 0) {
+      kernel = r > 0;
+    } else {
+      Debug("iocore_net_pacing", "SO_MAX_PACING_RATE failed on fd %d: %s", fd, strerror(errno));
+      no_kernel = true;
+    }
+  }
+#endif
+
+  if (!kernel && (in_kernel || rate == 0)) {
+    // paced here from now on, the bucket starts full
+    filled_at = 0;
+  }
+  in_kernel = kernel;
+  rate      = r;
+}
+
+int64_t
+NetPacing::_burst() const
+{
+  return std::max<int64_t>(rate * ink_hrtime_to_usec(NET_PACING_BURST_TIME) / 1000000, NET_PACING_MIN_BURST);
+}
+
+int64_t
+NetPacing::allowance(int fd, ink_hrtime now)
+{
+  if (automatic && now - probed_at >= NET_PACING_PROBE_PERIOD) {
+    probed_at = now;
+    int64_t r = probe_rate(fd);
+    if (r > 0) {
+      _apply(fd, r);
+    }
+  }
+  if (in_kernel || rate <= 0) {
+    return INT64_MAX;
+  }
+
+  int64_t burst = _burst();
+  if (filled_at == 0 || now - filled_at >= HRTIME_SECOND) {
+    tokens    = burst;
+    filled_at = now;
+  } else if (now > filled_at) {
+    int64_t add = rate * ink_hrtime_to_usec(now - filled_at) / 1000000;
+    if (tokens + add >= burst) {
+      tokens    = burst;
+      filled_at = now;
+    } else if (add > 0) {
+      // only the time the added bytes took is used up, short calls still add up
+      tokens += add;
+      filled_at += HRTIME_USECONDS(add * 1000000 / rate);
+    }
+  }
+  return tokens;
+}
+
+ink_hrtime
+NetPacing::ready_at(ink_hrtime now) const
+{
+  if (rate <= 0) {
+    return now;
+  }
+  // wait for a quarter of the bucket rather than write a few bytes at a time
+  int64_t need = _burst() / 4 - tokens;
+  if (need <= 0) {
+    return now;
+  }
+  return std::max(now, filled_at + HRTIME_USECONDS(need * 1000000 / rate + 1));
+}
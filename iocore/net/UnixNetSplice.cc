@@ -0,0 +1,111 @@
+/** @file
+
+  Zero copy transfers between two sockets of a net thread with splice(2)
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_Net.h"
+
+#include <vector>
+
+int net_config_splice           = 0;
+int net_config_splice_pipe_size = 65536;
+
+// Empty pipes kept by each net thread.
+#define NET_SPLICE_POOL_MAX 64
+
+ClassAllocator<NetSplice> netSpliceAllocator("netSpliceAllocator");
+
+namespace
+{
+struct SplicePipe {
+  int fd[2];
+  int64_t size;
+};
+
+// Pipes are only used by the thread of their VCs, so the pool needs no lock.
+thread_local std::vector<SplicePipe> splice_pool;
+
+void
+close_pipe(int fd[2])
+{
+  if (fd[0] != NO_FD) {
+    SocketManager::close(fd[0]);
+    SocketManager::close(fd[1]);
+  }
+  fd[0] = fd[1] = NO_FD;
+}
+
+bool
+open_pipe(SplicePipe &p)
+{
+#if defined(linux)
+  if (pipe2(p.fd, O_NONBLOCK | O_CLOEXEC) < 0) {
+    Debug("iocore_net_splice", "pipe2 failed: %s", strerror(errno));
+    return false;
+  }
+  int size = fcntl(p.fd[0], F_SETPIPE_SZ, net_config_splice_pipe_size);
+  if (size < 0) {
+    size = fcntl(p.fd[0], F_GETPIPE_SZ);
+  }
+  if (size <= 0) {
+    close_pipe(p.fd);
+    return false;
+  }
+  p.size = size;
+  return true;
+#else
+  (void)p;
+  return false;
+#endif
+}
+} // namespace
+
+NetSplice *
+new_NetSplice()
+{
+  SplicePipe p;
+  if (!splice_pool.empty()) {
+    p = splice_pool.back();
+    splice_pool.pop_back();
+  } else if (!open_pipe(p)) {
+    return nullptr;
+  }
+  NetSplice *s = netSpliceAllocator.alloc();
+  s->fd[0]     = p.fd[0];
+  s->fd[1]     = p.fd[1];
+  s->size      = p.size;
+  return s;
+}
+
+void
+free_NetSplice(NetSplice *s)
+{
+  if (s->src || s->dst) {
+    return;
+  }
+  // bytes left in the pipe were never written, the pipe cannot be reused
+  if (s->bytes == 0 && splice_pool.size() < NET_SPLICE_POOL_MAX) {
+    splice_pool.push_back({{s->fd[0], s->fd[1]}, s->size});
+  } else {
+    close_pipe(s->fd);
+  }
+  netSpliceAllocator.free(s);
+}
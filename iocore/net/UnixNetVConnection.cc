@@ -26,6 +26,9 @@
 #include "tscore/InkErrno.h"
 
 #include <termios.h>
+#if defined(linux)
+#include <sys/sendfile.h>
+#endif
 
 #define STATE_VIO_OFFSET ((uintptr_t) & ((NetState *)0)->vio)
 #define STATE_FROM_VIO(_x) ((NetState *)(((char *)(_x)) - STATE_VIO_OFFSET))
@@ -79,7 +82,9 @@ read_signal_and_update(int event, UnixNetVConnection *vc)
 {
   vc->recursion++;
   if (vc->read.vio.cont && vc->read.vio.mutex == vc->read.vio.cont->mutex) {
+    ink_hrtime sample_start = this_ethread()->begin_dispatch(vc->read.vio.cont);
     vc->read.vio.cont->handleEvent(event, &vc->read.vio);
+    this_ethread()->end_dispatch(sample_start);
   } else {
     if (vc->read.vio.cont) {
       Note("read_signal_and_update: mutexes are different? vc=%p, event=%d", vc, event);
@@ -113,7 +118,9 @@ write_signal_and_update(int event, UnixNetVConnection *vc)
 {
   vc->recursion++;
   if (vc->write.vio.cont && vc->write.vio.mutex == vc->write.vio.cont->mutex) {
+    ink_hrtime sample_start = this_ethread()->begin_dispatch(vc->write.vio.cont);
     vc->write.vio.cont->handleEvent(event, &vc->write.vio);
+    this_ethread()->end_dispatch(sample_start);
   } else {
     if (vc->write.vio.cont) {
       Note("write_signal_and_update: mutexes are different? vc=%p, event=%d", vc, event);
@@ -180,6 +187,208 @@ write_signal_error(NetHandler *nh, UnixNetVConnection *vc, int lerrno)
   return write_signal_done(VC_EVENT_ERROR, nh, vc);
 }
 
+// Let go of the splice on the read or write side, the pipe is freed once both sides did.
+static inline void
+splice_detach_read(UnixNetVConnection *vc)
+{
+  if (NetSplice *sp = vc->splice_read; sp) {
+    vc->splice_read = nullptr;
+    sp->src         = nullptr;
+    free_NetSplice(sp);
+  }
+}
+
+static inline void
+splice_detach_write(UnixNetVConnection *vc)
+{
+  if (NetSplice *sp = vc->splice_write; sp) {
+    vc->splice_write = nullptr;
+    sp->dst          = nullptr;
+    free_NetSplice(sp);
+  }
+}
+
+// Move socket data of a spliced VC into its pipe, read_from_net() for the zero copy path.
+// The read VIO counts the bytes but its buffer is never written.
+static void
+splice_read_from_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
+{
+  NetState *s       = &vc->read;
+  NetSplice *sp     = vc->splice_read;
+  ProxyMutex *mutex = thread->mutex.get();
+  int64_t ntodo     = s->vio.ntodo();
+  int64_t total     = 0;
+  int64_t r         = 0;
+
+  if (!sp->dst || sp->dst->closed) {
+    // the writer is gone, nothing would drain the pipe
+    splice_detach_read(vc);
+    vc->read.triggered = 0;
+    read_signal_error(nh, vc, EPIPE);
+    return;
+  }
+
+#if defined(linux)
+  while (ntodo > 0 && sp->bytes < sp->size) {
+    r = splice(vc->con.fd, nullptr, sp->fd[1], nullptr, std::min(ntodo, sp->size - sp->bytes), SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    NET_INCREMENT_DYN_STAT(net_calls_to_read_stat);
+    if (r <= 0) {
+      r = r < 0 ? -errno : 0;
+      break;
+    }
+    sp->bytes += r;
+    total += r;
+    ntodo -= r;
+  }
+#endif
+
+  if (total > 0) {
+    NET_SUM_DYN_STAT(net_read_bytes_stat, total);
+    NET_SUM_DYN_STAT(net_splice_bytes_stat, total);
+    s->vio.ndone += total;
+    net_activity(vc, thread);
+    sp->dst->reenable(&sp->dst->write.vio);
+  }
+
+  if (ntodo <= 0) {
+    splice_detach_read(vc);
+    read_signal_done(VC_EVENT_READ_COMPLETE, nh, vc);
+  } else if (sp->bytes >= sp->size) {
+    // the pipe is full, the writer puts this back on the ready list once it drained some
+    nh->read_ready_list.remove(vc);
+  } else if (r == -EAGAIN || r == -ENOTCONN) {
+    // a pipe with partly filled pages may be full before its size, only an empty one proves the socket is drained
+    if (sp->bytes == 0) {
+      NET_INCREMENT_DYN_STAT(net_calls_to_read_nodata_stat);
+      vc->read.triggered = 0;
+    }
+    nh->read_ready_list.remove(vc);
+  } else if (r == 0 || r == -ECONNRESET) {
+    vc->read.triggered = 0;
+    nh->read_ready_list.remove(vc);
+    splice_detach_read(vc);
+    read_signal_done(VC_EVENT_EOS, nh, vc);
+  } else {
+    vc->read.triggered = 0;
+    splice_detach_read(vc);
+    read_signal_error(nh, vc, static_cast<int>(-r));
+  }
+}
+
+// Move the pipe of a spliced VC to its socket, write_to_net() for the zero copy path once the write buffer is empty.
+static void
+splice_write_to_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
+{
+  NetState *s       = &vc->write;
+  NetSplice *sp     = vc->splice_write;
+  ProxyMutex *mutex = thread->mutex.get();
+  int64_t ntodo     = s->vio.ntodo();
+  int64_t total     = 0;
+  int64_t r         = 0;
+
+#if defined(linux)
+  while (sp->bytes > 0 && total < ntodo) {
+    r = splice(sp->fd[0], nullptr, vc->con.fd, nullptr, std::min(sp->bytes, ntodo - total), SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    NET_INCREMENT_DYN_STAT(net_calls_to_write_stat);
+    if (r <= 0) {
+      r = r < 0 ? -errno : 0;
+      break;
+    }
+    sp->bytes -= r;
+    total += r;
+  }
+#endif
+
+  if (total > 0) {
+    NET_SUM_DYN_STAT(net_write_bytes_stat, total);
+    s->vio.ndone += total;
+    net_activity(vc, thread);
+    // there is room in the pipe again
+    UnixNetVConnection *src = sp->src;
+    if (src && src->read.enabled && src->read.triggered) {
+      nh->read_ready_list.in_or_enqueue(src);
+    }
+  }
+
+  if (s->vio.ntodo() <= 0) {
+    splice_detach_write(vc);
+    write_signal_done(VC_EVENT_WRITE_COMPLETE, nh, vc);
+  } else if (r == -EAGAIN || r == -ENOTCONN) {
+    NET_INCREMENT_DYN_STAT(net_calls_to_write_nodata_stat);
+    vc->write.triggered = 0;
+    nh->write_ready_list.remove(vc);
+    write_reschedule(nh, vc);
+  } else if (r < 0) {
+    vc->write.triggered = 0;
+    splice_detach_write(vc);
+    write_signal_error(nh, vc, static_cast<int>(-r));
+  } else {
+    // the pipe is empty, the reader enables this again
+    write_disable(nh, vc);
+  }
+}
+
+// Send the file part of a VC, write_to_net() for the sendfile path once the write buffer is empty.
+static void
+sendfile_write_to_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
+{
+  NetState *s       = &vc->write;
+  ProxyMutex *mutex = thread->mutex.get();
+  int64_t ntodo     = s->vio.ntodo();
+  int64_t total     = 0;
+  int64_t r         = 0;
+
+  while (vc->sendfile_len > 0 && total < ntodo) {
+    if (vc->sendfile_clock && *vc->sendfile_clock >= vc->sendfile_limit) {
+      // the file is about to be overwritten, what is left of the part may no longer be its data
+      Debug("iocore_net_sendfile", "vc %p: file overwritten, %" PRId64 " bytes not sent", vc, vc->sendfile_len);
+      r = -EIO;
+      break;
+    }
+    r = vc->sendfile_and_write(vc->sendfile_fd, vc->sendfile_offset, std::min(vc->sendfile_len, ntodo - total));
+    NET_INCREMENT_DYN_STAT(net_calls_to_write_stat);
+    ++vc->sendfile_calls;
+    if (r <= 0) {
+      // the file ended before the part did
+      r = r < 0 ? r : -EIO;
+      break;
+    }
+    vc->sendfile_offset += r;
+    vc->sendfile_len -= r;
+    total += r;
+  }
+
+  if (total > 0) {
+    NET_SUM_DYN_STAT(net_write_bytes_stat, total);
+    NET_SUM_DYN_STAT(net_sendfile_bytes_stat, total);
+    vc->sendfile_bytes += total;
+    s->vio.ndone += total;
+    net_activity(vc, thread);
+  }
+
+  if (s->vio.ntodo() <= 0) {
+    vc->sendfile_len = 0;
+    write_signal_done(VC_EVENT_WRITE_COMPLETE, nh, vc);
+  } else if (r == -EAGAIN || r == -ENOTCONN) {
+    NET_INCREMENT_DYN_STAT(net_calls_to_write_nodata_stat);
+    vc->write.triggered = 0;
+    nh->write_ready_list.remove(vc);
+    write_reschedule(nh, vc);
+  } else if (r < 0) {
+    vc->write.triggered = 0;
+    vc->sendfile_len    = 0;
+    write_signal_error(nh, vc, static_cast<int>(-r));
+  } else if (write_signal_and_update(VC_EVENT_WRITE_READY, vc) == EVENT_CONT) {
+    // the part is sent, the writer reenables this with more data or the next part
+    IOBufferReader *reader = s->vio.buffer.reader();
+    if (vc->sendfile_len > 0 || (reader && reader->is_read_avail_more_than(0))) {
+      write_reschedule(nh, vc);
+    } else {
+      write_disable(nh, vc);
+    }
+  }
+}
+
 // Read the data for a UnixNetVConnection.
 // Rescheduling the UnixNetVConnection by moving the VC
 // onto or off of the ready_list.
@@ -220,6 +429,11 @@ read_from_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
     read_disable(nh, vc);
     return;
   }
+  if (vc->splice_read) {
+    splice_read_from_net(nh, vc, thread);
+    return;
+  }
+
   int64_t toread = buf.writer()->write_avail();
   if (toread > ntodo) {
     toread = ntodo;
@@ -229,7 +443,12 @@ read_from_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
   int64_t rattempted = 0, total_read = 0;
   unsigned niov = 0;
   IOVec tiovec[NET_MAX_IOV];
-  if (toread) {
+  if (toread && vc->uring_recv) {
+#if TS_USE_LINUX_IO_URING_RECV
+    // the data was received already, this appends its blocks to the buffer
+    r = vc->uring_recv->read(buf.writer(), toread);
+#endif
+  } else if (toread) {
     IOBufferBlock *b = buf.writer()->first_write_block();
     do {
       niov       = 0;
@@ -276,6 +495,8 @@ read_from_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
         r = total_read - rattempted + r;
       }
     }
+  }
+  if (toread) {
     // check for errors
     if (r <= 0) {
       if (r == -EAGAIN || r == -ENOTCONN) {
@@ -298,7 +519,9 @@ read_from_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
     NET_SUM_DYN_STAT(net_read_bytes_stat, r);
 
     // Add data to buffer and signal continuation.
-    buf.writer()->fill(r);
+    if (!vc->uring_recv) {
+      buf.writer()->fill(r);
+    }
 #ifdef DEBUG
     if (buf.writer()->write_avail() <= 0) {
       Debug("iocore_net", "read_from_net, read buffer full");
@@ -361,6 +584,11 @@ write_to_net_io(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
   NetState *s       = &vc->write;
   ProxyMutex *mutex = thread->mutex.get();
 
+  // the completions only touch the blocks kept by the VC, whether its VIO is locked or not
+  if (vc->zerocopy && vc->zerocopy->pending()) {
+    vc->zerocopy->reap(vc->con.fd);
+  }
+
   MUTEX_TRY_LOCK(lock, s->vio.mutex, thread);
 
   if (!lock.is_locked() || lock.get_mutex() != s->vio.mutex.get()) {
@@ -432,6 +660,16 @@ write_to_net_io(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
   MIOBufferAccessor &buf = s->vio.buffer;
   ink_assert(buf.writer());
 
+  // spliced data goes after what is buffered
+  if (vc->splice_write && !buf.reader()->is_read_avail_more_than(0)) {
+    splice_write_to_net(nh, vc, thread);
+    return;
+  }
+  if (vc->sendfile_len > 0 && !buf.reader()->is_read_avail_more_than(0)) {
+    sendfile_write_to_net(nh, vc, thread);
+    return;
+  }
+
   // Calculate the amount to write.
   int64_t towrite = buf.reader()->read_avail();
   if (towrite > ntodo) {
@@ -468,6 +706,18 @@ write_to_net_io(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
     return;
   }
 
+  // the write waits for the pacing bucket to refill, unless the kernel paces
+  if (vc->pacing.active()) {
+    ink_hrtime now    = Thread::get_hrtime();
+    int64_t allowance = vc->pacing.allowance(vc->con.fd, now);
+    if (allowance <= 0) {
+      NET_INCREMENT_DYN_STAT(net_pacing_deferred_writes_stat);
+      nh->pace_write(vc, vc->pacing.ready_at(now));
+      return;
+    }
+    towrite = std::min(towrite, allowance);
+  }
+
   int needs             = 0;
   int64_t total_written = 0;
   int64_t r             = vc->load_buffer_and_write(towrite, buf, total_written, needs);
@@ -475,6 +725,9 @@ write_to_net_io(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
   if (total_written > 0) {
     NET_SUM_DYN_STAT(net_write_bytes_stat, total_written);
     s->vio.ndone += total_written;
+    if (vc->pacing.active()) {
+      vc->pacing.sent(total_written);
+    }
     net_activity(vc, thread);
   }
 
@@ -544,7 +797,12 @@ write_to_net_io(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
     }
 
     if (!(buf.reader()->is_read_avail_more_than(0))) {
-      write_disable(nh, vc);
+      // a spliced pipe or a file part is written once the buffer is empty
+      if (vc->splice_write || vc->sendfile_len > 0) {
+        write_reschedule(nh, vc);
+      } else {
+        write_disable(nh, vc);
+      }
       return;
     }
 
@@ -589,6 +847,7 @@ UnixNetVConnection::do_io_read(Continuation *c, int64_t nbytes, MIOBuffer *buf)
     Error("do_io_read invoked on closed vc %p, cont %p, nbytes %" PRId64 ", buf %p", this, c, nbytes, buf);
     return nullptr;
   }
+  splice_detach_read(this);
   read.vio.op        = VIO::READ;
   read.vio.mutex     = c ? c->mutex : this->mutex;
   read.vio.cont      = c;
@@ -614,6 +873,8 @@ UnixNetVConnection::do_io_write(Continuation *c, int64_t nbytes, IOBufferReader
     Error("do_io_write invoked on closed vc %p, cont %p, nbytes %" PRId64 ", reader %p", this, c, nbytes, reader);
     return nullptr;
   }
+  splice_detach_write(this);
+  sendfile_len        = 0;
   write.vio.op        = VIO::WRITE;
   write.vio.mutex     = c ? c->mutex : this->mutex;
   write.vio.cont      = c;
@@ -918,8 +1179,21 @@ UnixNetVConnection::load_buffer_and_write(int64_t towrite, MIOBufferAccessor &bu
     if (!this->con.is_connected && this->options.f_tcp_fastopen) {
       NET_INCREMENT_DYN_STAT(net_fastopen_attempts_stat);
       flags = MSG_FASTOPEN;
+    } else if (net_config_zerocopy && try_to_write >= net_config_zerocopy_min_size) {
+      if (!zerocopy) {
+        zerocopy = new_NetZeroCopy();
+      }
+      if (zerocopy && zerocopy->want(con.fd)) {
+        flags      = MSG_ZEROCOPY;
+        f.zerocopy = 1;
+      }
     }
     r = SocketManager::sendmsg(con.fd, &msg, flags);
+    if (r == -ENOBUFS && (flags & MSG_ZEROCOPY)) {
+      // out of memory to pin pages, this one is copied
+      flags &= ~MSG_ZEROCOPY;
+      r      = SocketManager::sendmsg(con.fd, &msg, flags);
+    }
     if (!this->con.is_connected && this->options.f_tcp_fastopen) {
       if (r < 0) {
         if (r == -EINPROGRESS || r == -EWOULDBLOCK) {
@@ -932,6 +1206,9 @@ UnixNetVConnection::load_buffer_and_write(int64_t towrite, MIOBufferAccessor &bu
     }
 
     if (r > 0) {
+      if (flags & MSG_ZEROCOPY) {
+        zerocopy->sent(buf.reader(), r);
+      }
       buf.reader()->consume(r);
       total_written += r;
     }
@@ -1016,12 +1293,25 @@ UnixNetVConnection::acceptEvent(int event, Event *e)
 
   thread = t;
 
+#if TS_USE_LINUX_IO_URING_RECV
+  if (h->uring && plainSocketIO()) {
+    f.recv_completions = 1;
+  }
+#endif
+
   // Send this NetVC to NetHandler and start to polling read & write event.
   if (h->startIO(this) < 0) {
     free(t);
     return EVENT_DONE;
   }
 
+#if TS_USE_LINUX_IO_URING_RECV
+  if (f.recv_completions) {
+    uring_recv = new NetIOUringRecv(this, h->uring);
+    uring_recv->arm();
+  }
+#endif
+
   // Switch vc->mutex from NetHandler->mutex to new mutex
   mutex = new_ProxyMutex();
   SCOPED_MUTEX_LOCK(lock2, mutex, t);
@@ -1279,6 +1569,7 @@ UnixNetVConnection::clear()
   }
   closed        = 0;
   netvc_context = NET_VCONNECTION_UNSET;
+  pacing        = NetPacing();
   ink_assert(!read.ready_link.prev && !read.ready_link.next);
   ink_assert(!read.enable_link.next);
   ink_assert(!write.ready_link.prev && !write.ready_link.next);
@@ -1295,6 +1586,21 @@ UnixNetVConnection::free(EThread *t)
   if (con.fd != NO_FD) {
     NET_SUM_GLOBAL_DYN_STAT(net_connections_currently_open_stat, -1);
   }
+#if TS_USE_LINUX_IO_URING_RECV
+  if (uring_recv) {
+    uring_recv->detach();
+    uring_recv = nullptr;
+  }
+#endif
+  splice_detach_read(this);
+  splice_detach_write(this);
+  if (sendfile_calls) {
+    Debug("iocore_net_sendfile", "vc %p sent %" PRId64 " bytes of files in %" PRId64 " calls", this, sendfile_bytes, sendfile_calls);
+  }
+  sendfile_len   = 0;
+  sendfile_bytes = 0;
+  sendfile_calls = 0;
+  free_zerocopy();
   con.close();
 
   clear();
@@ -1309,6 +1615,106 @@ UnixNetVConnection::free(EThread *t)
   }
 }
 
+void
+UnixNetVConnection::free_zerocopy()
+{
+  if (!zerocopy) {
+    return;
+  }
+  int fd = con.fd;
+  if (zerocopy->pending()) {
+    con.fd = NO_FD;
+  }
+  free_NetZeroCopy(zerocopy, fd);
+  zerocopy = nullptr;
+}
+
+void
+UnixNetVConnection::set_pacing_rate(int64_t rate)
+{
+  if (rate != 0 && !pacing.active()) {
+    NET_SUM_GLOBAL_DYN_STAT(net_pacing_connections_stat, 1);
+  }
+  pacing.set(con.fd, rate);
+  Debug("iocore_net_pacing", "vc %p fd %d pacing at %" PRId64 " bytes/s%s", this, con.fd, rate,
+        pacing.in_kernel ? " in the kernel" : "");
+}
+
+bool
+UnixNetVConnection::splice_to(NetVConnection *to)
+{
+  UnixNetVConnection *dst = dynamic_cast<UnixNetVConnection *>(to);
+
+  // both sockets must be plain and serviced by this thread, and each VIO can only have one pipe
+  if (!net_config_splice || !dst || dst == this || closed || dst->closed || !nh || dst->nh != nh || thread != this_ethread() ||
+      !plainSocketIO() || !dst->plainSocketIO() || uring_recv || splice_read || dst->splice_write || read.vio.op != VIO::READ ||
+      dst->write.vio.op != VIO::WRITE) {
+    return false;
+  }
+  NetSplice *sp = new_NetSplice();
+  if (!sp) {
+    return false;
+  }
+  sp->src           = this;
+  sp->dst           = dst;
+  splice_read       = sp;
+  dst->splice_write = sp;
+  NET_SUM_GLOBAL_DYN_STAT(net_splice_count_stat, 1);
+  Debug("iocore_net_splice", "splicing vc %p to vc %p with a pipe of %" PRId64 " bytes", this, dst, sp->size);
+  return true;
+}
+
+bool
+UnixNetVConnection::is_sendfile_capable() const
+{
+#if defined(linux)
+  return plainSocketIO();
+#else
+  return false;
+#endif
+}
+
+bool
+UnixNetVConnection::sendfile_from(int fd, off_t offset, int64_t len, const std::atomic<int64_t> *clock, int64_t limit)
+{
+  if (closed || sendfile_len > 0 || splice_write || write.vio.op != VIO::WRITE || !is_sendfile_capable()) {
+    return false;
+  }
+  sendfile_fd     = fd;
+  sendfile_offset = offset;
+  sendfile_len    = len;
+  sendfile_clock  = clock;
+  sendfile_limit  = limit;
+  NET_SUM_GLOBAL_DYN_STAT(net_sendfile_count_stat, 1);
+  return true;
+}
+
+int64_t
+UnixNetVConnection::sendfile_pending() const
+{
+  return sendfile_len;
+}
+
+int64_t
+UnixNetVConnection::get_sendfile_bytes() const
+{
+  return sendfile_bytes;
+}
+
+int64_t
+UnixNetVConnection::sendfile_and_write(int fd, off_t offset, int64_t towrite)
+{
+#if defined(linux)
+  ssize_t r = ::sendfile(con.fd, fd, &offset, towrite);
+  return r < 0 ? -errno : r;
+#else
+  (void)fd;
+  (void)offset;
+  (void)towrite;
+  return -ENOTSUP;
+#endif
+}
+
 void
 UnixNetVConnection::apply_options()
 {
@@ -1373,6 +1779,12 @@ UnixNetVConnection::migrateToCurrentThread(Continuation *cont, EThread *t)
   if (newvc) {
     newvc->set_context(get_context());
     newvc->options = this->options;
+    // the sends on the socket are now completed on the thread of the new VC
+    newvc->zerocopy   = this->zerocopy;
+    newvc->f.zerocopy = this->f.zerocopy;
+    this->zerocopy    = nullptr;
+    // so is the rate set on it
+    newvc->pacing = this->pacing;
   }
 
   // Do not mark this closed until the end so it does not get freed by the other thread too soon
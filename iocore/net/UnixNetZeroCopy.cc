@@ -0,0 +1,215 @@
+/** @file
+
+  Transmit with MSG_ZEROCOPY, keeping the sent blocks until the kernel is done with them
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_Net.h"
+
+#include <vector>
+
+#if TS_HAS_ZEROCOPY
+#include <linux/errqueue.h>
+#endif
+
+int net_config_zerocopy              = 0;
+int64_t net_config_zerocopy_min_size = 16384;
+
+// How often the sockets of closed connections are checked, and how long
+// they are kept open at most. A socket with sends still pending then is
+// reset, which drops the data queued on it, and its blocks are kept one more
+// period for the packets the driver has not finished transmitting.
+#define NET_ZEROCOPY_REAP_PERIOD HRTIME_MSECONDS(10)
+#define NET_ZEROCOPY_LINGER HRTIME_SECONDS(30)
+
+ClassAllocator<NetZeroCopy, true> netZeroCopyAllocator("netZeroCopyAllocator");
+
+namespace
+{
+// Closed sockets are only reaped by the thread that closed them, so the list needs no lock.
+thread_local std::vector<NetZeroCopy *> zerocopy_closed;
+thread_local ink_hrtime zerocopy_next_reap = 0;
+
+void
+close_socket(NetZeroCopy *zc)
+{
+  if (zc->pending()) {
+    // after a plain close() the kernel would go on retransmitting from the blocks
+    Debug("iocore_net_zerocopy", "resetting fd %d with %zu sends pending", zc->fd, zc->sends.size());
+    struct linger l;
+    l.l_onoff  = 1;
+    l.l_linger = 0;
+    safe_setsockopt(zc->fd, SOL_SOCKET, SO_LINGER, reinterpret_cast<char *>(&l), sizeof(l));
+  }
+  SocketManager::close(zc->fd);
+  zc->fd = NO_FD;
+}
+} // namespace
+
+bool
+NetZeroCopy::want(int fd)
+{
+#if TS_HAS_ZEROCOPY
+  if (off) {
+    return false;
+  }
+  if (!enabled) {
+    int on = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &on, sizeof(on)) < 0) {
+      Debug("iocore_net_zerocopy", "SO_ZEROCOPY failed on fd %d: %s", fd, strerror(errno));
+      off = true;
+      return false;
+    }
+    enabled = true;
+  }
+  return true;
+#else
+  (void)fd;
+  return false;
+#endif
+}
+
+void
+NetZeroCopy::sent(IOBufferReader *reader, int64_t len)
+{
+  Send s;
+  s.id     = next_id++;
+  s.len    = len;
+  s.blocks = make_ptr(iobufferblock_clone(reader->block.get(), reader->start_offset, len));
+  sends.push_back(std::move(s));
+}
+
+void
+NetZeroCopy::reap(int fd)
+{
+#if TS_HAS_ZEROCOPY
+  while (!sends.empty()) {
+    // the extended error is followed by the offender address, unused for these
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(struct sock_extended_err) + sizeof(struct sockaddr_in6))];
+    struct msghdr msg;
+
+    ink_zero(msg);
+    msg.msg_control    = control;
+    msg.msg_controllen = sizeof(control);
+    if (SocketManager::recvmsg(fd, &msg, MSG_ERRQUEUE) < 0) {
+      break;
+    }
+
+    for (struct cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+      if (!((cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) ||
+            (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR))) {
+        continue;
+      }
+      struct sock_extended_err ee;
+      memcpy(&ee, CMSG_DATA(cm), sizeof(ee));
+      if (ee.ee_errno != 0 || ee.ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+        continue;
+      }
+
+      // sends [ee_info, ee_data] are complete, compared so the numbers may wrap
+      uint32_t lo   = ee.ee_info;
+      uint32_t n    = ee.ee_data - lo;
+      bool copied   = ee.ee_code & SO_EE_CODE_ZEROCOPY_COPIED;
+      int64_t bytes = 0;
+      for (auto it = sends.begin(); it != sends.end();) {
+        if (it->id - lo <= n) {
+          bytes += it->len;
+          it = sends.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      if (copied) {
+        NET_SUM_GLOBAL_DYN_STAT(net_zerocopy_copied_bytes_stat, bytes);
+        if (!off) {
+          Debug("iocore_net_zerocopy", "fd %d: the kernel copied sends %u to %u, sending with copies", fd, lo, ee.ee_data);
+        }
+        off = true;
+      } else {
+        NET_SUM_GLOBAL_DYN_STAT(net_zerocopy_bytes_stat, bytes);
+      }
+    }
+  }
+#else
+  (void)fd;
+#endif
+}
+
+NetZeroCopy *
+new_NetZeroCopy()
+{
+#if TS_HAS_ZEROCOPY
+  return netZeroCopyAllocator.alloc();
+#else
+  return nullptr;
+#endif
+}
+
+void
+free_NetZeroCopy(NetZeroCopy *zc, int fd)
+{
+  if (fd == NO_FD || !zc->pending()) {
+    netZeroCopyAllocator.free(zc);
+    return;
+  }
+  // the kernel still reads the blocks of the pending sends, the socket is
+  // shut down as close() would and kept open until they complete
+  shutdown(fd, SHUT_WR);
+  zc->fd          = fd;
+  zc->linger_till = Thread::get_hrtime() + NET_ZEROCOPY_LINGER;
+  zerocopy_closed.push_back(zc);
+}
+
+void
+net_zerocopy_reap_closed()
+{
+  if (zerocopy_closed.empty()) {
+    return;
+  }
+  ink_hrtime now = Thread::get_hrtime();
+  if (now < zerocopy_next_reap) {
+    return;
+  }
+  zerocopy_next_reap = now + NET_ZEROCOPY_REAP_PERIOD;
+
+  for (size_t i = 0; i < zerocopy_closed.size();) {
+    NetZeroCopy *zc = zerocopy_closed[i];
+    if (zc->fd != NO_FD) {
+      zc->reap(zc->fd);
+      if (zc->pending() && now < zc->linger_till) {
+        ++i;
+        continue;
+      }
+      bool reset = zc->pending();
+      close_socket(zc);
+      if (reset) {
+        zc->linger_till = now + NET_ZEROCOPY_REAP_PERIOD;
+        ++i;
+        continue;
+      }
+    } else if (now < zc->linger_till) {
+      ++i;
+      continue;
+    }
+    netZeroCopyAllocator.free(zc);
+    zerocopy_closed[i] = zerocopy_closed.back();
+    zerocopy_closed.pop_back();
+  }
+}
@@ -32,6 +32,8 @@
 #include "P_Net.h"
 #include "P_UDPNet.h"
 
+#include <netinet/udp.h>
+
 UnixUDPConnection::~UnixUDPConnection()
 {
   UDPPacketInternal *p = nullptr;
@@ -109,6 +111,21 @@ UDPConnection::bindToThread(Continuation *c)
   AddRef();
   uc->continuation = c;
   mutex            = c->mutex;
+
+#ifdef UDP_SEGMENT
+  // a zero segment size only checks the kernel supports it, the size is given with each packet
+  int segment_size = 0;
+  if (g_udp_enable_gso &&
+      safe_setsockopt(uc->fd, SOL_UDP, UDP_SEGMENT, reinterpret_cast<char *>(&segment_size), sizeof(segment_size)) == 0) {
+    uc->gso_enabled = true;
+  }
+#endif
+#ifdef UDP_GRO
+  int enable = 1;
+  if (g_udp_enable_gro && safe_setsockopt(uc->fd, SOL_UDP, UDP_GRO, reinterpret_cast<char *>(&enable), sizeof(enable)) < 0) {
+    Debug("udpnet", "setsockopt for UDP_GRO failed: %s", strerror(errno));
+  }
+#endif
   get_UDPNetHandler(t)->newconn_list.push(uc);
 }
 
@@ -37,6 +37,8 @@
 #include "P_Net.h"
 #include "P_UDPNet.h"
 
+#include <netinet/udp.h>
+
 using UDPNetContHandler = int (UDPNetHandler::*)(int, void *);
 
 ClassAllocator<UDPPacketInternal> udpPacketAllocator("udpPacketAllocator");
@@ -52,6 +54,9 @@ UDPNetProcessor &udpNet = udpNetInternal;
 int32_t g_udp_periodicCleanupSlots;
 int32_t g_udp_periodicFreeCancelledPkts;
 int32_t g_udp_numSendRetries;
+int32_t g_udp_io_batch_size = 1;
+int32_t g_udp_enable_gso    = 0;
+int32_t g_udp_enable_gro    = 0;
 
 //
 // Public functions
@@ -91,6 +96,12 @@ initialize_thread_for_udp_net(EThread *thread)
   REC_ReadConfigInt32(g_udp_numSendRetries, "proxy.config.udp.send_retries");
   g_udp_numSendRetries = g_udp_numSendRetries < 0 ? 0 : g_udp_numSendRetries;
 
+  // Datagrams read or sent with one recvmmsg() or sendmmsg(), and whether the
+  // kernel segments (GSO) and coalesces (GRO) the datagrams of a flow.
+  REC_ReadConfigInt32(g_udp_io_batch_size, "proxy.config.udp.io_batch_size");
+  REC_ReadConfigInt32(g_udp_enable_gso, "proxy.config.udp.enable_gso");
+  REC_ReadConfigInt32(g_udp_enable_gro, "proxy.config.udp.enable_gro");
+
   thread->set_tail_handler(nh);
   thread->ep = static_cast<EventIO *>(ats_malloc(sizeof(EventIO)));
   new (thread->ep) EventIO();
@@ -119,135 +130,139 @@ UDPNetProcessorInternal::start(int n_upd_threads, size_t stacksize)
   return 0;
 }
 
+static void
+udp_queue_packet(UnixUDPConnection *uc, sockaddr_in6 &fromaddr, sockaddr_in6 &toaddr, Ptr<IOBufferBlock> &chain)
+{
+  UDPPacket *p = new_incoming_UDPPacket(ats_ip_sa_cast(&fromaddr), ats_ip_sa_cast(&toaddr), chain);
+  p->setConnection(uc);
+  // queue onto the UDPConnection
+  uc->inQueue.push((UDPPacketInternal *)p);
+}
+
 void
 UDPNetProcessorInternal::udp_read_from_net(UDPNetHandler *nh, UDPConnection *xuc)
 {
   UnixUDPConnection *uc = (UnixUDPConnection *)xuc;
 
-  // receive packet and queue onto UDPConnection.
+  // receive packets and queue onto UDPConnection.
   // don't call back connection at this time.
-  int64_t r;
-  int iters         = 0;
-  unsigned max_niov = 32;
-
-  struct msghdr msg;
-  Ptr<IOBufferBlock> chain, next_chain;
-  struct iovec tiovec[max_niov];
-  int64_t size_index  = BUFFER_SIZE_INDEX_2K;
-  int64_t buffer_size = BUFFER_SIZE_FOR_INDEX(size_index);
-  // The max length of receive buffer is 32 * buffer_size (2048) = 65536 bytes.
-  // Because the 'UDP Length' is type of uint16_t defined in RFC 768.
+  int r;
+  int iters  = 0;
+  int npkts  = 0;
+  int nbatch = std::clamp(g_udp_io_batch_size, 1, UDP_IO_BATCH_MAX);
+
+  struct mmsghdr msg[UDP_IO_BATCH_MAX];
+  struct iovec tiovec[UDP_IO_BATCH_MAX];
+  sockaddr_in6 fromaddr[UDP_IO_BATCH_MAX];
+  alignas(struct cmsghdr) char cbuf[UDP_IO_BATCH_MAX][256];
+  // Each datagram is read into a 64K block. Because the 'UDP Length' is type of uint16_t defined in RFC 768.
   // And there is 8 octets in 'User Datagram Header' which means the max length of payload is no more than 65527 bytes.
+  // The datagrams of a flow coalesced by UDP_GRO are no longer than that either.
+  int64_t size_index = BUFFER_SIZE_INDEX_64K;
+
+  sockaddr_in6 bindaddr;
+  int bindaddr_len = sizeof(bindaddr);
+  safe_getsockname(xuc->getFd(), reinterpret_cast<struct sockaddr *>(&bindaddr), &bindaddr_len);
+
   do {
-    // create IOBufferBlock chain to receive data
-    unsigned int niov;
-    IOBufferBlock *b, *last;
-
-    // build struct iov
-    // reuse the block in chain if available
-    b    = chain.get();
-    last = nullptr;
-    for (niov = 0; niov < max_niov; niov++) {
-      if (b == nullptr) {
+    // build struct mmsghdr, the blocks of the last read are reused
+    for (int i = 0; i < nbatch; i++) {
+      Ptr<IOBufferBlock> &b = nh->recv_blocks[i];
+      if (!b) {
         b = new_IOBufferBlock();
         b->alloc(size_index);
-        if (last == nullptr) {
-          chain = b;
-        } else {
-          last->next = b;
-        }
       }
-
-      tiovec[niov].iov_base = b->buf();
-      tiovec[niov].iov_len  = b->block_size();
-
-      last = b;
-      b    = b->next.get();
+      tiovec[i].iov_base = b->buf();
+      tiovec[i].iov_len  = b->block_size();
+
+      ink_zero(msg[i]);
+      msg[i].msg_hdr.msg_name       = &fromaddr[i];
+      msg[i].msg_hdr.msg_namelen    = sizeof(fromaddr[i]);
+      msg[i].msg_hdr.msg_iov        = &tiovec[i];
+      msg[i].msg_hdr.msg_iovlen     = 1;
+      msg[i].msg_hdr.msg_control    = cbuf[i];
+      msg[i].msg_hdr.msg_controllen = sizeof(cbuf[i]);
     }
 
-    // build struct msghdr
-    sockaddr_in6 fromaddr;
-    sockaddr_in6 toaddr;
-    int toaddr_len = sizeof(toaddr);
-    char *cbuf[1024];
-    msg.msg_name       = &fromaddr;
-    msg.msg_namelen    = sizeof(fromaddr);
-    msg.msg_iov        = tiovec;
-    msg.msg_iovlen     = niov;
-    msg.msg_control    = cbuf;
-    msg.msg_controllen = sizeof(cbuf);
-
-    // receive data by recvmsg
-    r = SocketManager::recvmsg(uc->getFd(), &msg, 0);
+    // receive data by recvmmsg
+    r = SocketManager::recvmmsg(uc->getFd(), msg, nbatch, 0);
     if (r <= 0) {
       // error
       break;
     }
 
-    // truncated check
-    if (msg.msg_flags & MSG_TRUNC) {
-      Debug("udp-read", "The UDP packet is truncated");
-    }
+    for (int i = 0; i < r; i++) {
+      struct msghdr *m    = &msg[i].msg_hdr;
+      int64_t len         = msg[i].msg_len;
+      int gso_size        = 0;
+      sockaddr_in6 toaddr = bindaddr;
 
-    // fill the IOBufferBlock chain
-    int64_t saved = r;
-    b             = chain.get();
-    while (b && saved > 0) {
-      if (saved > buffer_size) {
-        b->fill(buffer_size);
-        saved -= buffer_size;
-        b = b->next.get();
-      } else {
-        b->fill(saved);
-        saved      = 0;
-        next_chain = b->next.get();
-        b->next    = nullptr;
+      // truncated check
+      if (m->msg_flags & MSG_TRUNC) {
+        Debug("udp-read", "The UDP packet is truncated");
       }
-    }
 
-    safe_getsockname(xuc->getFd(), reinterpret_cast<struct sockaddr *>(&toaddr), &toaddr_len);
-    for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
-      switch (cmsg->cmsg_type) {
+      for (auto cmsg = CMSG_FIRSTHDR(m); cmsg != nullptr; cmsg = CMSG_NXTHDR(m, cmsg)) {
+        switch (cmsg->cmsg_type) {
 #ifdef IP_PKTINFO
-      case IP_PKTINFO:
-        if (cmsg->cmsg_level == IPPROTO_IP) {
-          struct in_pktinfo *pktinfo                                = reinterpret_cast<struct in_pktinfo *>(CMSG_DATA(cmsg));
-          reinterpret_cast<sockaddr_in *>(&toaddr)->sin_addr.s_addr = pktinfo->ipi_addr.s_addr;
-        }
-        break;
+        case IP_PKTINFO:
+          if (cmsg->cmsg_level == IPPROTO_IP) {
+            struct in_pktinfo *pktinfo                                = reinterpret_cast<struct in_pktinfo *>(CMSG_DATA(cmsg));
+            reinterpret_cast<sockaddr_in *>(&toaddr)->sin_addr.s_addr = pktinfo->ipi_addr.s_addr;
+          }
+          break;
 #endif
 #ifdef IP_RECVDSTADDR
-      case IP_RECVDSTADDR:
-        if (cmsg->cmsg_level == IPPROTO_IP) {
-          struct in_addr *addr                                      = reinterpret_cast<struct in_addr *>(CMSG_DATA(cmsg));
-          reinterpret_cast<sockaddr_in *>(&toaddr)->sin_addr.s_addr = addr->s_addr;
-        }
-        break;
+        case IP_RECVDSTADDR:
+          if (cmsg->cmsg_level == IPPROTO_IP) {
+            struct in_addr *addr                                      = reinterpret_cast<struct in_addr *>(CMSG_DATA(cmsg));
+            reinterpret_cast<sockaddr_in *>(&toaddr)->sin_addr.s_addr = addr->s_addr;
+          }
+          break;
 #endif
 #if defined(IPV6_PKTINFO) || defined(IPV6_RECVPKTINFO)
-      case IPV6_PKTINFO: // IPV6_RECVPKTINFO uses IPV6_PKTINFO too
-        if (cmsg->cmsg_level == IPPROTO_IPV6) {
-          struct in6_pktinfo *pktinfo = reinterpret_cast<struct in6_pktinfo *>(CMSG_DATA(cmsg));
-          memcpy(toaddr.sin6_addr.s6_addr, &pktinfo->ipi6_addr, 16);
-        }
-        break;
+        case IPV6_PKTINFO: // IPV6_RECVPKTINFO uses IPV6_PKTINFO too
+          if (cmsg->cmsg_level == IPPROTO_IPV6) {
+            struct in6_pktinfo *pktinfo = reinterpret_cast<struct in6_pktinfo *>(CMSG_DATA(cmsg));
+            memcpy(toaddr.sin6_addr.s6_addr, &pktinfo->ipi6_addr, 16);
+          }
+          break;
+#endif
+#ifdef UDP_GRO
+        case UDP_GRO:
+          if (cmsg->cmsg_level == SOL_UDP) {
+            memcpy(&gso_size, CMSG_DATA(cmsg), sizeof(gso_size));
+          }
+          break;
 #endif
+        }
       }
-    }
 
-    // create packet
-    UDPPacket *p = new_incoming_UDPPacket(ats_ip_sa_cast(&fromaddr), ats_ip_sa_cast(&toaddr), chain);
-    p->setConnection(uc);
-    // queue onto the UDPConnection
-    uc->inQueue.push((UDPPacketInternal *)p);
-
-    // reload the unused block
-    chain      = next_chain;
-    next_chain = nullptr;
+      IOBufferBlock *b = nh->recv_blocks[i].get();
+      if (gso_size > 0 && len > gso_size) {
+        // the datagrams coalesced by GRO are handed out as pieces of the block
+        b->fill(len);
+        for (int64_t offset = 0; offset < len; offset += gso_size) {
+          Ptr<IOBufferBlock> chain = make_ptr(iobufferblock_clone(b, offset, std::min<int64_t>(gso_size, len - offset)));
+          udp_queue_packet(uc, fromaddr[i], toaddr, chain);
+          npkts++;
+        }
+        nh->recv_blocks[i] = nullptr;
+      } else {
+        // a single datagram is copied, so the large block is not held by a small packet
+        Ptr<IOBufferBlock> chain = make_ptr(new_IOBufferBlock());
+        chain->alloc(iobuffer_size_to_index(len, size_index));
+        memcpy(chain->end(), b->start(), len);
+        chain->fill(len);
+        udp_queue_packet(uc, fromaddr[i], toaddr, chain);
+        npkts++;
+      }
+    }
     iters++;
-  } while (r > 0);
+    // a short read emptied the socket, the next datagram triggers another poll event
+  } while (r == nbatch);
   if (iters >= 1) {
-    Debug("udp-read", "read %d at a time", iters);
+    Debug("udp-read", "read %d in %d calls", npkts, iters);
   }
   // if not already on to-be-called-back queue, then add it.
   if (!uc->onCallbackQueue) {
@@ -911,6 +926,9 @@ UDPQueue::SendPackets()
   int32_t bytesThisSlot = INT_MAX, bytesUsed = 0;
   int32_t bytesThisPipe, sentOne;
   int64_t pktLen;
+  UDPPacketInternal *batch[UDP_IO_BATCH_MAX];
+  int nbatch    = 0;
+  int batchSize = std::clamp(g_udp_io_batch_size, 1, UDP_IO_BATCH_MAX);
 
   bytesThisSlot = INT_MAX;
 
@@ -929,9 +947,19 @@ sendPackets:
       goto next_pkt;
     }
 
-    SendUDPPacket(p, pktLen);
+    // the packet is freed once its batch is sent
+    batch[nbatch++] = p;
+    if (nbatch == batchSize) {
+      SendUDPPackets(batch, nbatch);
+      nbatch = 0;
+    }
     bytesUsed += pktLen;
     bytesThisPipe -= pktLen;
+    sentOne = true;
+    if (bytesThisPipe < 0) {
+      break;
+    }
+    continue;
   next_pkt:
     sentOne = true;
     p->free();
@@ -940,6 +968,10 @@ sendPackets:
       break;
     }
   }
+  if (nbatch) {
+    SendUDPPackets(batch, nbatch);
+    nbatch = 0;
+  }
 
   bytesThisSlot -= bytesUsed;
 
@@ -958,53 +990,120 @@ sendPackets:
   }
 }
 
-void
-UDPQueue::SendUDPPacket(UDPPacketInternal *p, int32_t /* pktLen ATS_UNUSED */)
+// Send the messages of a sendmmsg() batch, all to the socket of conn.
+static void
+udp_send_batch(UDPConnectionInternal *conn, struct mmsghdr *msg, int nmsg)
 {
-  struct msghdr msg;
-  struct iovec iov[32];
-  int n, count, iov_len = 0;
-
-  p->conn->lastSentPktStartTime = p->delivery_time;
-  Debug("udp-send", "Sending %p", p);
-
-#if !defined(solaris)
-  msg.msg_control    = nullptr;
-  msg.msg_controllen = 0;
-  msg.msg_flags      = 0;
-#endif
-  msg.msg_name    = reinterpret_cast<caddr_t>(&p->to.sa);
-  msg.msg_namelen = ats_ip_size(p->to);
-  iov_len         = 0;
-
-  for (IOBufferBlock *b = p->chain.get(); b != nullptr; b = b->next.get()) {
-    iov[iov_len].iov_base = static_cast<caddr_t>(b->start());
-    iov[iov_len].iov_len  = b->size();
-    iov_len++;
-  }
-  msg.msg_iov    = iov;
-  msg.msg_iovlen = iov_len;
-
-  count = 0;
-  while (true) {
-    // stupid Linux problem: sendmsg can return EAGAIN
-    n = ::sendmsg(p->conn->getFd(), &msg, 0);
-    if ((n >= 0) || (errno != EAGAIN)) {
-      // send succeeded or some random error happened.
-      if (n < 0) {
-        Debug("udp-send", "Error: %s (%d)", strerror(errno), errno);
-      }
-
-      break;
+  int sent  = 0;
+  int count = 0;
+
+  while (sent < nmsg) {
+    int n = SocketManager::sendmmsg(conn->getFd(), msg + sent, nmsg - sent, 0);
+    if (n > 0) {
+      sent += n;
+      continue;
     }
-    if (errno == EAGAIN) {
+    // stupid Linux problem: sendmsg can return EAGAIN
+    if (n == -EAGAIN) {
       ++count;
       if ((g_udp_numSendRetries > 0) && (count >= g_udp_numSendRetries)) {
         // tried too many times; give up
         Debug("udpnet", "Send failed: too many retries");
         break;
       }
+      continue;
     }
+    // some random error happened, the message is dropped
+    Debug("udp-send", "Error: %s (%d)", strerror(-n), -n);
+#ifdef UDP_SEGMENT
+    // EIO: the device cannot checksum the segments, the transport recovers the lost datagrams
+    if (n == -EIO && msg[sent].msg_hdr.msg_controllen && conn->gso_enabled) {
+      Warning("UDP segmentation offload failed on fd %d, sending each datagram", conn->getFd());
+      conn->gso_enabled = false;
+    }
+#endif
+    sent++;
+  }
+}
+
+/*
+ * Send packets with as few sendmmsg() calls as possible. A segmented packet
+ * is one message with UDP_SEGMENT if the kernel segments it, one message
+ * per datagram otherwise.
+ */
+void
+UDPQueue::SendUDPPackets(UDPPacketInternal **p, int n)
+{
+  constexpr int max_msg = UDP_IO_BATCH_MAX * 2;
+  constexpr int max_iov = 1024;
+
+  struct mmsghdr msg[max_msg];
+  struct iovec iov[max_iov];
+  alignas(struct cmsghdr) char cbuf[max_msg][CMSG_SPACE(sizeof(uint16_t))];
+  UDPConnectionInternal *conn = nullptr;
+  int nmsg = 0, niov = 0;
+
+  for (int i = 0; i < n; i++) {
+    UDPPacketInternal *pkt = p[i];
+    int segment_size       = pkt->getSegmentSize();
+    bool gso               = segment_size && pkt->conn->gso_enabled;
+    int nblocks            = 0;
+    for (IOBufferBlock *b = pkt->chain.get(); b != nullptr; b = b->next.get()) {
+      nblocks++;
+    }
+    int nmsg_pkt = (segment_size && !gso) ? nblocks : 1;
+
+    // a batch is sent to one socket
+    if (nmsg && (pkt->conn != conn || nmsg + nmsg_pkt > max_msg || niov + nblocks > max_iov)) {
+      udp_send_batch(conn, msg, nmsg);
+      nmsg = niov = 0;
+    }
+    conn = pkt->conn;
+
+    pkt->conn->lastSentPktStartTime = pkt->delivery_time;
+    Debug("udp-send", "Sending %p", pkt);
+
+    struct msghdr *m = nullptr;
+    for (IOBufferBlock *b = pkt->chain.get(); b != nullptr; b = b->next.get()) {
+      // each datagram of a segmented packet is a message when the kernel does not segment it
+      if (m == nullptr || (segment_size && !gso)) {
+        m = &msg[nmsg++].msg_hdr;
+        ink_zero(*m);
+        m->msg_name    = reinterpret_cast<caddr_t>(&pkt->to.sa);
+        m->msg_namelen = ats_ip_size(pkt->to);
+        m->msg_iov     = &iov[niov];
+      }
+      iov[niov].iov_base = static_cast<caddr_t>(b->start());
+      iov[niov].iov_len  = b->size();
+      niov++;
+      m->msg_iovlen++;
+    }
+    if (m == nullptr) {
+      // an empty datagram
+      m = &msg[nmsg++].msg_hdr;
+      ink_zero(*m);
+      m->msg_name    = reinterpret_cast<caddr_t>(&pkt->to.sa);
+      m->msg_namelen = ats_ip_size(pkt->to);
+    }
+#ifdef UDP_SEGMENT
+    if (gso) {
+      uint16_t size      = segment_size;
+      m->msg_control     = cbuf[nmsg - 1];
+      m->msg_controllen  = sizeof(cbuf[nmsg - 1]);
+      struct cmsghdr *cm = CMSG_FIRSTHDR(m);
+      cm->cmsg_level     = SOL_UDP;
+      cm->cmsg_type      = UDP_SEGMENT;
+      cm->cmsg_len       = CMSG_LEN(sizeof(size));
+      memcpy(CMSG_DATA(cm), &size, sizeof(size));
+    }
+#endif
+  }
+  if (nmsg) {
+    udp_send_batch(conn, msg, nmsg);
+  }
+
+  for (int i = 0; i < n; i++) {
+    p[i]->free();
   }
 }
 
@@ -1059,8 +1158,10 @@ int
 UDPNetHandler::waitForActivity(ink_hrtime timeout)
 {
   UnixUDPConnection *uc;
-  PollCont *pc = get_UDPPollCont(this->thread);
+  PollCont *pc     = get_UDPPollCont(this->thread);
+  ink_hrtime start = Thread::get_hrtime_updated();
   pc->do_poll(timeout);
+  this->thread->loop_wait_time += Thread::get_hrtime_updated() - start;
 
   /* Notice: the race between traversal of newconn_list and UDPBind()
    *
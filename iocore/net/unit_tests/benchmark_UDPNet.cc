@@ -0,0 +1,302 @@
+/** @file
+
+  Loopback benchmark of the UDP threads: datagrams per second per core
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include <netinet/udp.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "tscore/I_Layout.h"
+
+#include "P_Net.h"
+#include "P_UDPNet.h"
+
+#include "diags.i"
+
+// A single UDP thread echoes every datagram, the client keeps BURST
+// datagrams of DATAGRAM_SIZE bytes in flight with recvmmsg / sendmmsg
+// (and UDP_SEGMENT in the offload mode). The UDP thread's CPU time gives
+// the datagrams it reads and writes per second per core.
+
+namespace
+{
+constexpr int DATAGRAM_SIZE = 1200;
+constexpr int BURST         = 32; // a segmented send is at most 64KB
+
+struct Mode {
+  const char *name;
+  int batch_size;
+  bool offload; // GSO on send, GRO on receive
+};
+
+const Mode modes[] = {
+  {"recvmsg/sendmsg", 1, false},
+  {"recvmmsg/sendmmsg", 32, false},
+  {"mmsg + GSO/GRO", 32, true},
+};
+
+double
+seconds_per_mode()
+{
+  const char *s = getenv("UDP_BENCH_SECONDS");
+  return s ? atof(s) : 1.0;
+}
+
+class EchoServer : public Continuation
+{
+public:
+  explicit EchoServer(const Mode &m) : Continuation(new_ProxyMutex()), mode(m) { SET_HANDLER(&EchoServer::start); }
+
+  int
+  start(int, void *)
+  {
+    SET_HANDLER(&EchoServer::handle_packet);
+    // set on the UDP thread, which reads them
+    g_udp_io_batch_size = mode.batch_size;
+    g_udp_enable_gso    = mode.offload;
+    g_udp_enable_gro    = mode.offload;
+    pthread_getcpuclockid(pthread_self(), &cpu_clock);
+
+    sockaddr_in addr;
+    ink_zero(addr);
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    udpNet.UDPBind(this, reinterpret_cast<sockaddr const *>(&addr), -1, 4 * 1048576, 4 * 1048576);
+    return EVENT_DONE;
+  }
+
+  int
+  handle_packet(int event, void *data)
+  {
+    switch (event) {
+    case NET_EVENT_DATAGRAM_OPEN:
+      con = static_cast<UDPConnection *>(data);
+      // the connection is polled after another pass of the event loop
+      eventProcessor.schedule_in(this, 1, ET_UDP);
+      break;
+
+    case EVENT_INTERVAL:
+      port = con->getPortNum();
+      break;
+
+    case NET_EVENT_DATAGRAM_READ_READY: {
+      Queue<UDPPacket> *q = static_cast<Queue<UDPPacket> *>(data);
+      UDPPacket *train    = nullptr;
+
+      while (UDPPacket *p = q->pop()) {
+        if (!mode.offload) {
+          p->to = p->from;
+          con->send(this, p);
+          continue;
+        }
+        // coalesce the datagrams of the flow like QUIC does
+        Ptr<IOBufferBlock> block = make_ptr(p->getIOBlockChain());
+        if (train && (!ats_ip_addr_port_eq(&train->to.sa, &p->from.sa) || !train->append_segment(block.get()))) {
+          con->send(this, train);
+          train = nullptr;
+        }
+        if (train == nullptr) {
+          train = new_UDPPacket();
+          ats_ip_copy(&train->to, &p->from);
+          train->append_segment(block.get());
+        }
+        p->free();
+      }
+      if (train) {
+        con->send(this, train);
+      }
+      get_UDPNetHandler(this_ethread())->signalActivity();
+      break;
+    }
+
+    default:
+      std::printf("unexpected event %d\n", event);
+      std::exit(EXIT_FAILURE);
+    }
+    return EVENT_CONT;
+  }
+
+  double
+  cpu_seconds() const
+  {
+    timespec ts;
+    clock_gettime(cpu_clock, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+  }
+
+  const Mode &mode;
+  UDPConnection *con = nullptr;
+  std::atomic<int> port{0};
+  clockid_t cpu_clock;
+};
+
+// Send BURST datagrams, the echoes are awaited by the caller.
+void
+client_send(int fd, const Mode &mode, char *payload)
+{
+  struct iovec iov[BURST];
+  struct mmsghdr msg[BURST];
+
+  if (mode.offload) {
+#ifdef UDP_SEGMENT
+    alignas(struct cmsghdr) char cbuf[CMSG_SPACE(sizeof(uint16_t))];
+    uint16_t size      = DATAGRAM_SIZE;
+    struct iovec one   = {payload, static_cast<size_t>(DATAGRAM_SIZE) * BURST};
+    struct msghdr m    = {};
+    m.msg_iov          = &one;
+    m.msg_iovlen       = 1;
+    m.msg_control      = cbuf;
+    m.msg_controllen   = sizeof(cbuf);
+    struct cmsghdr *cm = CMSG_FIRSTHDR(&m);
+    cm->cmsg_level     = SOL_UDP;
+    cm->cmsg_type      = UDP_SEGMENT;
+    cm->cmsg_len       = CMSG_LEN(sizeof(size));
+    memcpy(CMSG_DATA(cm), &size, sizeof(size));
+    if (SocketManager::sendmsg(fd, &m, 0) >= 0) {
+      return;
+    }
+#endif
+  }
+  for (int i = 0; i < BURST; i++) {
+    iov[i] = {payload + i * DATAGRAM_SIZE, DATAGRAM_SIZE};
+    ink_zero(msg[i]);
+    msg[i].msg_hdr.msg_iov    = &iov[i];
+    msg[i].msg_hdr.msg_iovlen = 1;
+  }
+  SocketManager::sendmmsg(fd, msg, BURST, 0);
+}
+
+// Receive the echoes of a burst, those lost are given up on after 100ms.
+int64_t
+client_recv(int fd, char *buf)
+{
+  struct iovec iov[BURST];
+  struct mmsghdr msg[BURST];
+  int64_t received = 0;
+
+  while (received < BURST) {
+    for (int i = 0; i < BURST; i++) {
+      iov[i] = {buf + i * DATAGRAM_SIZE, DATAGRAM_SIZE};
+      ink_zero(msg[i]);
+      msg[i].msg_hdr.msg_iov    = &iov[i];
+      msg[i].msg_hdr.msg_iovlen = 1;
+    }
+    // block for the first datagram only
+    int r = SocketManager::recvmmsg(fd, msg, BURST - received, MSG_WAITFORONE);
+    if (r <= 0) {
+      break;
+    }
+    received += r;
+  }
+  return received;
+}
+
+struct EchoResult {
+  int64_t datagrams;
+  double seconds;
+  double cpu_seconds;
+};
+
+EchoResult
+run(const Mode &mode)
+{
+  EchoServer *server = new EchoServer(mode);
+  eventProcessor.schedule_imm(server, ET_UDP);
+  while (server->port == 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  REQUIRE(fd >= 0);
+  timeval tv = {0, 100000};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  int bufsize = 4 * 1048576;
+  setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufsize, sizeof(bufsize));
+
+  sockaddr_in addr;
+  ink_zero(addr);
+  addr.sin_family      = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port        = htons(server->port);
+  REQUIRE(connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0);
+
+  static char payload[DATAGRAM_SIZE * BURST];
+  static char buf[DATAGRAM_SIZE * BURST];
+  EchoResult result{0, 0, 0};
+
+  double cpu0 = server->cpu_seconds();
+  auto start  = std::chrono::steady_clock::now();
+  auto end    = start + std::chrono::duration<double>(seconds_per_mode());
+  while (std::chrono::steady_clock::now() < end) {
+    client_send(fd, mode, payload);
+    result.datagrams += client_recv(fd, buf);
+  }
+  result.seconds     = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  result.cpu_seconds = server->cpu_seconds() - cpu0;
+
+  close(fd);
+  return result;
+}
+} // namespace
+
+struct EventProcessorListener : Catch::TestEventListenerBase {
+  using TestEventListenerBase::TestEventListenerBase;
+
+  void
+  testRunStarting(Catch::TestRunInfo const &testRunInfo) override
+  {
+    Layout::create();
+    init_diags("", nullptr);
+    RecProcessInit(RECM_STAND_ALONE);
+
+    ink_event_system_init(EVENT_SYSTEM_MODULE_PUBLIC_VERSION);
+    eventProcessor.start(1, 1048576); // Hardcoded stacksize at 1MB
+    udpNet.start(1, 1048576);
+
+    EThread *main_thread = new EThread;
+    main_thread->set_specific();
+  }
+};
+
+CATCH_REGISTER_LISTENER(EventProcessorListener);
+
+TEST_CASE("UDPNet loopback echo", "[iocore][udp][benchmark]")
+{
+  std::printf("%-20s %12s %14s %12s %18s\n", "mode", "datagrams", "datagrams/s", "udp cpu s", "datagrams/s/core");
+  for (const Mode &mode : modes) {
+    EchoResult r = run(mode);
+    // each echoed datagram is read and written by the UDP thread
+    double per_core = r.cpu_seconds > 0 ? 2 * r.datagrams / r.cpu_seconds : 0;
+    std::printf("%-20s %12" PRId64 " %14.0f %12.3f %18.0f\n", mode.name, r.datagrams, r.datagrams / r.seconds, r.cpu_seconds,
+                per_core);
+    CHECK(r.datagrams > 0);
+  }
+}
@@ -241,6 +241,12 @@ ProxyTransaction::allow_half_open() const
   return false;
 }
 
+bool
+ProxyTransaction::allow_splice() const
+{
+  return false;
+}
+
 // Most protocols will not want to set the Connection: header
 // For H2 it will initiate the drain logic.  So we make do nothing
 // the default action.
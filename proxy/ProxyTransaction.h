@@ -64,6 +64,8 @@ public:
   virtual int get_transaction_priority_weight() const;
   virtual int get_transaction_priority_dependence() const;
   virtual bool allow_half_open() const;
+  /// Whether the body of this transaction is the byte stream of its NetVConnection, so it may be spliced.
+  virtual bool allow_splice() const;
 
   virtual void increment_transactions_stat() = 0;
   virtual void decrement_transactions_stat() = 0;
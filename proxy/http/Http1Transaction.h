@@ -42,6 +42,7 @@ public:
   ////////////////////
   // Methods
   int get_transaction_id() const override;
+  bool allow_splice() const override;
   void set_reader(IOBufferReader *reader);
   void set_close_connection(HTTPHdr &hdr) const override;
 
@@ -61,6 +62,13 @@ Http1Transaction::get_transaction_id() const
   return _proxy_ssn->get_transact_count();
 }
 
+// There is one transaction at a time on the connection.
+inline bool
+Http1Transaction::allow_splice() const
+{
+  return true;
+}
+
 inline void
 Http1Transaction::reset()
 {
@@ -1272,6 +1272,7 @@ HttpConfig::startup()
   HttpEstablishStaticConfigLongLong(c.oride.sock_packet_mark_out, "proxy.config.net.sock_packet_mark_out");
   HttpEstablishStaticConfigLongLong(c.oride.sock_packet_tos_out, "proxy.config.net.sock_packet_tos_out");
   HttpEstablishStaticConfigLongLong(c.oride.sock_packet_notsent_lowat, "proxy.config.net.sock_notsent_lowat");
+  HttpEstablishStaticConfigLongLong(c.oride.sock_pacing_rate_in, "proxy.config.net.sock_pacing_rate_in");
 
   HttpEstablishStaticConfigByte(c.oride.fwd_proxy_auth_to_parent, "proxy.config.http.forward.proxy_auth_to_parent");
 
@@ -1572,6 +1573,7 @@ HttpConfig::reconfigure()
   params->oride.sock_packet_tos_out       = m_master.oride.sock_packet_tos_out;
   params->oride.sock_option_flag_out      = m_master.oride.sock_option_flag_out;
   params->oride.sock_packet_notsent_lowat = m_master.oride.sock_packet_notsent_lowat;
+  params->oride.sock_pacing_rate_in       = m_master.oride.sock_pacing_rate_in;
 
   // Clear the TCP Fast Open option if it is not supported on this host.
   if ((params->oride.sock_option_flag_out & NetVCOptions::SOCK_OPT_TCP_FAST_OPEN) && !SocketManager::fastopen_supported()) {
@@ -640,6 +640,7 @@ struct OverridableHttpConfigParams {
   MgmtInt sock_packet_mark_out      = 0;
   MgmtInt sock_packet_tos_out       = 0;
   MgmtInt sock_packet_notsent_lowat = 0;
+  MgmtInt sock_pacing_rate_in       = 0;
 
   ///////////////
   // Hdr Limit //
@@ -1720,6 +1720,10 @@ HttpSM::handle_api_return()
     // Set back the inactivity timeout
     if (ua_txn) {
       ua_txn->set_inactivity_timeout(HRTIME_SECONDS(t_state.txn_conf->transaction_no_activity_timeout_in));
+      // Pace the response, the rate may have been set by remap or a plugin
+      if (NetVConnection *netvc = ua_txn->get_netvc(); netvc) {
+        netvc->set_pacing_rate(t_state.txn_conf->sock_pacing_rate_in);
+      }
     }
 
     // We only follow 3xx when redirect_in_process == false. Otherwise the redirection has already been launched (in
@@ -2518,6 +2522,12 @@ HttpSM::state_cache_open_write(int event, void *data)
     break;
 
   case CACHE_EVENT_OPEN_WRITE_FAILED:
+    // Not admitted to the cache, proxy only
+    if (cache_sm.get_last_error() == -ECACHE_NOT_ADMITTED) {
+      t_state.cache_open_write_fail_action = CACHE_WL_FAIL_ACTION_DEFAULT;
+      t_state.cache_info.write_lock_state  = HttpTransact::CACHE_WL_FAIL;
+      break;
+    }
     // Failed on the write lock and retrying the vector
     //  for reading
     if (t_state.redirect_info.redirect_in_process) {
@@ -2701,12 +2711,15 @@ HttpSM::main_handler(int event, void *data)
     jump_point = static_cast<VIO *>(data) == vc_entry->read_vio ? vc_entry->vc_read_handler : vc_entry->vc_write_handler;
     ink_assert(jump_point != (HttpSMHandler) nullptr);
     ink_assert(vc_entry->vc != (VConnection *)nullptr);
-    (this->*jump_point)(event, data);
   } else {
-    ink_assert(default_handler != (HttpSMHandler) nullptr);
-    (this->*default_handler)(event, data);
+    jump_point = default_handler;
+    ink_assert(jump_point != (HttpSMHandler) nullptr);
   }
 
+  // A sampled dispatch is charged to the state instead of this handler.
+  this_ethread()->dispatch_to(this, &HttpSM::main_handler, continuation_handler_address(this, jump_point));
+  (this->*jump_point)(event, data);
+
   // The sub-handler signals when it is time for the state
   //  machine to exit.  We can only exit if we are not reentrantly
   //  called otherwise when the our call unwinds, we will be
@@ -3408,6 +3421,9 @@ HttpSM::tunnel_handler_ua(int event, HttpTunnelConsumer *c)
     break;
   case HttpTransact::SOURCE_CACHE:
     cache_response_body_bytes = client_response_body_bytes;
+    if (NetVConnection *netvc = ua_txn->get_netvc(); netvc) {
+      client_response_sendfile_bytes = netvc->get_sendfile_bytes() - client_sendfile_bytes_base;
+    }
     break;
   default:
     break;
@@ -6410,6 +6426,9 @@ HttpSM::setup_cache_read_transfer()
   HttpTunnelProducer *p = tunnel.add_producer(cache_sm.cache_read_vc, doc_size, buf_start, &HttpSM::tunnel_handler_cache_read,
                                               HT_CACHE_READ, "cache read");
   tunnel.add_consumer(ua_entry->vc, cache_sm.cache_read_vc, &HttpSM::tunnel_handler_ua, HT_HTTP_CLIENT, "user agent");
+  if (NetVConnection *netvc = ua_txn->get_netvc(); netvc) {
+    client_sendfile_bytes_base = netvc->get_sendfile_bytes();
+  }
   // if size of a cached item is not known, we'll do chunking for keep-alive HTTP/1.1 clients
   // this only applies to read-while-write cases where origin server sends a dynamically generated chunked content
   // w/o providing a Content-Length header
@@ -560,6 +560,12 @@ public:
   int client_alpn_id              = SessionProtocolNameRegistry::INVALID;
   int server_transact_count       = 0;
 
+  /// Part of client_response_body_bytes sent from the cache disk, see CacheVConnection::sendfile_to().
+  int64_t client_response_sendfile_bytes = 0;
+
+  /// Bytes the client connection sent from files before the cache read of this transaction.
+  int64_t client_sendfile_bytes_base = 0;
+
   TransactionMilestones milestones;
   ink_hrtime api_timer = 0;
   // The next two enable plugins to tag the state machine for
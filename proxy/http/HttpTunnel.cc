@@ -1012,6 +1012,10 @@ HttpTunnel::producer_run(HttpTunnelProducer *p)
       }
     }
   }
+  if (p->read_vio) {
+    producer_splice(p);
+    producer_sendfile(p);
+  }
 
   // Now that the tunnel has started, we must remove producer's reader so
   // that it doesn't act like a buffer guard
@@ -1021,6 +1025,59 @@ HttpTunnel::producer_run(HttpTunnelProducer *p)
   p->buffer_start = nullptr;
 }
 
+// The NetVConnection carrying exactly the bytes of a tunnel VC, if it has one.
+static NetVConnection *
+splice_netvc(VConnection *vc)
+{
+  if (ProxyTransaction *txn = dynamic_cast<ProxyTransaction *>(vc); txn) {
+    return txn->allow_splice() ? txn->get_netvc() : nullptr;
+  }
+  return dynamic_cast<NetVConnection *>(vc);
+}
+
+// A server response or one direction of a blind tunnel that goes to a single client or server VC
+// and is not looked at on the way is moved between the sockets with splice(), the producer's
+// read buffer stays empty.  The data already in the buffer is written first.
+void
+HttpTunnel::producer_splice(HttpTunnelProducer *p)
+{
+  HttpTunnelConsumer *c = p->consumer_list.head;
+
+  if (p->num_consumers != 1 || !c->alive || !c->write_vio || p->do_chunking || p->do_dechunking || p->do_chunked_passthru) {
+    return;
+  }
+  // request bodies go through the buffer, it may be kept for a redirect
+  bool downstream = p->vc_type == HT_HTTP_SERVER && c->vc_type == HT_HTTP_CLIENT;
+  bool upstream   = p->self_consumer && p->vc_type == HT_HTTP_CLIENT && c->vc_type == HT_HTTP_SERVER;
+  if (!downstream && !upstream) {
+    return;
+  }
+
+  NetVConnection *src = splice_netvc(p->vc);
+  NetVConnection *dst = splice_netvc(c->vc);
+  if (src && dst && src->splice_to(dst)) {
+    Debug("http_tunnel", "[%" PRId64 "] [%s] spliced to [%s]", sm->sm_id, p->name, c->name);
+  }
+}
+
+// A cache read that goes to a single client as it is stored is sent from the cache disk where the
+// cache and the client connection allow it, the header and anything buffered are written first.
+void
+HttpTunnel::producer_sendfile(HttpTunnelProducer *p)
+{
+  HttpTunnelConsumer *c = p->consumer_list.head;
+
+  if (p->vc_type != HT_CACHE_READ || p->num_consumers != 1 || !c->alive || !c->write_vio || c->vc_type != HT_HTTP_CLIENT ||
+      p->do_chunking || p->do_dechunking || p->do_chunked_passthru) {
+    return;
+  }
+
+  NetVConnection *dst = splice_netvc(c->vc);
+  if (dst && static_cast<CacheVConnection *>(p->vc)->sendfile_to(dst)) {
+    Debug("http_tunnel", "[%" PRId64 "] [%s] sent from the cache disk to [%s]", sm->sm_id, p->name, c->name);
+  }
+}
+
 int
 HttpTunnel::producer_handler_dechunked(int event, HttpTunnelProducer *p)
 {
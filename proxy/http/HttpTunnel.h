@@ -336,6 +336,8 @@ private:
   void finish_all_internal(HttpTunnelProducer *p, bool chain);
   void update_stats_after_abort(HttpTunnelType_t t);
   void producer_run(HttpTunnelProducer *p);
+  void producer_splice(HttpTunnelProducer *p);
+  void producer_sendfile(HttpTunnelProducer *p);
   void _schedule_tls_tunnel_activity_check_event();
   bool _is_tls_tunnel_active() const;
 
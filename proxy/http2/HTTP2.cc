@@ -76,6 +76,17 @@ static const char *const HTTP2_STAT_MAX_CONCURRENT_STREAMS_EXCEEDED_IN_NAME =
   "proxy.process.http2.max_concurrent_streams_exceeded_in";
 static const char *const HTTP2_STAT_MAX_CONCURRENT_STREAMS_EXCEEDED_OUT_NAME =
   "proxy.process.http2.max_concurrent_streams_exceeded_out";
+static const char *const HTTP2_STAT_WRITE_FRAMES_1_NAME   = "proxy.process.http2.write_frames_1";
+static const char *const HTTP2_STAT_WRITE_FRAMES_2_NAME   = "proxy.process.http2.write_frames_2";
+static const char *const HTTP2_STAT_WRITE_FRAMES_4_NAME   = "proxy.process.http2.write_frames_4";
+static const char *const HTTP2_STAT_WRITE_FRAMES_8_NAME   = "proxy.process.http2.write_frames_8";
+static const char *const HTTP2_STAT_WRITE_FRAMES_16_NAME  = "proxy.process.http2.write_frames_16";
+static const char *const HTTP2_STAT_WRITE_FRAMES_INF_NAME = "proxy.process.http2.write_frames_inf";
+static const char *const HTTP2_STAT_WRITE_SIZE_1K_NAME    = "proxy.process.http2.write_size_1K";
+static const char *const HTTP2_STAT_WRITE_SIZE_4K_NAME    = "proxy.process.http2.write_size_4K";
+static const char *const HTTP2_STAT_WRITE_SIZE_16K_NAME   = "proxy.process.http2.write_size_16K";
+static const char *const HTTP2_STAT_WRITE_SIZE_64K_NAME   = "proxy.process.http2.write_size_64K";
+static const char *const HTTP2_STAT_WRITE_SIZE_INF_NAME   = "proxy.process.http2.write_size_inf";
 
 union byte_pointer {
   byte_pointer(void *p) : ptr(p) {}
@@ -692,6 +703,28 @@ Http2::init()
                      static_cast<int>(HTTP2_STAT_MAX_CONCURRENT_STREAMS_EXCEEDED_IN), RecRawStatSyncSum);
   RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_MAX_CONCURRENT_STREAMS_EXCEEDED_OUT_NAME, RECD_INT, RECP_PERSISTENT,
                      static_cast<int>(HTTP2_STAT_MAX_CONCURRENT_STREAMS_EXCEEDED_OUT), RecRawStatSyncSum);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_WRITE_FRAMES_1_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_WRITE_FRAMES_1), RecRawStatSyncSum);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_WRITE_FRAMES_2_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_WRITE_FRAMES_2), RecRawStatSyncSum);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_WRITE_FRAMES_4_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_WRITE_FRAMES_4), RecRawStatSyncSum);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_WRITE_FRAMES_8_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_WRITE_FRAMES_8), RecRawStatSyncSum);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_WRITE_FRAMES_16_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_WRITE_FRAMES_16), RecRawStatSyncSum);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_WRITE_FRAMES_INF_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_WRITE_FRAMES_INF), RecRawStatSyncSum);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_WRITE_SIZE_1K_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_WRITE_SIZE_1K), RecRawStatSyncSum);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_WRITE_SIZE_4K_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_WRITE_SIZE_4K), RecRawStatSyncSum);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_WRITE_SIZE_16K_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_WRITE_SIZE_16K), RecRawStatSyncSum);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_WRITE_SIZE_64K_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_WRITE_SIZE_64K), RecRawStatSyncSum);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_WRITE_SIZE_INF_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_WRITE_SIZE_INF), RecRawStatSyncSum);
 
   http2_init();
 }
@@ -95,6 +95,17 @@ enum {
   HTTP2_STAT_INSUFFICIENT_AVG_WINDOW_UPDATE,
   HTTP2_STAT_MAX_CONCURRENT_STREAMS_EXCEEDED_IN,
   HTTP2_STAT_MAX_CONCURRENT_STREAMS_EXCEEDED_OUT,
+  HTTP2_STAT_WRITE_FRAMES_1, // Histogram of the frames handed to the net at once
+  HTTP2_STAT_WRITE_FRAMES_2,
+  HTTP2_STAT_WRITE_FRAMES_4,
+  HTTP2_STAT_WRITE_FRAMES_8,
+  HTTP2_STAT_WRITE_FRAMES_16,
+  HTTP2_STAT_WRITE_FRAMES_INF,
+  HTTP2_STAT_WRITE_SIZE_1K, // Histogram of the bytes handed to the net at once
+  HTTP2_STAT_WRITE_SIZE_4K,
+  HTTP2_STAT_WRITE_SIZE_16K,
+  HTTP2_STAT_WRITE_SIZE_64K,
+  HTTP2_STAT_WRITE_SIZE_INF,
 
   HTTP2_N_STATS // Terminal counter, NOT A STAT INDEX.
 };
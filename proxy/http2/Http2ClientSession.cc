@@ -208,6 +208,11 @@ Http2ClientSession::main_event_handler(int event, void *edata)
     retval = 0;
     break;
 
+  case NET_EVENT_LOOP_TAIL:
+    this->loop_tail_flush();
+    retval = 0;
+    break;
+
   case HTTP2_SESSION_EVENT_XMIT:
   default:
     Http2SsnDebug("unexpected event=%d edata=%p", event, edata);
@@ -21,6 +21,7 @@
   limitations under the License.
  */
 
+#include "P_Net.h"
 #include "Http2CommonSession.h"
 #include "HttpDebugNames.h"
 
@@ -67,6 +68,10 @@ Http2CommonSession::common_free(ProxySession *ssn)
     this->_reenable_event->cancel();
     this->_reenable_event = nullptr;
   }
+  if (this->_loop_tail_nh) {
+    this->_loop_tail_nh->cancel_loop_tail(ssn);
+    this->_loop_tail_nh = nullptr;
+  }
 
   // Make sure the we are at the bottom of the stack
   if (this->connection_state.is_recursing() || this->recursion != 0) {
@@ -152,6 +157,7 @@ Http2CommonSession::xmit(const Http2TxFrame &frame, bool flush)
 {
   int64_t len = frame.write_to(this->write_buffer);
   this->_pending_sending_data_size += len;
+  ++this->_pending_sending_frame_count;
   // Force flush for some cases
   if (!flush) {
     // Flush if we already use half of the buffer to avoid adding a new block to the chain.
@@ -171,13 +177,64 @@ Http2CommonSession::xmit(const Http2TxFrame &frame, bool flush)
 void
 Http2CommonSession::flush()
 {
-  if (this->_pending_sending_data_size > 0) {
-    this->_pending_sending_data_size = 0;
-    this->_write_buffer_last_flush   = Thread::get_hrtime();
-    write_reenable();
+  if (this->_pending_sending_data_size == 0 || this->_loop_tail_nh) {
+    return;
+  }
+
+  // The frames of every stream that gets to send in this loop of the thread go
+  // to the net together, at the end of the loop. Anywhere else they go now.
+  NetVConnection *netvc = this->get_netvc();
+  EThread *ethread      = this_ethread();
+  if (netvc && netvc->thread == ethread && ethread->is_event_type(ET_NET)) {
+    this->_loop_tail_nh = get_NetHandler(ethread);
+    this->_loop_tail_nh->call_at_loop_tail(this->get_proxy_session());
+  } else {
+    this->loop_tail_flush();
   }
 }
 
+void
+Http2CommonSession::loop_tail_flush()
+{
+  this->_loop_tail_nh = nullptr;
+  if (this->_pending_sending_data_size == 0 || this->get_netvc() == nullptr) {
+    return;
+  }
+
+  EThread *ethread = this_ethread();
+  uint32_t frames  = this->_pending_sending_frame_count;
+  uint32_t size    = this->_pending_sending_data_size;
+  if (frames <= 1) {
+    HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_WRITE_FRAMES_1, ethread);
+  } else if (frames <= 2) {
+    HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_WRITE_FRAMES_2, ethread);
+  } else if (frames <= 4) {
+    HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_WRITE_FRAMES_4, ethread);
+  } else if (frames <= 8) {
+    HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_WRITE_FRAMES_8, ethread);
+  } else if (frames <= 16) {
+    HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_WRITE_FRAMES_16, ethread);
+  } else {
+    HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_WRITE_FRAMES_INF, ethread);
+  }
+  if (size <= 1024) {
+    HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_WRITE_SIZE_1K, ethread);
+  } else if (size <= 4096) {
+    HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_WRITE_SIZE_4K, ethread);
+  } else if (size <= 16384) {
+    HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_WRITE_SIZE_16K, ethread);
+  } else if (size <= 65536) {
+    HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_WRITE_SIZE_64K, ethread);
+  } else {
+    HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_WRITE_SIZE_INF, ethread);
+  }
+
+  this->_pending_sending_data_size   = 0;
+  this->_pending_sending_frame_count = 0;
+  this->_write_buffer_last_flush     = Thread::get_hrtime();
+  write_reenable();
+}
+
 int
 Http2CommonSession::state_read_connection_preface(int event, void *edata)
 {
@@ -53,6 +53,8 @@ enum class Http2SsnMilestone {
   LAST_ENTRY,
 };
 
+class NetHandler;
+
 size_t const HTTP2_HEADER_BUFFER_SIZE_INDEX = CLIENT_CONNECTION_FIRST_READ_BUFFER_SIZE_INDEX;
 
 /**
@@ -82,6 +84,7 @@ public:
   void write_reenable();
   int64_t xmit(const Http2TxFrame &frame, bool flush = true);
   void flush();
+  void loop_tail_flush();
 
   int64_t get_connection_id();
   Ptr<ProxyMutex> &get_mutex();
@@ -155,7 +158,10 @@ protected:
   Event *_reenable_event = nullptr;
   int _n_frame_read      = 0;
 
-  uint32_t _pending_sending_data_size = 0;
+  uint32_t _pending_sending_data_size   = 0;
+  uint32_t _pending_sending_frame_count = 0;
+  /// The NetHandler to call loop_tail_flush() at the end of its loop, nullptr if not waiting for it.
+  NetHandler *_loop_tail_nh = nullptr;
 
   int64_t read_from_early_data   = 0;
   bool cur_frame_from_early_data = false;
@@ -590,6 +590,11 @@ Log::init_fields()
   global_field_list.add(field, false);
   field_symbol_hash.emplace("psch", field);
 
+  field = new LogField("proxy_resp_sendfile_len", "pssfl", LogField::sINT, &LogAccess::marshal_proxy_resp_sendfile_len,
+                       &LogAccess::unmarshal_int_to_str);
+  global_field_list.add(field, false);
+  field_symbol_hash.emplace("pssfl", field);
+
   field = new LogField("proxy_resp_status_code", "pssc", LogField::sINT, &LogAccess::marshal_proxy_resp_status_code,
                        &LogAccess::unmarshal_http_status);
   global_field_list.add(field, false);
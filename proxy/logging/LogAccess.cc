@@ -2231,6 +2231,18 @@ LogAccess::marshal_proxy_resp_content_len(char *buf)
   return INK_MIN_ALIGN;
 }
 
+/*-------------------------------------------------------------------------
+  -------------------------------------------------------------------------*/
+
+int
+LogAccess::marshal_proxy_resp_sendfile_len(char *buf)
+{
+  if (buf) {
+    marshal_int(buf, m_http_sm->client_response_sendfile_bytes);
+  }
+  return INK_MIN_ALIGN;
+}
+
 /*-------------------------------------------------------------------------
   -------------------------------------------------------------------------*/
 
@@ -166,6 +166,7 @@ public:
   int marshal_proxy_resp_reason_phrase(char *);     // STR
   int marshal_proxy_resp_squid_len(char *);         // INT
   int marshal_proxy_resp_content_len(char *);       // INT
+  int marshal_proxy_resp_sendfile_len(char *);      // INT
   int marshal_proxy_resp_status_code(char *);       // INT
   int marshal_proxy_resp_header_len(char *);        // INT
   int marshal_proxy_finish_status_code(char *);     // INT
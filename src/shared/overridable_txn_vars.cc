@@ -174,4 +174,5 @@ const std::unordered_map<std::string_view, std::tuple<const TSOverridableConfigK
      {"proxy.config.http.parent_proxy.enable_parent_timeout_markdowns",
       {TS_CONFIG_HTTP_ENABLE_PARENT_TIMEOUT_MARKDOWNS, TS_RECORDDATATYPE_INT}},
      {"proxy.config.http.parent_proxy.disable_parent_markdowns",
-      {TS_CONFIG_HTTP_DISABLE_PARENT_MARKDOWNS, TS_RECORDDATATYPE_INT}}});
+      {TS_CONFIG_HTTP_DISABLE_PARENT_MARKDOWNS, TS_RECORDDATATYPE_INT}},
+     {"proxy.config.net.sock_pacing_rate_in", {TS_CONFIG_NET_SOCK_PACING_RATE_IN, TS_RECORDDATATYPE_INT}}});
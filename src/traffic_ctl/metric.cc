@@ -24,6 +24,11 @@
 #include "traffic_ctl.h"
 #include "records/P_RecUtils.h"
 
+#include <algorithm>
+#include <map>
+#include <string>
+#include <string_view>
+
 void
 CtrlEngine::metric_get()
 {
@@ -93,3 +98,90 @@ CtrlEngine::metric_zero()
     }
   }
 }
+
+void
+CtrlEngine::metric_eventloop()
+{
+  static const std::string_view HIST_PREFIX{"proxy.process.eventloop.time.hist."};
+  static const std::string_view PERCENTILE_PREFIX{"proxy.process.eventloop.time.p"};
+  static const std::string_view HANDLER_PREFIX{"proxy.process.eventloop.handler."};
+
+  struct Handler {
+    std::string name;
+    int64_t count = 0;
+    int64_t time  = 0;
+    int64_t max   = 0;
+  };
+
+  std::map<int64_t, int64_t> buckets;         // lowest loop time in microseconds -> # of loops
+  std::map<std::string, int64_t> percentiles; // p50 -> loop time in nanoseconds
+  std::map<int, Handler> handlers;            // rank -> sampled dispatch times
+  CtrlMgmtRecordList reclist;
+  TSMgmtError error;
+
+  error = reclist.match("proxy\\.process\\.eventloop\\.(time\\.(hist\\.|p)|handler\\.)");
+  if (error != TS_ERR_OKAY) {
+    CtrlMgmtError(error, "failed to fetch the event loop metrics");
+    status_code = CTRL_EX_ERROR;
+    return;
+  }
+
+  while (!reclist.empty()) {
+    CtrlMgmtRecord record(reclist.next());
+    std::string_view name{record.name()};
+
+    if (name.substr(0, HIST_PREFIX.size()) == HIST_PREFIX) {
+      buckets[std::stoll(std::string(name.substr(HIST_PREFIX.size())))] = record.as_int();
+    } else if (name.substr(0, PERCENTILE_PREFIX.size()) == PERCENTILE_PREFIX) {
+      percentiles[std::string(name.substr(PERCENTILE_PREFIX.size() - 1))] = record.as_int();
+    } else if (name.substr(0, HANDLER_PREFIX.size()) == HANDLER_PREFIX) {
+      std::string_view rest = name.substr(HANDLER_PREFIX.size());
+      size_t dot            = rest.find('.');
+      if (dot == std::string_view::npos) {
+        continue;
+      }
+      Handler &h            = handlers[std::stoi(std::string(rest.substr(0, dot)))];
+      std::string_view what = rest.substr(dot + 1);
+      if (what == "name") {
+        h.name = CtrlMgmtRecordValue(record).c_str();
+      } else if (what == "count") {
+        h.count = record.as_int();
+      } else if (what == "time") {
+        h.time = record.as_int();
+      } else if (what == "max") {
+        h.max = record.as_int();
+      }
+    }
+  }
+
+  printf("Loop time without waits, percentiles of the last stat period\n");
+  for (const auto &[name, nsec] : percentiles) {
+    printf("  %-6s <= %12.3f ms\n", name.c_str(), nsec / 1000000.0);
+  }
+
+  // Only the range of buckets with loops in it, with a bar scaled to the largest.
+  int64_t most = 0;
+  auto first = buckets.end(), last = buckets.end();
+  for (auto spot = buckets.begin(); spot != buckets.end(); ++spot) {
+    if (spot->second) {
+      first = first == buckets.end() ? spot : first;
+      last  = spot;
+      most  = std::max(most, spot->second);
+    }
+  }
+  printf("\nLoop time without waits, histogram since start\n");
+  if (first != buckets.end()) {
+    for (auto spot = first; spot != std::next(last); ++spot) {
+      printf("  >= %9" PRId64 " us %14" PRId64 " %s\n", spot->first, spot->second,
+             std::string(spot->second * 40 / most, '#').c_str());
+    }
+  }
+
+  printf("\nHandler dispatch time, sampled since start\n");
+  printf("  %12s %14s %12s  %s\n", "count", "total ms", "max ms", "handler");
+  for (const auto &[rank, h] : handlers) {
+    if (h.count) {
+      printf("  %12" PRId64 " %14.3f %12.3f  %s\n", h.count, h.time / 1000000.0, h.max / 1000000.0, h.name.c_str());
+    }
+  }
+}
@@ -227,6 +227,10 @@ main(int argc, const char **argv)
   metric_command.add_command("monitor", "Display the value of a metric over time", "", MORE_THAN_ZERO_ARG_N,
                              [&]() { engine.CtrlUnimplementedCommand("monitor"); }); // not implemented
   metric_command.add_command("zero", "Clear one or more metric values", "", MORE_THAN_ONE_ARG_N, [&]() { engine.metric_zero(); });
+  metric_command
+    .add_command("eventloop", "Show the event loop time histogram and the slowest continuation handlers",
+                 [&]() { engine.metric_eventloop(); })
+    .add_example_usage("traffic_ctl metric eventloop");
 
   // plugin command
   plugin_command
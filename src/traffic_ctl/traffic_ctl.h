@@ -203,6 +203,7 @@ struct CtrlEngine {
   void metric_match();
   void metric_clear();
   void metric_zero();
+  void metric_eventloop();
 
   // metric methods
   void plugin_msg();
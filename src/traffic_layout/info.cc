@@ -42,6 +42,14 @@
 #include <lzma.h>
 #endif
 
+#if HAVE_ZSTD_H
+#include <zstd.h>
+#endif
+
+#if HAVE_LZ4_H
+#include <lz4.h>
+#endif
+
 #if HAVE_BROTLI_ENCODE_H
 #include <brotli/encode.h>
 #endif
@@ -88,6 +96,16 @@ produce_features(bool json)
 #else
   print_feature("TS_HAS_LZMA", 0, json);
 #endif
+#if HAVE_ZSTD_H
+  print_feature("TS_HAS_ZSTD", 1, json);
+#else
+  print_feature("TS_HAS_ZSTD", 0, json);
+#endif
+#if HAVE_LZ4_H
+  print_feature("TS_HAS_LZ4", 1, json);
+#else
+  print_feature("TS_HAS_LZ4", 0, json);
+#endif
 #if HAVE_BROTLI_ENCODE_H
   print_feature("TS_HAS_BROTLI", 1, json);
 #else
@@ -208,6 +226,18 @@ produce_versions(bool json)
 #else
   print_var("lzma", undef, json);
 #endif
+#if HAVE_ZSTD_H
+  print_var("zstd", LBW().print("{}", ZSTD_VERSION_STRING).view(), json);
+  print_var("zstd.run", LBW().print("{}", ZSTD_versionString()).view(), json);
+#else
+  print_var("zstd", undef, json);
+#endif
+#if HAVE_LZ4_H
+  print_var("lz4", LBW().print("{}", LZ4_VERSION_STRING).view(), json);
+  print_var("lz4.run", LBW().print("{}", LZ4_versionString()).view(), json);
+#else
+  print_var("lz4", undef, json);
+#endif
 #if HAVE_BROTLI_ENCODE_H
   print_var("brotli", LBW().print("{:#x}", BrotliEncoderVersion()).view(), json);
 #else
@@ -1131,6 +1131,11 @@ INKContInternal::handle_event(int event, void *edata)
       Debug("plugin", "INKCont Deletable but not deleted %d", m_event_count);
     }
   } else {
+    // a sampled dispatch is charged to the plugin function
+    EThread *ethread = this_ethread();
+    if (ethread) {
+      ethread->dispatch_to(this, &INKContInternal::handle_event, reinterpret_cast<const void *>(m_event_func));
+    }
     /* set the plugin context */
     auto *previousContext = pluginThreadContext;
     pluginThreadContext   = reinterpret_cast<PluginThreadContext *>(m_context);
@@ -4735,6 +4740,26 @@ TSContScheduleOnThread(TSCont contp, TSHRTime timeout, TSEventThread ethread)
   return action;
 }
 
+TSAction
+TSContScheduleJob(TSCont contp)
+{
+  sdk_assert(sdk_sanity_check_iocore_structure(contp) == TS_SUCCESS);
+
+  FORCE_PLUGIN_SCOPED_MUTEX(contp);
+
+  INKContInternal *i = reinterpret_cast<INKContInternal *>(contp);
+
+  if (ink_atomic_increment(static_cast<int *>(&i->m_event_count), 1) < 0) {
+    ink_assert(!"not reached");
+  }
+
+  TSAction action = reinterpret_cast<TSAction>(tasksProcessor.schedule_imm(i));
+
+  /* This is a hack. Should be handled in ink_types */
+  action = (TSAction)((uintptr_t)action | 0x1);
+  return action;
+}
+
 TSAction
 TSContScheduleEvery(TSCont contp, TSHRTime every /* millisecs */)
 {
@@ -9074,6 +9099,9 @@ _conf_to_memberp(TSOverridableConfigKey conf, OverridableHttpConfigParams *overr
   case TS_CONFIG_HTTP_DISABLE_PARENT_MARKDOWNS:
     ret = _memberp_to_generic(&overridableHttpConfig->disable_parent_markdowns, conv);
     break;
+  case TS_CONFIG_NET_SOCK_PACING_RATE_IN:
+    ret = _memberp_to_generic(&overridableHttpConfig->sock_pacing_rate_in, conv);
+    break;
 
   // This helps avoiding compiler warnings, yet detect unhandled enum members.
   case TS_CONFIG_NULL:
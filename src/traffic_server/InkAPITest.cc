@@ -30,6 +30,7 @@
 #include <sys/types.h>
 #include <arpa/inet.h> /* For htonl */
 
+#include <atomic>
 #include <cerrno>
 #include <pthread.h>
 #include <unistd.h>
@@ -46,6 +47,7 @@
 #include "records/I_RecCore.h"
 
 #include "P_Net.h"
+#include "I_Tasks.h"
 #include "records/I_RecHttp.h"
 
 #include "http/HttpSM.h"
@@ -3020,6 +3022,94 @@ REGRESSION_TEST(SDK_API_TSContSchedule)(RegressionTest *test, int /* atype ATS_U
   TSContScheduleOnPool(contp2, 10, TS_THREAD_POOL_NET);
 }
 
+//////////////////////////////////////////////
+//       SDK_API_TSContScheduleJob
+//
+// Unit Test for API: TSContScheduleJob
+//////////////////////////////////////////////
+
+static RegressionTest *SDK_ContScheduleJob_test;
+static int *SDK_ContScheduleJob_pstatus;
+static std::atomic<int> job_tc_count{0};
+
+static void
+cont_schedule_job_done(bool passed)
+{
+  if (!passed) {
+    *SDK_ContScheduleJob_pstatus = REGRESSION_TEST_FAILED;
+  } else if (++job_tc_count == 2 && *SDK_ContScheduleJob_pstatus == REGRESSION_TEST_INPROGRESS) {
+    *SDK_ContScheduleJob_pstatus = REGRESSION_TEST_PASSED;
+  }
+}
+
+int
+cont_schedule_job_handler(TSCont contp, TSEvent event, void * /* edata ATS_UNUSED */)
+{
+  // Test Case 1: the job runs on a task thread
+  if (event != TS_EVENT_IMMEDIATE) {
+    SDK_RPRINT(SDK_ContScheduleJob_test, "TSContScheduleJob", "TestCase1", TC_FAIL, "received unexpected event number %d", event);
+    cont_schedule_job_done(false);
+  } else if (!this_ethread()->is_event_type(ET_TASK)) {
+    SDK_RPRINT(SDK_ContScheduleJob_test, "TSContScheduleJob", "TestCase1", TC_FAIL, "not called on an ET_TASK thread");
+    cont_schedule_job_done(false);
+  } else {
+    SDK_RPRINT(SDK_ContScheduleJob_test, "TSContScheduleJob", "TestCase1", TC_PASS, "ok");
+    cont_schedule_job_done(true);
+  }
+
+  TSContDestroy(contp);
+  return 0;
+}
+
+int
+cont_schedule_job_cancel_handler(TSCont contp, TSEvent event, void * /* edata ATS_UNUSED */)
+{
+  // Test Case 2: the cancelled job does not run, only the timeout scheduled after it
+  if (event == TS_EVENT_TIMEOUT) {
+    SDK_RPRINT(SDK_ContScheduleJob_test, "TSContScheduleJob", "TestCase2", TC_PASS, "ok");
+    cont_schedule_job_done(true);
+  } else if (event == TS_EVENT_IMMEDIATE) {
+    SDK_RPRINT(SDK_ContScheduleJob_test, "TSContScheduleJob", "TestCase2", TC_FAIL, "cancelled job was called");
+    cont_schedule_job_done(false);
+  } else {
+    SDK_RPRINT(SDK_ContScheduleJob_test, "TSContScheduleJob", "TestCase2", TC_FAIL, "received unexpected event number %d", event);
+    cont_schedule_job_done(false);
+  }
+
+  TSContDestroy(contp);
+  return 0;
+}
+
+REGRESSION_TEST(SDK_API_TSContScheduleJob)(RegressionTest *test, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  *pstatus = REGRESSION_TEST_INPROGRESS;
+
+  SDK_ContScheduleJob_test    = test;
+  SDK_ContScheduleJob_pstatus = pstatus;
+  job_tc_count                = 0;
+
+  // Test Case 1: run a job
+  TSCont contp = TSContCreate(cont_schedule_job_handler, TSMutexCreate());
+  TSContScheduleJob(contp);
+
+  // Test Case 2: cancel a job, holding the mutex keeps it from running before it is cancelled
+  TSMutex cont_mutex = TSMutexCreate();
+  TSCont contp2      = TSContCreate(cont_schedule_job_cancel_handler, cont_mutex);
+
+  TSMutexLock(cont_mutex);
+  TSAction actionp = TSContScheduleJob(contp2);
+  if (TSActionDone(actionp)) {
+    SDK_RPRINT(test, "TSContScheduleJob", "TestCase2", TC_FAIL, "job done before it could run");
+    *pstatus = REGRESSION_TEST_FAILED;
+    TSMutexUnlock(cont_mutex);
+    return;
+  }
+  TSActionCancel(actionp);
+  TSMutexUnlock(cont_mutex);
+
+  TSContScheduleOnPool(contp2, 100, TS_THREAD_POOL_TASK);
+}
+
 //////////////////////////////////////////////////////////////////////////////
 //     SDK_API_HttpHookAdd
 //
@@ -8711,7 +8801,8 @@ std::array<std::string_view, TS_CONFIG_LAST_ENTRY> SDK_Overridable_Configs = {
    "proxy.config.net.sock_notsent_lowat",
    "proxy.config.body_factory.response_suppression_mode",
    "proxy.config.http.parent_proxy.enable_parent_timeout_markdowns",
-   "proxy.config.http.parent_proxy.disable_parent_markdowns"}};
+   "proxy.config.http.parent_proxy.disable_parent_markdowns",
+   "proxy.config.net.sock_pacing_rate_in"}};
 
 extern ClassAllocator<HttpSM> httpSMAllocator;
 
@@ -1979,6 +1979,9 @@ main(int /* argc ATS_UNUSED */, const char **argv)
   }
 
   REC_ReadConfigInteger(thread_max_heartbeat_mseconds, "proxy.config.thread.max_heartbeat_mseconds");
+  REC_ReadConfigInteger(thread_timer_wheel, "proxy.config.thread.timer_wheel");
+  REC_ReadConfigInteger(task_threads_work_stealing, "proxy.config.task_threads.work_stealing");
+  REC_EstablishStaticConfigInt32(thread_handler_sample_rate, "proxy.config.thread.handler_sample_rate");
 
   ink_event_system_init(ts::ModuleVersion(1, 0, ts::ModuleVersion::PRIVATE));
   ink_net_init(ts::ModuleVersion(1, 0, ts::ModuleVersion::PRIVATE));
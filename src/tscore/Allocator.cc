@@ -0,0 +1,157 @@
+/** @file
+
+  Per thread magazines of the fast allocators.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <algorithm>
+#include <atomic>
+
+#include "tscore/Allocator.h"
+
+int thread_magazine_size                        = 32;
+thread_local FreelistMagazine *thread_magazines = nullptr;
+
+namespace
+{
+// Larger blocks go straight to the free pool, a magazine of IO buffers would hold megabytes.
+constexpr uint32_t MAX_MAGAZINE_TYPE_SIZE = 32 * 1024;
+
+std::atomic<int> n_magazines{0};
+InkFreeList *magazine_freelists[MAX_THREAD_MAGAZINES];
+
+thread_local bool thread_magazines_gone = false;
+
+// Return all but the first @a keep blocks of @a m to the free pool.
+void
+flush(InkFreeList *fl, FreelistMagazine &m, uint32_t keep)
+{
+  if (m.count <= keep) {
+    return;
+  }
+
+  // The first blocks were freed last and are the most likely to be in the cache, keep them.
+  void **link = &m.head;
+  for (uint32_t i = 0; i < keep; ++i) {
+    link = static_cast<void **>(*link);
+  }
+  uint32_t count = m.count - keep;
+  void *head     = *link;
+  void *tail     = head;
+  for (uint32_t i = 1; i < count; ++i) {
+    tail = *static_cast<void **>(tail);
+  }
+  *link   = nullptr;
+  m.count = keep;
+
+  if (count == 1) {
+    ink_freelist_free(fl, head);
+  } else {
+    ink_freelist_free_bulk(fl, head, tail, count);
+  }
+}
+
+// Owns the magazines of a thread, the blocks go back to the free pools when the thread exits.
+struct ThreadMagazines {
+  ThreadMagazines() { thread_magazines = new FreelistMagazine[MAX_THREAD_MAGAZINES]; }
+
+  ~ThreadMagazines()
+  {
+    int n = std::min(n_magazines.load(), MAX_THREAD_MAGAZINES);
+    for (int id = 0; id < n; ++id) {
+      flush(magazine_freelists[id], thread_magazines[id], 0);
+    }
+    delete[] thread_magazines;
+    thread_magazines      = nullptr;
+    thread_magazines_gone = true;
+  }
+};
+
+FreelistMagazine *
+thread_magazine(int id)
+{
+  if (id >= MAX_THREAD_MAGAZINES) {
+    return nullptr;
+  }
+  if (thread_magazines == nullptr) {
+    // Blocks from malloc are not cached, that is used to find memory errors.
+    if (thread_magazine_size <= 0 || thread_magazines_gone || ink_freelist_global_ops() != ink_freelist_freelist_ops()) {
+      return nullptr;
+    }
+    static thread_local ThreadMagazines owner;
+    (void)owner;
+  }
+  return &thread_magazines[id];
+}
+
+} // namespace
+
+int
+freelist_magazine_register(InkFreeList *fl)
+{
+  if (fl->type_size > MAX_MAGAZINE_TYPE_SIZE) {
+    return MAX_THREAD_MAGAZINES;
+  }
+
+  int id = n_magazines++;
+  if (id >= MAX_THREAD_MAGAZINES) {
+    return MAX_THREAD_MAGAZINES;
+  }
+  magazine_freelists[id] = fl;
+  return id;
+}
+
+void *
+freelist_magazine_alloc(InkFreeList *fl, int id)
+{
+  FreelistMagazine *m = thread_magazine(id);
+
+  if (m == nullptr || thread_magazine_size <= 0) {
+    return ink_freelist_new(fl);
+  }
+
+  // The magazine is empty, take half of it from the free pool.
+  void *head  = nullptr;
+  void *tail  = nullptr;
+  size_t more = ink_freelist_new_bulk(fl, &head, &tail, std::max(thread_magazine_size / 2, 1));
+  if (more == 0) {
+    return nullptr;
+  }
+  m->head  = *static_cast<void **>(head);
+  m->count = more - 1;
+  return head;
+}
+
+void
+freelist_magazine_free(InkFreeList *fl, int id, void *ptr)
+{
+  FreelistMagazine *m = thread_magazine(id);
+
+  if (m == nullptr) {
+    ink_freelist_free(fl, ptr);
+    return;
+  }
+
+  // The magazine is full, or turned off since it was filled.
+  *static_cast<void **>(ptr) = m->head;
+  m->head                    = ptr;
+  ++m->count;
+  flush(fl, *m, std::max(thread_magazine_size, 0) / 2);
+}
@@ -106,6 +106,12 @@ ink_freelist_freelist_ops()
   return &freelist_ops;
 }
 
+const InkFreeListOps *
+ink_freelist_global_ops()
+{
+  return freelist_global_ops;
+}
+
 void
 ink_freelist_init_ops(int nofl_class, int nofl_proxy)
 {
@@ -223,7 +229,8 @@ freelist_new(InkFreeList *f)
 
       ink_atomic_increment(reinterpret_cast<int *>(&f->allocated), f->chunk_size);
 
-      /* free each of the new elements */
+      /* link the new elements and free them all at once */
+      char *last = (static_cast<char *>(FREELIST_POINTER(item))) + (f->chunk_size - 1) * f->type_size;
       for (i = 0; i < f->chunk_size; i++) {
         char *a = (static_cast<char *>(FREELIST_POINTER(item))) + i * f->type_size;
 #ifdef DEADBEEF
@@ -232,8 +239,9 @@ freelist_new(InkFreeList *f)
           a[j] = str[j % 4];
         }
 #endif
-        freelist_free(f, a);
+        *ADDRESS_OF_NEXT(a, 0) = a == last ? nullptr : a + f->type_size;
       }
+      freelist_bulkfree(f, FREELIST_POINTER(item), last, f->chunk_size);
 
     } else {
       SET_FREELIST_POINTER_VERSION(next, *ADDRESS_OF_NEXT(TO_PTR(FREELIST_POINTER(item)), 0), FREELIST_VERSION(item) + 1);
@@ -389,6 +397,26 @@ freelist_bulkfree(InkFreeList *f, void *head, void *tail, size_t num_item)
   }
 }
 
+size_t
+ink_freelist_new_bulk(InkFreeList *f, void **head, void **tail, size_t num_item)
+{
+  size_t count = 0;
+
+  // Only the item on top of the freelist is known to still be free, any item under it can be taken
+  // and written by another thread, so they are taken one at a time. The count is updated once.
+  for (void *item; count < num_item && (item = freelist_global_ops->fl_new(f)); ++count) {
+    *ADDRESS_OF_NEXT(item, 0) = nullptr;
+    if (count == 0) {
+      *head = item;
+    } else {
+      *ADDRESS_OF_NEXT(*tail, 0) = item;
+    }
+    *tail = item;
+  }
+  ink_atomic_increment(reinterpret_cast<int *>(&f->used), count);
+  return count;
+}
+
 static void
 malloc_bulkfree(InkFreeList *f, void *head, void *tail, size_t num_item)
 {
@@ -29,6 +29,7 @@
 #include "tscore/ink_memory.h"
 #include "tscore/ink_queue.h"
 #include "tscore/hugepages.h"
+#include "tscore/Allocator.h"
 
 #include <iostream>
 
@@ -38,7 +39,8 @@
 
 namespace
 {
-InkFreeList *flist = nullptr;
+InkFreeList *flist   = nullptr;
+Allocator *allocator = nullptr;
 
 // Args
 int nloop                 = 1000000;
@@ -118,8 +120,27 @@ test_case_1(void *d)
   return nullptr;
 }
 
+void *
+test_case_2(void *d)
+{
+  int id;
+  void *m1;
+
+  id = (intptr_t)d;
+
+  for (int i = 0; i < nloop; ++i) {
+    m1 = allocator->alloc_void();
+
+    memset(m1, id, 64);
+
+    allocator->free_void(m1);
+  }
+
+  return nullptr;
+}
+
 void
-setup_test_case_1(const int64_t n)
+setup_test_case(const int64_t n, void *(*test_case)(void *))
 {
   ink_thread list[n];
 
@@ -131,7 +152,7 @@ setup_test_case_1(const int64_t n)
   assert(obj_count > 0);
 
   for (int i = 0; i < n; i++) {
-    ink_thread_create(&list[i], test_case_1, (void *)(static_cast<intptr_t>(i)), 0, 0, nullptr);
+    ink_thread_create(&list[i], test_case, (void *)(static_cast<intptr_t>(i)), 0, 0, nullptr);
 
     int dst = i;
     if (thread_assiging_order == 1) {
@@ -155,7 +176,7 @@ setup_test_case_1(const int64_t n)
   }
 #else
   for (int i = 0; i < n; i++) {
-    ink_thread_create(&list[i], test_case_1, (void *)((intptr_t)i), 0, 0, nullptr);
+    ink_thread_create(&list[i], test_case, (void *)((intptr_t)i), 0, 0, nullptr);
   }
 #endif
 
@@ -171,7 +192,17 @@ TEST_CASE("simple new and free", "")
   // go 100 times in default (--benchmark-samples)
   char name[16];
   snprintf(name, sizeof(name), "nthreads = %d", nthreads);
-  BENCHMARK(name) { return setup_test_case_1(nthreads); };
+  BENCHMARK(name) { return setup_test_case(nthreads, test_case_1); };
+}
+
+TEST_CASE("allocator new and free", "")
+{
+  // Goes through the magazines of the threads, unless --ts-magazine is 0
+  allocator = new Allocator("meow", 64, 256, 8);
+
+  char name[32];
+  snprintf(name, sizeof(name), "nthreads = %d magazine = %d", nthreads, thread_magazine_size);
+  BENCHMARK(name) { return setup_test_case(nthreads, test_case_2); };
 }
 } // namespace
 
@@ -197,6 +228,8 @@ main(int argc, char *argv[])
                                                  "(default: 1)") |
              Opt(opt_enable_hugepage, "yes|no")["--ts-hugepage"]("enable hugepage\n"
                                                                  "(default: no)") |
+             Opt(thread_magazine_size, "n")["--ts-magazine"]("blocks in the magazine of a thread, 0 to disable\n"
+                                                             "(default: 32)") |
              Opt(thread_assiging_order, "n")["--ts-thread-order"]("thread assiging order [0-1]\n"
                                                                   "0: use both of sibling of hyper-thread first (default)\n"
                                                                   "1: use a side of sibling of hyper-thread first") |
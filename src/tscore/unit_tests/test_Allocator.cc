@@ -0,0 +1,75 @@
+/** @file
+
+  Test file for the magazines of the fast allocators
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include <thread>
+#include <vector>
+
+#include "tscore/Allocator.h"
+
+namespace
+{
+// Exposes the free pool, blocks in a magazine still count as used in it.
+class TestAllocator : public FreelistAllocator
+{
+public:
+  using FreelistAllocator::FreelistAllocator;
+
+  uint32_t
+  used() const
+  {
+    return fl->used;
+  }
+};
+} // namespace
+
+TEST_CASE("Allocator magazines", "[libts][Allocator]")
+{
+  TestAllocator a("test_magazine", 64, 128, 8);
+
+  SECTION("freed block is reused")
+  {
+    void *p = a.alloc_void();
+    a.free_void(p);
+    REQUIRE(a.alloc_void() == p);
+    a.free_void(p);
+  }
+
+  SECTION("full magazine goes back to the free pool")
+  {
+    std::thread t([&]() {
+      std::vector<void *> blocks;
+      for (int i = 0; i < 10 * thread_magazine_size; ++i) {
+        blocks.push_back(a.alloc_void());
+      }
+      for (void *p : blocks) {
+        a.free_void(p);
+      }
+      CHECK(a.used() <= static_cast<uint32_t>(thread_magazine_size));
+    });
+    t.join();
+    // The magazine is emptied when the thread exits.
+    REQUIRE(a.used() == 0);
+  }
+}
@@ -0,0 +1,70 @@
+#! /usr/bin/env bash
+#
+#  Run the same jtest load with socket reads on epoll and on io_uring
+#  (proxy.config.net.io_uring.recv) and compare the two.
+#
+#  Licensed to the Apache Software Foundation (ASF) under one
+#  or more contributor license agreements.  See the NOTICE file
+#  distributed with this work for additional information
+#  regarding copyright ownership.  The ASF licenses this file
+#  to you under the Apache License, Version 2.0 (the
+#  "License"); you may not use this file except in compliance
+#  with the License.  You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+
+# Usage: net_loop_ab.sh [jtest options]
+#
+# Traffic Server must be running and reachable by traffic_ctl, the
+# options are passed to jtest as is (e.g. -P proxy_host -c 200 -k 10).
+# The environment can override:
+#   JTEST        path of jtest                      (jtest)
+#   TRAFFIC_CTL  path of traffic_ctl                (traffic_ctl)
+#   SECONDS_RUN  length of each run                 (30)
+#   SETTLE       wait after a restart, in seconds   (5)
+
+JTEST=${JTEST:-jtest}
+TRAFFIC_CTL=${TRAFFIC_CTL:-traffic_ctl}
+SECONDS_RUN=${SECONDS_RUN:-30}
+SETTLE=${SETTLE:-5}
+
+metric() {
+    ${TRAFFIC_CTL} metric get "$1" | awk '{print $2}'
+}
+
+run() {
+    local mode=$1
+    shift
+
+    ${TRAFFIC_CTL} config set proxy.config.net.io_uring.recv "${mode}" >/dev/null || exit 1
+    ${TRAFFIC_CTL} server restart >/dev/null || exit 1
+    sleep "${SETTLE}"
+
+    local req0 read0 uring0 req1 read1 uring1
+    req0=$(metric proxy.process.http.incoming_requests)
+    read0=$(metric proxy.process.net.calls_to_read)
+    uring0=$(metric proxy.process.net.io_uring.recv_completions)
+
+    ${JTEST} -t "${SECONDS_RUN}" "$@" >/dev/null 2>&1
+
+    req1=$(metric proxy.process.http.incoming_requests)
+    read1=$(metric proxy.process.net.calls_to_read)
+    uring1=$(metric proxy.process.net.io_uring.recv_completions)
+
+    awk -v mode="${mode}" -v secs="${SECONDS_RUN}" -v req=$((req1 - req0)) -v reads=$((read1 - read0)) \
+        -v uring=$((uring1 - uring0)) 'BEGIN {
+        name = mode ? "io_uring" : "epoll";
+        per  = req ? req : 1;
+        printf("%-9s %10.1f %12d %16.2f %18.2f\n", name, req / secs, req, reads / per, uring / per);
+    }'
+}
+
+printf "%-9s %10s %12s %16s %18s\n" "reads" "req/s" "requests" "recv calls/req" "completions/req"
+run 0 "$@"
+run 1 "$@"
@@ -0,0 +1,80 @@
+#! /usr/bin/env bash
+#
+#  Run the same jtest load of large cache hits with the bodies copied
+#  through user space and sent from the cache disk with sendfile
+#  (proxy.config.cache.sendfile.enabled) and compare the CPU used.
+#
+#  Licensed to the Apache Software Foundation (ASF) under one
+#  or more contributor license agreements.  See the NOTICE file
+#  distributed with this work for additional information
+#  regarding copyright ownership.  The ASF licenses this file
+#  to you under the Apache License, Version 2.0 (the
+#  "License"); you may not use this file except in compliance
+#  with the License.  You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+
+# Usage: sendfile_ab.sh [jtest options]
+#
+# Traffic Server must be running and reachable by traffic_ctl, the
+# options are passed to jtest as is and should request objects larger
+# than proxy.config.cache.sendfile.min_size that are already cached
+# (e.g. -P proxy_host -c 50 -z 1.0 -u large_urls).
+# The environment can override:
+#   JTEST        path of jtest                      (jtest)
+#   TRAFFIC_CTL  path of traffic_ctl                (traffic_ctl)
+#   TS_PID       pid of traffic_server              (pidof traffic_server)
+#   SECONDS_RUN  length of each run                 (30)
+#   SETTLE       wait after a restart, in seconds   (5)
+
+JTEST=${JTEST:-jtest}
+TRAFFIC_CTL=${TRAFFIC_CTL:-traffic_ctl}
+SECONDS_RUN=${SECONDS_RUN:-30}
+SETTLE=${SETTLE:-5}
+
+metric() {
+    ${TRAFFIC_CTL} metric get "$1" | awk '{print $2}'
+}
+
+# user and system clock ticks of traffic_server
+cpu_ticks() {
+    local pid=${TS_PID:-$(pidof traffic_server | awk '{print $1}')}
+    awk '{print $14 + $15}' "/proc/${pid}/stat"
+}
+
+run() {
+    local mode=$1
+    shift
+
+    ${TRAFFIC_CTL} config set proxy.config.cache.sendfile.enabled "${mode}" >/dev/null || exit 1
+    ${TRAFFIC_CTL} server restart >/dev/null || exit 1
+    sleep "${SETTLE}"
+
+    local bytes0 sf0 cpu0 bytes1 sf1 cpu1
+    bytes0=$(metric proxy.process.net.write_bytes)
+    sf0=$(metric proxy.process.net.sendfile.bytes)
+    cpu0=$(cpu_ticks)
+
+    ${JTEST} -t "${SECONDS_RUN}" "$@" >/dev/null 2>&1
+
+    bytes1=$(metric proxy.process.net.write_bytes)
+    sf1=$(metric proxy.process.net.sendfile.bytes)
+    cpu1=$(cpu_ticks)
+
+    awk -v mode="${mode}" -v secs="${SECONDS_RUN}" -v hz="$(getconf CLK_TCK)" -v bytes=$((bytes1 - bytes0)) \
+        -v sf=$((sf1 - sf0)) -v ticks=$((cpu1 - cpu0)) 'BEGIN {
+        name = mode ? "sendfile" : "copy";
+        gbit = bytes * 8 / 1e9;
+        printf("%-9s %10.2f %14.3f %16d\n", name, gbit / secs, (ticks / hz) / (gbit ? gbit : 1), sf);
+    }'
+}
+
+printf "%-9s %10s %14s %16s\n" "body" "Gbit/s" "cpu s/Gbit" "sendfile bytes"
+run 0 "$@"
+run 1 "$@"